@@ -1,8 +1,28 @@
+#include <string.h>
 #include "Sensor.h"
+#include "config.h"
+#include "smlCrc16.h"
 #include "smlDebug.h"
+#include "smlProfile.h"
+#include "smlTime.h"
 
 /* *** Sensor.cpp implementing Sensor class to receive sml data via a serial input pin and stor it in a buffer
 
+2026-10-17   mh
+- input via ByteSource of hal.h instead of owning SoftwareSerial; allows the host (native) build
+- added constructor with explicit ByteSource, e.g. for file input
+- profiling of start and end sequence search (SML_PROFILE)
+- input stage: pump() moves the input in blocks to a lock-free ring buffer; counters in SensorStats
+- framing by SmlScanner (smlScanner.cpp): word at a time search, escaped data, start sequence within a message
+- CRC16 check of the message before the callback (SML_CRC_CHECK), counter crcErrors
+- frameMs(): time of the start sequence of the telegram, e.g. for the mean power of an aggregation window
+- frameEpochMs(): the same as epoch ms (smlTime.cpp), time stamp of the posted values
+- meter: index of the reading head for several meters (smlScheduler.cpp), counter ringPeak
+- SENSOR_FRAME_BUFFERS frame buffers and receive(): the reception goes on while a telegram is processed
+- state changes of receive() during the processing are reported to the callback after it
+- frame buffers from SmlFramePool (smlFramePool.cpp), sized to the telegrams
+- push decoder per frame buffer (smlStream.cpp, SML_STREAM_DECODE), frameEntries()
+
 2023-01-25   mh
 - disables namespace std; added std:: to unique_ptr<SoftwareSerial>
   reason: byte was ambiguous
@@ -36,14 +56,36 @@ in Loop():
 	sensor->loop()
 
 ## Implementation ##
-A state machine is used to
+pump() moves all bytes of the ByteSource in blocks to a lock-free single producer / single consumer ring buffer
+(SmlRingBuffer). It is called by loop() and may be called during long operations (e.g. by SmlHttp between posts)
+so that the SoftwareSerial buffer does not overflow while loop() is blocked.
+
+A state machine consuming blocks of the ring buffer is used to
 - wait for incoming data by checking for the SML start sequence
-- transfer data to the buffer until the end sequence is recognized
-- handle the CRC data
-- initiate processing of the data using the callback function.
+- transfer data to a frame buffer until the end sequence is recognized (framing and escaped data: SmlScanner)
+- handle the CRC data: the CRC is calculated during reception, a message with a wrong CRC is dropped
+- hand the frame buffer over to the processing and go on with the next telegram in a spare frame buffer.
+The state machine does not yield() per byte; in standby the input is dropped in blocks.
+
+The Sensor has up to SENSOR_FRAME_BUFFERS frame buffers, used as a queue: the reception fills the buffer after the
+received telegrams, loop() passes the oldest one to the callback (PROCESS_MESSAGE). receive() runs the reception
+only, SmlHttp calls it between its posts (SmlScheduler::receive()), so the next telegram is framed while the previous
+one is published (the state changes of receive() go to the callback once the processing returned, not nested in
+it); with the ring buffer alone the input of about 1 s is kept, with 2 frame buffers a telegram in addition.
+If no frame buffer is free at the start sequence, the telegram waits in the ring buffer; when the ring buffer is
+full as well, the telegram is dropped (SensorStats::framesDropped) and its bytes are skipped instead of
+losing input in the byte source, which would break the telegram being received. frameMs() and frameEpochMs() are
+the times of the telegram being processed.
+The frame buffers are runs of the pool shared by all sensors (smlFramePool.cpp): at the start sequence the sensor
+asks for the largest telegram so far and a quarter more (SensorStats::frameMax), grows the buffer if the telegram
+is larger, keeps only the received bytes until the processing and then releases the buffer.
+With SML_STREAM_DECODE each frame buffer decodes its entries during the reception (SmlObisStream): read_message()
+feeds the settled bytes after each block, read_checksum() commits the entries if the CRC is correct, or discards
+them. The callback finds them by frameEntries(), SmlHttp publishes them without parsing the telegram again. The
+time of the decoding is part of the end sequence search (PROFILE_END_SEARCH).
 
 ## Used libs ##
-SoftwareSerial  
+SoftwareSerial (via halArduino.cpp)  
   
 
   *** end description *** */
@@ -51,6 +93,8 @@ SoftwareSerial
 
 //using namespace std;
 
+static_assert(SML_FRAME_POOL_SIZE >= BUFFER_SIZE, "SML_FRAME_POOL_SIZE: room for a telegram of BUFFER_SIZE bytes");
+
 
 uint64_t millis64()
 {
@@ -69,22 +113,102 @@ uint64_t millis64()
         this->config = config;
         DEBUG("Initializing sensor %s...", this->config->name);
         this->callback = callback;
-        this->serial = std::unique_ptr<SoftwareSerial>(new SoftwareSerial());
-        this->serial->begin(9600, SWSERIAL_8N1, this->config->pin, -1, false);
-        this->serial->enableTx(false);
-        this->serial->enableRx(true);
+        this->stream_decode = SML_STREAM_DECODE;
+        this->source = std::unique_ptr<ByteSource>(halCreateSerialSource(this->config->pin));
         DEBUG("Initialized sensor %s.", this->config->name);
 
         this->init_state();
     }
 
+    Sensor::Sensor(const SensorConfig *config, ByteSource *source, void (*callback)(byte *buffer, size_t len, Sensor *sensor, State sensorState))
+    {
+        this->config = config;
+        this->callback = callback;
+        this->stream_decode = SML_STREAM_DECODE;
+        this->source = std::unique_ptr<ByteSource>(source);
+        DEBUG("Initialized sensor %s.", this->config->name);
+
+        this->init_state();
+    }
+
+    Sensor::~Sensor()
+    {
+        // frame buffers back to the pool
+        for (uint8_t i = 0; i < SENSOR_FRAME_BUFFERS; i++)
+        {
+            smlFramePool()->release(this->frames[i].data, this->frames[i].size);
+        }
+    }
+
     // loop ---------------------------------------------------------------------------------------
     void Sensor::loop()
     {
-        this->run_current_state();
+        this->receive();
+        this->process_message();
         yield();
     }
 
+    // reception only: input and framing, the states of one telegram at once -----------------------
+    void Sensor::receive()
+    {
+        this->pump();
+        uint32_t dropped = this->stats.framesDropped;
+        State before;
+        do
+        {
+            before = this->state;
+            this->run_current_state();
+        } while (this->state != before && (this->state == READ_MESSAGE || this->state == READ_CHECKSUM) &&
+                 this->ring.available() > 0);
+        if (this->stats.framesDropped != dropped)
+        {
+            this->pump();           // the input waiting in the byte source while the ring buffer was full
+        }
+    }
+
+    // input stage: move received bytes to the ring buffer ----------------------------------------
+    void Sensor::pump()
+    {
+        if (this->source->overflow())
+        {
+            this->stats.sourceOverflows++;
+            this->input_lost = true;
+        }
+        int available;
+        while ((available = this->source->available()) > 0)
+        {
+            byte *space;
+            size_t len = this->ring.reserve(&space);
+            if (len == 0)
+            {
+                // ring buffer full: leave the input in the byte source
+                this->stats.ringFull++;
+                break;
+            }
+            if ((size_t)available < len)
+            {
+                len = available;
+            }
+            len = this->source->readBytes(space, len);
+            if (len == 0)
+            {
+                break;
+            }
+            this->ring.commit(len);
+            this->stats.bytesReceived += len;
+        }
+        size_t waiting = this->ring.available();
+        if (waiting > this->stats.ringPeak)
+        {
+            this->stats.ringPeak = waiting;
+        }
+    }
+
+    bool Sensor::pending()
+    {
+        return this->ring.available() > 0 || this->frame_count > 0;
+    }
+
 // private:
 
     // state machine ------------------------------------------------------------------------------
@@ -92,7 +216,18 @@ uint64_t millis64()
     {
         if (this->state != INIT)
         {
-            if (this->state != STANDBY && ((millis() - this->last_state_reset) > (READ_TIMEOUT * 1000)))
+            if (this->input_lost)
+            {
+                this->input_lost = false;
+                if (this->state == READ_MESSAGE || this->state == READ_CHECKSUM)
+                {
+                    this->reset_state("Input lost, starting over.");
+                }
+            }
+            // the timeout only applies when all received input has been handled, the ring buffer may hold input
+            // received before the time out
+            if (this->state != STANDBY && this->ring.available() == 0 &&
+                ((millis() - this->last_state_reset) > (READ_TIMEOUT * 1000)))
             {
                 DEBUG("Did not receive an SML message within %d seconds, starting over.", READ_TIMEOUT);
                 this->reset_state();
@@ -108,9 +243,6 @@ uint64_t millis64()
             case READ_MESSAGE:
                 this->read_message();
                 break;
-            case PROCESS_MESSAGE:
-                this->process_message();
-                break;
             case READ_CHECKSUM:
                 this->read_checksum();
                 break;
@@ -120,23 +252,17 @@ uint64_t millis64()
         }
     }
 
-    // Wrappers for sensor access -----------------------------------------------------------------
-    int Sensor::data_available()
-    {
-        return this->serial->available();
-    }
-    int Sensor::data_read()
-    {
-        return this->serial->read();
-    }
-
     // Set new state, debug messages, update some attributes---------------------------------------
     void Sensor::set_state(State new_state)
     {
-        // call back to main() to update state
-        if(new_state != PROCESS_MESSAGE)
+        // call back to main() to update state; not from receive() during the processing of a telegram
+        if (this->processing)
+        {
+            this->state_deferred = true;
+        }
+        else
         {
-            this->callback(this->buffer, this->position, this, new_state);
+            this->callback(this->frame ? this->frame->data : NULL, this->position, this, new_state);
         }
         if (new_state == STANDBY)
         {
@@ -147,6 +273,14 @@ uint64_t millis64()
             DEBUG("State of sensor %s is 'WAIT_FOR_START_SEQUENCE'.", this->config->name);
             this->last_state_reset = millis();
             this->position = 0;
+            this->frame_waiting = false;
+            if (this->frame != NULL)
+            {
+                // telegram not received completely
+                this->release_frame(this->frame);
+                this->frame = NULL;
+            }
+            this->scanner.reset();
             this->state = new_state;
             return;     // return to loop()
         }
@@ -159,10 +293,6 @@ uint64_t millis64()
             DEBUG("State of sensor %s is 'READ_CHECKSUM'.", this->config->name);
             this->bytes_until_checksum = 3;
         }
-        else if (new_state == PROCESS_MESSAGE)
-        {
-            DEBUG("State of sensor %s is 'PROCESS_MESSAGE'.", this->config->name);
-        };
         this->state = new_state;
     }
 
@@ -186,11 +316,7 @@ uint64_t millis64()
     void Sensor::standby()
     {
         // Keep buffers clean
-        while (this->data_available())
-        {
-            this->data_read();
-            yield();
-        }
+        this->ring.clear();
 
         if (millis64() >= this->standby_until)
         {
@@ -201,50 +327,128 @@ uint64_t millis64()
     // Wait for the start_sequence to appear ------------------------------------------------------
     void Sensor::wait_for_start_sequence()
     {
-        while (this->data_available())
+        SML_PROFILE_SCOPE(PROFILE_START_SEARCH);
+        if (this->frame_waiting)
         {
-            this->buffer[this->position] = this->data_read();
-            yield();
-
-            this->position = (this->buffer[this->position] == START_SEQUENCE[this->position]) ? (this->position + 1) : 0;
-            if (this->position == sizeof(START_SEQUENCE))
+            this->start_frame();
+            if (this->frame_waiting || this->state != WAIT_FOR_START_SEQUENCE)
+            {
+                return;
+            }
+        }
+        const byte *data;
+        size_t len;
+        while ((len = this->ring.peek(&data)) > 0)
+        {
+            size_t consumed;
+            SmlScanResult result = this->scanner.findStart(data, len, &consumed);
+            this->ring.consume(consumed);
+            if (result == SML_SCAN_START)
             {
                 // Start sequence has been found
+                uint64_t now = millis64();
+                this->start_ms = (uint32_t)now;
+                this->start_epoch_ms = smlTimeBase()->epochMs(now);
                 DEBUG("Start sequence found.");
-                this->set_state(READ_MESSAGE);
-                return;
+                this->frame_waiting = true;
+                this->start_frame();
+                if (this->frame_waiting || this->state != WAIT_FOR_START_SEQUENCE)
+                {
+                    return;
+                }
             }
         }
     }
 
-    // Read the rest of the message ---------------------------------------------------------------
-    void Sensor::read_message()
+    // Read the telegram into a free frame buffer -------------------------------------------------
+    void Sensor::start_frame()
     {
-        while (this->data_available())
+        SensorFrame *next = &this->frames[(this->frame_head + this->frame_count) % SENSOR_FRAME_BUFFERS];
+        if (this->frame_count < SENSOR_FRAME_BUFFERS)
         {
-            // Check whether the buffer is still big enough to hold the number of fill bytes (1 byte) and the checksum (2 bytes)
-            if ((this->position + 3) == BUFFER_SIZE)
+            // the largest telegram so far and a quarter more
+            size_t len = this->stats.frameMax ? this->stats.frameMax + this->stats.frameMax / 4 : FRAME_FIRST_SIZE;
+            next->data = smlFramePool()->alloc((len < BUFFER_SIZE) ? len : BUFFER_SIZE, &next->size);
+        }
+        if (this->frame_count == SENSOR_FRAME_BUFFERS || next->data == NULL)
+        {
+            // all frame buffers wait for the processing or no room in the pool: the telegram waits in the ring buffer
+            if (this->ring.space() > 0)
             {
-                this->reset_state("Buffer will overflow, starting over.");
                 return;
             }
-            this->buffer[this->position++] = this->data_read();
-            yield();
+            // ring buffer full as well: drop the telegram, the search of the next start sequence skips its bytes
+            this->stats.framesDropped++;
+            this->frame_waiting = false;
+            DEBUG("No free frame buffer, telegram dropped.");
+            return;
+        }
+        this->frame_waiting = false;
+        this->frame = next;
+        this->frame->ms = this->start_ms;
+        this->frame->epochMs = this->start_epoch_ms;
+        memcpy(this->frame->data, START_SEQUENCE, sizeof(START_SEQUENCE));
+        this->position = sizeof(START_SEQUENCE);
+        this->frame->entries.begin();
+        this->set_state(READ_MESSAGE);
+    }
 
-            // Check for end sequence
-            int last_index_of_end_seq = sizeof(END_SEQUENCE) - 1;
-            for (int i = 0; i <= last_index_of_end_seq; i++)
+    // Read the rest of the message ---------------------------------------------------------------
+    void Sensor::read_message()
+    {
+        SML_PROFILE_SCOPE(PROFILE_END_SEARCH);
+        const byte *data;
+        size_t len;
+        while ((len = this->ring.peek(&data)) > 0)
+        {
+            size_t consumed;
+            uint32_t restarts = this->scanner.restarts();
+            SmlScanResult result = this->scanner.readMessage(data, len, &consumed, this->frame->data, &this->position,
+                                                            this->frame->size);
+            this->ring.consume(consumed);
+            if (this->stream_decode)
             {
-                if (END_SEQUENCE[last_index_of_end_seq - i] != this->buffer[this->position - (i + 1)])
+                // a start sequence within the message restarts the frame, also in the block of the end sequence
+                if (this->scanner.restarts() != restarts)
                 {
-                    break;
+                    this->frame->entries.begin();
                 }
-                if (i == last_index_of_end_seq)
+                // decode the entries received so far; at the end read_checksum() decodes the rest
+                size_t settled = (result != SML_SCAN_END) ? this->scanner.settled(this->position) : 0;
+                if (settled > SML_START_LEN)
                 {
-                    DEBUG("End sequence found.");
-                    this->set_state(READ_CHECKSUM);
+                    this->frame->entries.feed(this->frame->data + SML_START_LEN, settled - SML_START_LEN);
+                }
+            }
+            switch (result)
+            {
+            case SML_SCAN_END:
+                DEBUG("End sequence found.");
+                this->set_state(READ_CHECKSUM);
+                return;
+            case SML_SCAN_OVERFLOW:
+                if (this->frame->size < BUFFER_SIZE)
+                {
+                    // larger telegram than so far: grow the frame buffer and go on
+                    size_t size = 2 * this->frame->size;
+                    if (smlFramePool()->grow(&this->frame->data, &this->frame->size, (size < BUFFER_SIZE) ? size : BUFFER_SIZE,
+                                             this->position))
+                    {
+                        break;
+                    }
+                    this->stats.framesDropped++;
+                    this->reset_state("No room in the frame pool, telegram dropped.");
                     return;
                 }
+                this->stats.framingErrors++;
+                this->reset_state("Buffer will overflow, starting over.");
+                return;
+            case SML_SCAN_ERROR:
+                this->stats.framingErrors++;
+                this->reset_state("Invalid escape sequence, starting over.");
+                return;
+            default:
+                break;
             }
         }
     }
@@ -252,44 +456,123 @@ uint64_t millis64()
     // Read the number of fillbytes and the checksum  ---------------------------------------------
     void Sensor::read_checksum()
     {
-        while (this->bytes_until_checksum > 0 && this->data_available())
+        const byte *data;
+        size_t len;
+        while (this->bytes_until_checksum > 0 && (len = this->ring.peek(&data)) > 0)
         {
-            this->buffer[this->position++] = this->data_read();
-            this->bytes_until_checksum--;
-            yield();
+            if (len > this->bytes_until_checksum)
+            {
+                len = this->bytes_until_checksum;
+            }
+            memcpy(&this->frame->data[this->position], data, len);
+            this->position += len;
+            this->bytes_until_checksum -= len;
+            this->ring.consume(len);
         }
 
         if (this->bytes_until_checksum == 0)
         {
-            DEBUG("Message has been read. Lenght=%d", this->position);
-            DEBUG_DUMP_BUFFER(this->buffer, this->position);
-            this->set_state(PROCESS_MESSAGE);
+            DEBUG("Message has been read. Lenght=%u", (unsigned)this->position);
+            DEBUG_DUMP_BUFFER(this->frame->data, this->position);
+
+            // the CRC covers the number of fill bytes, the CRC itself is sent low byte first
+            byte *trailer = &this->frame->data[this->position - SML_TRAILER_LEN];
+            uint16_t crc = smlCrc16Final(smlCrc16Byte(this->scanner.crc(), trailer[0]));
+            bool crcOk = (crc == (trailer[1] | (trailer[2] << 8)));
+            if (this->stream_decode)
+            {
+                // the rest of the message, then the CRC commits the decoded entries or discards them
+                SmlObisStream &entries = this->frame->entries;
+                size_t message_len = this->position - SML_START_LEN - sizeof(END_SEQUENCE) - SML_TRAILER_LEN;
+                uint8_t early = entries.count();
+                if (entries.finish(this->frame->data + SML_START_LEN, message_len, crcOk))
+                {
+                    this->stats.framesDecoded++;
+                    this->stats.entriesEarly += early;
+                }
+                else if (!crcOk && entries.count() > 0)
+                {
+                    this->stats.framesDiscarded++;
+                }
+            }
+            if (!crcOk)
+            {
+                this->stats.crcErrors++;
+                if (SML_CRC_CHECK)
+                {
+                    DEBUG("CRC error: calculated %04X, received %02X%02X.", crc, trailer[2], trailer[1]);
+                    this->reset_state("Message dropped, starting over.");
+                    return;
+                }
+            }
+            this->frame_received();
         }
     }
 
-    // Process message by callback function -------------------------------------------------------
-    void Sensor::process_message()
+    // Hand the received telegram over to the processing ------------------------------------------
+    void Sensor::frame_received()
     {
-        DEBUG("Message is being processed.");
-
-        if (this->config->interval > 0)
+        this->frame->len = this->position;
+        smlFramePool()->shrink(this->frame->data, &this->frame->size, this->position);
+        if (this->position > this->stats.frameMax)
         {
-            this->standby_until = millis64() + (this->config->interval * 1000);
-        }
-
-        // Call listener
-        if (this->callback != NULL)
-        {
-            this->callback(this->buffer, this->position, this, this->state);
+            this->stats.frameMax = this->position;
         }
+        this->frame = NULL;
+        this->frame_count++;
+        this->stats.framesReceived++;
 
         // Go to standby mode, if throttling is enabled
         if (this->config->interval > 0)
         {
+            this->standby_until = millis64() + (this->config->interval * 1000);
             this->set_state(STANDBY);
             return;
         }
 
         // Start over if throttling is disabled
         this->reset_state();
+    }
+
+    // Return the frame buffer to the pool -------------------------------------------------------
+    void Sensor::release_frame(SensorFrame *frame)
+    {
+        smlFramePool()->release(frame->data, frame->size);
+        frame->data = NULL;
+        frame->size = 0;
+    }
+
+    // Process the oldest received telegram by callback function ----------------------------------
+    void Sensor::process_message()
+    {
+        // not nested: the callback may call receive(), but not loop()
+        if (this->processing || this->frame_count == 0)
+        {
+            return;
+        }
+        DEBUG("Message is being processed.");
+        this->processing = true;
+        SensorFrame *message = &this->frames[this->frame_head];
+        this->frame_ms = message->ms;
+        this->frame_epoch_ms = message->epochMs;
+        this->frame_entries = &message->entries;
+
+        // Call listener
+        if (this->callback != NULL)
+        {
+            this->callback(message->data, message->len, this, PROCESS_MESSAGE);
+        }
+        this->frame_entries = NULL;
+        this->stats.framesProcessed++;
+
+        // the frame buffer is free for the reception
+        this->release_frame(message);
+        this->frame_head = (this->frame_head + 1) % SENSOR_FRAME_BUFFERS;
+        this->frame_count--;
+        this->processing = false;
+        if (this->state_deferred)
+        {
+            this->state_deferred = false;
+            this->callback(this->frame ? this->frame->data : NULL, this->position, this, this->state);
+        }
     }
\ No newline at end of file
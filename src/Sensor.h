@@ -1,13 +1,21 @@
 #ifndef SENSOR_H
 #define SENSOR_H
 
-#include <SoftwareSerial.h>
-
-// SML constants
-const byte START_SEQUENCE[] = {0x1B, 0x1B, 0x1B, 0x1B, 0x01, 0x01, 0x01, 0x01};
-const byte END_SEQUENCE[] = {0x1B, 0x1B, 0x1B, 0x1B, 0x1A};
+#include <memory>
+#include "hal.h"
+#include "smlFramePool.h"
+#include "smlRingBuffer.h"
+#include "smlScanner.h"
+#include "smlStream.h"
+
+// SML constants (start and end sequence: see smlScanner.h)
 const size_t BUFFER_SIZE = 3840; // Max datagram duration 400ms at 9600 Baud
+const size_t FRAME_FIRST_SIZE = 1024; // frame buffer for the first telegram, later the learned size (smlFramePool.cpp)
 const uint8_t READ_TIMEOUT = 30;
+const size_t RING_BUFFER_SIZE = 1024; // input buffer, power of 2; about 1s at 9600 Baud
+#ifndef SENSOR_FRAME_BUFFERS
+#define SENSOR_FRAME_BUFFERS 2          // one receives while the others wait for the processing; from SmlFramePool
+#endif
 
 // States
 enum State
@@ -31,17 +39,80 @@ public:
     const uint8_t interval;
 };
 
+// a received telegram, handed from the reception to the processing (callback)
+struct SensorFrame
+{
+    byte *data = NULL;              // run of smlFramePool(), NULL if unused
+    size_t size = 0;                // bytes of the run
+    size_t len;
+    uint32_t ms;                    // millis() of the start sequence
+    uint64_t epochMs;               // the same as epoch ms (smlTime.cpp)
+    SmlObisStream entries;          // decoded during the reception (smlStream.cpp)
+};
+
+// counters of a sensor
+struct SensorStats
+{
+    uint32_t bytesReceived;
+    uint32_t ringFull;              // pump() stopped because the ring buffer was full, input waits in the byte source
+    uint32_t sourceOverflows;       // input lost in the byte source (e.g. SoftwareSerial buffer)
+    uint32_t framingErrors;         // message too long or invalid escape sequence
+    uint32_t crcErrors;             // messages rejected because of a CRC mismatch
+    uint32_t ringPeak;              // most bytes waiting in the ring buffer, margin of the scheduling of the sensors
+    uint32_t framesReceived;        // telegrams with valid CRC handed to the processing
+    uint32_t framesProcessed;       // telegrams passed to the callback
+    uint32_t framesDropped;         // telegrams not received: all frame buffers busy or no room in the frame pool
+    uint32_t frameMax;              // largest telegram, sets the frame buffer asked for at the start sequence
+    uint32_t framesDecoded;         // telegrams with entries decoded during the reception and committed by the CRC
+    uint32_t framesDiscarded;       // telegrams with decoded entries discarded because of a CRC error
+    uint32_t entriesEarly;          // entries decoded before the end sequence was received
+};
+
 class Sensor
 {
 public:
     const SensorConfig *config;
+    SensorStats stats = {};
+    uint8_t meter = 0;              // index of the reading head, selects the channels (set by SmlScheduler::add())
     Sensor(const SensorConfig *config, void (*callback)(byte *buffer, size_t len, Sensor *sensor, State sensorState));
+    Sensor(const SensorConfig *config, ByteSource *source, void (*callback)(byte *buffer, size_t len, Sensor *sensor, State sensorState));
+    ~Sensor();
+    // reception, then processing of the oldest received telegram
     void loop();
+    // move received bytes from the byte source to the ring buffer
+    void pump();
+    // pump() and framing into a spare frame buffer, no processing; call it during long operations, e.g. http posts
+    void receive();
+    // true if received input or a received telegram is waiting
+    bool pending();
+    // millis() when the start sequence of the telegram being processed was found
+    uint32_t frameMs() const { return frame_ms; }
+    // the same as epoch ms of smlTimeBase() (smlTime.cpp), the time stamp of the values of the telegram
+    uint64_t frameEpochMs() const { return frame_epoch_ms; }
+    // entries of the telegram being processed, decoded during its reception; NULL outside of the processing
+    const SmlObisStream *frameEntries() const { return frame_entries; }
+    // decode the entries during the reception (SML_STREAM_DECODE)
+    void setStreamDecode(bool on) { stream_decode = on; }
 
 private:
-    std::unique_ptr<SoftwareSerial> serial;
-    byte buffer[BUFFER_SIZE];
+    std::unique_ptr<ByteSource> source;
+    SmlRingBuffer<RING_BUFFER_SIZE> ring;
+    SmlScanner scanner;
+    bool input_lost = false;
+    SensorFrame frames[SENSOR_FRAME_BUFFERS];
+    SensorFrame *frame = NULL;          // frame buffer of the reception
+    uint8_t frame_head = 0;             // oldest received telegram
+    uint8_t frame_count = 0;            // received telegrams, including the one being processed
+    bool processing = false;
+    bool state_deferred = false;        // state changed by receive() during the processing, reported after it
+    bool frame_waiting = false;         // start sequence found, no free frame buffer yet
+    uint32_t start_ms = 0;              // times of the start sequence of the waiting telegram
+    uint64_t start_epoch_ms = 0;
     size_t position = 0;
+    uint32_t frame_ms = 0;
+    uint64_t frame_epoch_ms = 0;
+    const SmlObisStream *frame_entries = NULL;
+    bool stream_decode = true;
     unsigned long last_state_reset = 0;
     uint64_t standby_until = 0;
     uint8_t bytes_until_checksum = 0;
@@ -51,10 +122,6 @@ private:
 
     void run_current_state();
 
-    // Wrappers for sensor access
-    int data_available();
-    int data_read();
-
     // Set state
     void set_state(State new_state);
 
@@ -72,9 +139,18 @@ private:
     // Read the rest of the message
     void read_message();
 
+    // Read the telegram into a free frame buffer
+    void start_frame();
+
     // Read the number of fillbytes and the checksum
     void read_checksum();
 
+    // Hand the received telegram over to the processing
+    void frame_received();
+
+    // Return the frame buffer to the pool
+    void release_frame(SensorFrame *frame);
+
     void process_message();
 };
 #endif  //SENSOR_H
\ No newline at end of file
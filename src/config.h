@@ -11,7 +11,7 @@
 // Identify configuration info in EEPROM, Modifying cause a loss of the existig configuration in EEPROM
 // note: EEPROM configuration remains unchanged after firmware update; update main version count if you are using a new application
 // otherwise the previous configuration is considered valid.
-#define WIFI_AP_CONFIG_VERSION "2.2.1"      // 4 bytes are significant for check with EEPROM (IOTWEBCONF_CONFIG_VERSION_LENGTH in confWebSettings.h)
+#define WIFI_AP_CONFIG_VERSION "2.5.0"      // 4 bytes are significant for check with EEPROM (IOTWEBCONF_CONFIG_VERSION_LENGTH in confWebSettings.h)
 
 #define WIFI_AP_SSID "YourSMLReaderVZ"
 #define WIFI_AP_IP "192.168.4.1"            // default address, set by the framework.
@@ -28,13 +28,28 @@
 #define TIMEZONE +1                     // Central europe
 #define TIMEZONE_DEFAULT "1"            // string default for configuration
 
-// sensor config
+// sensor config: one entry per reading head (meter), the channels of a further meter have the word meter2..meter4
+// (smlChannel.cpp); about 4.5 KB RAM per reading head (ring buffer of Sensor, SoftwareSerial) and the frame buffers
+// of all heads in SML_FRAME_POOL_SIZE (smlFramePool.h), to be increased for several meters with large telegrams
 static const SensorConfig SENSOR_CONFIGS[] = {
     {.pin = D2,                                 // input pin
      .name = "yourMeterName",                   // name of meter for debug and MQTT
      .numeric_only = false,
-     .interval = 5}};                           // read out interval in sec, 0=no wait
+     .interval = 5},                            // read out interval in sec, 0=no wait
+//  {.pin = D5, .name = "yourHeatPump", .numeric_only = false, .interval = 5},     // meter2
+//  {.pin = D6, .name = "yourPvInverter", .numeric_only = false, .interval = 5},   // meter3
+};
 const uint8_t NUM_OF_SENSORS = sizeof(SENSOR_CONFIGS) / sizeof(SensorConfig);
+#define SML_METERS_MAX 4                // reading heads, limited by SML_CHANNEL_METER (2 bits of the channel flags)
+#ifndef SML_CRC_CHECK
+#define SML_CRC_CHECK true              // drop messages with CRC error; false: count CRC errors only (meters with wrong CRC)
+#endif
+#ifndef SML_LAYOUT_CACHE
+#define SML_LAYOUT_CACHE true           // values of repeated telegrams by the offsets of a complete parse (smlLayout.cpp)
+#endif
+#ifndef SML_STREAM_DECODE
+#define SML_STREAM_DECODE true          // entries decoded during the reception, committed by the CRC (smlStream.cpp)
+#endif
 
 
 // build in LED is inverted for Wemos D1 mini
@@ -45,14 +60,28 @@ const uint8_t NUM_OF_SENSORS = sizeof(SENSOR_CONFIGS) / sizeof(SensorConfig);
 #define HEART_BEAT_RESET 1
 #define HEART_BEAT_WIFI_CONFIG 2
 
-// Verbose Level
+// Verbose Level, can be overwritten by build flags
+#ifndef VERBOSE_LEVEL_WLAN
 #define VERBOSE_LEVEL_WLAN  1
+#endif
+#ifndef VERBOSE_LEVEL_HTTP
 #define VERBOSE_LEVEL_HTTP  0
+#endif
+#ifndef VERBOSE_LEVEL_MeterData
 #define VERBOSE_LEVEL_MeterData  1
+#endif
+#ifndef VERBOSE_LEVEL_MeterProtocol
 #define VERBOSE_LEVEL_MeterProtocol  0
+#endif
+#ifndef VERBOSE_LEVEL_Setup
 #define VERBOSE_LEVEL_Setup  1
+#endif
+#ifndef VERBOSE_LEVEL_Loop
 #define VERBOSE_LEVEL_Loop 0
+#endif
+#ifndef VERBOSE_LEVEL_TIME
 #define VERBOSE_LEVEL_TIME 0
+#endif
 
 #define DATE_UPDATE_INTERVAL 60000      // in ms; for Dash Board
 
@@ -61,6 +90,58 @@ const uint8_t NUM_OF_SENSORS = sizeof(SENSOR_CONFIGS) / sizeof(SensorConfig);
 #define VZ_MIDDLEWARE       "middleware.php"
 #define VZ_DATA_JSON        "data.json"
 #define VZ_UUID_NO_SEND     "null"        // use this uuid if you do not want to transmit data for a channel
+#ifndef VZ_HTTP_KEEP_ALIVE
+#define VZ_HTTP_KEEP_ALIVE  true          // one persistent connection to the server instead of a connection per value
+#endif
+#ifndef VZ_HTTP_RESOLVE_ONCE
+#define VZ_HTTP_RESOLVE_ONCE true         // resolve the server name once (again after a connection error),
+#endif                                    // the Host header is still the name
+#ifndef VZ_BATCH_TUPLES
+#define VZ_BATCH_TUPLES     8             // tuples per channel posted in one request to data/<uuid>.json ([[ts,value],...]),
+#endif                                    // 16 bytes RAM per tuple and channel; 1: one request per value
+#ifndef VZ_BATCH_MAX_AGE
+#define VZ_BATCH_MAX_AGE    30            // s, a batch is posted at the end of the telegram when its first tuple is older;
+#endif                                    // 0: post at the end of each telegram
+#define VZ_HTTP_BODY_MAX    (VZ_BATCH_TUPLES * 40 + 8)   // request body of a batch
+#ifndef VZ_HTTP_ASYNC
+#define VZ_HTTP_ASYNC       true          // queue the requests and send them from loop() (smlAsyncHttp.cpp, ESPAsyncTCP),
+#endif                                    // false: HTTPClient, loop() waits for each response
+#ifndef VZ_HTTP_QUEUE
+#define VZ_HTTP_QUEUE       4             // queued requests, about 680 bytes RAM each with VZ_BATCH_TUPLES 8
+#endif
+#define VZ_HTTP_TIMEOUT     5000          // ms for connect and response of an asynchronous request
+#define VZ_HTTP_RETRY       5000          // ms before an asynchronous request is sent again after an error
+#define VZ_HTTP_ATTEMPTS    3             // an asynchronous request is dropped after this number of errors
+
+// backlog in flash while the server is unreachable (smlBacklog.cpp)
+#ifndef VZ_BACKLOG
+#define VZ_BACKLOG          true          // tuples of failed posts are stored in LittleFS and posted later
+#endif
+#define VZ_BACKLOG_DIR      "/vzlog"
+#define VZ_BACKLOG_SEGMENT  4096          // bytes per segment file, 256 records of 16 bytes
+#ifndef VZ_BACKLOG_SEGMENTS
+#define VZ_BACKLOG_SEGMENTS 64            // at most 64 * 4 KB flash; when full the oldest segment is removed
+#endif
+#define VZ_BACKLOG_BUFFER   16            // records collected in RAM and written at once (one 256 byte flash page)
+#define VZ_BACKLOG_DRAIN    4             // requests per telegram to post the backlog when the server is back
+#define VZ_BACKLOG_CURSOR   64            // posted records between two writes of the cursor
+
+// time stamps of the telegrams: monotonic ms + offset to the system (NTP) time (smlTime.cpp)
+#define SML_TIME_STEP_MS    2000          // larger difference to the system time: the offset is set at once
+#define SML_TIME_SLEW_MS    5             // smaller difference: offset corrected by at most this per telegram
+
+// power derived from an energy counter (channel "derive", smlDerive.cpp)
+#define SML_DERIVE_MIN_MS   5000          // min. time between two power values calculated from counter steps
+
+// history of the last telegrams in RAM, /history on the web server (smlHistory.cpp)
+#ifndef SML_HISTORY_SAMPLES
+#define SML_HISTORY_SAMPLES  300          // telegrams, (2 + 4 * SML_HISTORY_CHANNELS) bytes each
+#endif
+#define SML_HISTORY_CHANNELS 3            // the first channels of the channel table
+#define SML_HISTORY_DECIMALS 1            // values stored as integers of value * 10^decimals
+#ifndef SML_HISTORY_INTERVAL
+#define SML_HISTORY_INTERVAL 0            // ms between two samples, 0: each telegram; e.g. 6000: 1 hour of history
+#endif
 
 // SMLReader channels: replace by your UUIDs created in VZ frontend
 #define VZ_UUID_POWER_IN            "power-in"                              // 3 
@@ -74,4 +155,15 @@ const uint8_t NUM_OF_SENSORS = sizeof(SENSOR_CONFIGS) / sizeof(SensorConfig);
 #define OBIS_ID_ENERGY_OUT  "1-0:2.8.0*255"
 #define OBIS_ID_POWER_IN    "1-0:16.7.0*255"
 
+// channel table (smlChannel.cpp): "OBIS id, UUID[, factor[, min interval s[, deadband[%][, max interval s[, words]]]]]",
+// editable on the configuration page
+#ifndef SML_CHANNELS_MAX
+#define SML_CHANNELS_MAX    12          // 56 bytes EEPROM and about 300 bytes RAM per channel
+#endif
+// energy: change of more than 1 Wh, at least every 5 min; power: change of more than 2 %, at least every minute,
+// at once on a change between import and export
+#define SML_CHANNEL_DEFAULTS {OBIS_ID_ENERGY_IN "," VZ_UUID_ENERGY_IN ",1,0,1,300", \
+                              OBIS_ID_ENERGY_OUT "," VZ_UUID_ENERGY_OUT ",1,0,1,300", \
+                              OBIS_ID_POWER_IN "," VZ_UUID_POWER_IN ",1,0,2%,60,dir"}
+
 #endif
\ No newline at end of file
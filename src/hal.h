@@ -0,0 +1,208 @@
+#ifndef HAL_H
+#define HAL_H
+
+/* *** hal.h hardware abstraction layer for the receive -> parse -> publish path
+
+2026-10-17 mh
+- first version: byte source, clock, http transport and dash board sink as small interfaces
+- host (native) replacements for the few Arduino core functions used by Sensor and SmlHttp
+- ByteSource: bulk readBytes() and overflow()
+- HttpTransport: persistent connection (setKeepAlive(), close()), counters in HttpTransport::stats
+- HttpTransport: loop() and busy() for asynchronous transports; TcpConnection: non-blocking TCP client
+- HttpListener: result of the requests of an asynchronous transport
+- SegmentStorage: numbered append-only files of the backlog (LittleFS on the ESP8266)
+- DashSink::values() with scaled integers instead of double
+- DashSink::values() of a meter (several reading heads, smlScheduler.cpp)
+
+(C) M. Herbert, 2026.
+Licensed under the GNU General Public License v3.0
+
+*** end change log *** */
+
+/* ***
+# Description hal.h #
+The SML path (Sensor -> libsml -> SmlHttp -> dash board) only talks to the hardware through
+the interfaces below. The ESP8266 implementation is in halArduino.cpp, the host implementation
+(PlatformIO env:native) in halNative.cpp. Selection is done by the ARDUINO define of the framework.
+
+- ByteSource:     serial input of the reading head (SoftwareSerial, file, replay ...)
+- Clock:          millis() and system time (gettimeofday)
+- HttpTransport:  POST of a request body to an url, by default over one kept HTTP/1.1 connection
+- TcpConnection:  non-blocking TCP client of the asynchronous http transport (smlAsyncHttp.cpp)
+- SegmentStorage: append-only segment files of the backlog in flash (smlBacklog.cpp)
+- DashSink:       output of status and meter values (ESP-Dash cards, stdout ...)
+
+*** end description *** */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <sys/time.h>
+
+#ifdef ARDUINO
+    #include <Arduino.h>
+#else
+    #include <stdio.h>
+
+    // host build: minimal replacements of the Arduino core functions used by the SML path
+    typedef uint8_t byte;
+    inline void yield() {}
+    uint32_t millis();              // provided by halNative.cpp, runs on halClock()
+
+    #define HEX 16
+    #define PROGMEM
+    #define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+    #define pgm_read_word(addr) (*(const uint16_t *)(addr))
+    class HostSerial
+    {
+    public:
+        void print(const char *s) { fputs(s, stdout); }
+        void print(int value, int base = 10) { printf(base == HEX ? "%X" : "%d", value); }
+        void print(double value) { printf("%.2f", value); }
+        void println() { fputc('\n', stdout); }
+        void println(const char *s) { print(s); println(); }
+        void println(int value, int base = 10) { print(value, base); println(); }
+        void flush() { fflush(stdout); }
+    };
+    extern HostSerial Serial;
+
+    // pin numbers are meaningless on the host, only needed to compile SENSOR_CONFIGS
+    #ifndef D2
+        #define D2 4
+    #endif
+    #ifndef D3
+        #define D3 0
+    #endif
+#endif
+
+// serial input of a reading head
+class ByteSource
+{
+public:
+    virtual ~ByteSource() {}
+    virtual int available() = 0;
+    virtual int read() = 0;             // -1 if no data
+    // read up to len bytes that are available, returns number of bytes read
+    virtual size_t readBytes(byte *buffer, size_t len)
+    {
+        size_t count = 0;
+        int value;
+        while (count < len && (value = read()) >= 0)
+        {
+            buffer[count++] = (byte)value;
+        }
+        return count;
+    }
+    // true if input was lost since the last call
+    virtual bool overflow() { return false; }
+};
+
+// time base
+class Clock
+{
+public:
+    virtual ~Clock() {}
+    virtual uint32_t millis() = 0;
+    virtual void getTimeOfDay(struct timeval *tv) = 0;
+};
+
+// counters of a http transport
+struct HttpStats
+{
+    uint32_t posts = 0;
+    uint32_t connects = 0;              // new connections, i.e. posts - connects used a kept connection
+    uint32_t resolves = 0;              // DNS look ups of the server name
+    uint32_t retries = 0;               // kept connection closed by the server, post repeated on a new connection
+    uint32_t failures = 0;              // posts without response
+    // asynchronous transport
+    uint32_t dropped = 0;               // posts rejected because the queue was full
+    uint8_t depth = 0;                  // requests in the queue, including the one in flight
+    uint8_t inFlight = 0;               // requests sent and waiting for the response
+};
+
+const int HTTP_QUEUED = 0;              // post() of an asynchronous transport: the request is queued
+const int HTTP_QUEUE_FULL = -100;       // post() of an asynchronous transport: the request is dropped
+
+// result of a request queued by an asynchronous transport, called by its loop(); must not post()
+class HttpListener
+{
+public:
+    virtual ~HttpListener() {}
+    // id: HttpStats::posts after the post() of the request; code: http response code, or < 0 if the request was
+    // dropped after VZ_HTTP_ATTEMPTS errors
+    virtual void requestDone(uint32_t id, int code) = 0;
+};
+
+// http transfer to the data base
+class HttpTransport
+{
+public:
+    virtual ~HttpTransport() {}
+    // returns the http response code or a negative value on connection errors,
+    // HTTP_QUEUED or HTTP_QUEUE_FULL for an asynchronous transport
+    virtual int post(const char *url, const char *contentType, const char *body) = 0;
+    // asynchronous transport: send the queued requests, to be called by loop(); true while requests are queued
+    virtual void loop() {}
+    virtual bool busy() { return false; }
+    // asynchronous transport: the result of each queued request, NULL: none
+    virtual void setListener(HttpListener *listener) { (void)listener; }
+    // keep the connection of the server for the next post, default: on
+    virtual void setKeepAlive(bool keepAlive) { (void)keepAlive; }
+    // resolve the server name only for the first connection (and after an error), default: on
+    virtual void setResolveOnce(bool resolveOnce) { (void)resolveOnce; }
+    virtual void close() {}
+    HttpStats stats;
+};
+
+// non-blocking TCP client: no call waits for the network
+enum TcpState
+{
+    TCP_CLOSED,                         // not connected, connect failed or closed by the server
+    TCP_CONNECTING,
+    TCP_CONNECTED
+};
+class TcpConnection
+{
+public:
+    virtual ~TcpConnection() {}
+    virtual bool connect(const char *host, uint16_t port) = 0;     // start to connect, false on an immediate error
+    virtual TcpState state() = 0;
+    virtual size_t write(const char *data, size_t len) = 0;        // bytes taken for sending, may be less than len
+    virtual size_t read(char *buffer, size_t size) = 0;            // received bytes, 0 if there are none
+    virtual void close() = 0;
+};
+
+// numbered append-only files (segments) and a small state file, e.g. LittleFS
+class SegmentStorage
+{
+public:
+    virtual ~SegmentStorage() {}
+    virtual bool begin() = 0;                                       // mount, create the directory
+    virtual bool range(uint32_t *first, uint32_t *last) = 0;        // numbers of the segments, false if there are none
+    virtual bool append(uint32_t segment, const void *data, size_t len) = 0;
+    virtual size_t read(uint32_t segment, size_t offset, void *data, size_t len) = 0;
+    virtual size_t size(uint32_t segment) = 0;                      // 0 if the segment does not exist
+    virtual void remove(uint32_t segment) = 0;
+    virtual bool writeState(const void *data, size_t len) = 0;
+    virtual bool readState(void *data, size_t len) = 0;
+};
+
+// output of status and meter data
+class DashSink
+{
+public:
+    virtual ~DashSink() {}
+    virtual void status(const char *text) = 0;
+    virtual void sensorState(int state) = 0;
+    // W and Wh in 10^-SML_VALUE_DECIMALS (smlDecimal.h) of the meter (Sensor::meter)
+    virtual void values(uint8_t meter, const char *timeStamp, int64_t powerIn, int64_t energyIn, int64_t energyOut) = 0;
+};
+
+// platform defaults, implemented in halArduino.cpp or halNative.cpp
+Clock *halClock();
+void halSetClock(Clock *clock);
+ByteSource *halCreateSerialSource(uint8_t pin);
+HttpTransport *halHttpTransport();
+TcpConnection *halTcpConnection();
+SegmentStorage *halSegmentStorage();
+
+#endif  // HAL_H
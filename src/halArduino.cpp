@@ -0,0 +1,461 @@
+#ifdef ARDUINO
+#include <ESP8266HTTPClient.h>
+#include <ESP8266WiFi.h>
+#include <ESPAsyncTCP.h>
+#include <LittleFS.h>
+#include <SoftwareSerial.h>
+#include "config.h"
+#include "hal.h"
+#include "smlAsyncHttp.h"
+#include "smlRingBuffer.h"
+
+/* *** halArduino.cpp ESP8266 implementation of hal.h
+
+2026-10-17 mh
+- first version: SoftwareSerial byte source, core clock and HTTPClient transport (from Sensor.cpp, smlHttp.cpp)
+- SerialByteSource: bulk read, overflow, configurable SoftwareSerial buffer sizes
+- HttpClientTransport: persistent connection, server address resolved once, one retry on a closed connection
+- HttpClientTransport: the resolved address is kept for all urls of the server (batches to data/<uuid>.json)
+- AsyncTcpConnection (ESPAsyncTCP) for the asynchronous http transport, default transport with VZ_HTTP_ASYNC
+- LittleFsSegmentStorage: segment files of the backlog (smlBacklog.cpp) in LittleFS
+
+(C) M. Herbert, 2026.
+Licensed under the GNU General Public License v3.0
+
+*** end change log *** */
+
+// SoftwareSerial input of the reading head ----------------------------------------------------
+// Received bytes are buffered in SoftwareSerial until Sensor::pump() moves them to the ring buffer of the sensor.
+// The interrupt routine of SoftwareSerial stores bit edges (4 bytes per entry, up to 10 entries per byte),
+// these are decoded to bytes in available()/read(); both buffers must bridge the longest blocking of loop().
+#ifndef SENSOR_SERIAL_BUFFER_SIZE
+    #define SENSOR_SERIAL_BUFFER_SIZE 128           // bytes
+#endif
+#ifndef SENSOR_SERIAL_ISR_BUFFER_SIZE
+    #define SENSOR_SERIAL_ISR_BUFFER_SIZE 768       // bit edges
+#endif
+
+class SerialByteSource : public ByteSource
+{
+public:
+    SerialByteSource(uint8_t pin)
+    {
+        serial.begin(9600, SWSERIAL_8N1, pin, -1, false, SENSOR_SERIAL_BUFFER_SIZE, SENSOR_SERIAL_ISR_BUFFER_SIZE);
+        serial.enableTx(false);
+        serial.enableRx(true);
+    }
+    int available() override { return serial.available(); }
+    int read() override { return serial.read(); }
+    size_t readBytes(byte *buffer, size_t len) override { return serial.read(buffer, len); }
+    bool overflow() override { return serial.overflow(); }
+
+private:
+    SoftwareSerial serial;
+};
+
+ByteSource *halCreateSerialSource(uint8_t pin)
+{
+    return new SerialByteSource(pin);
+}
+
+// clock of the Arduino core -------------------------------------------------------------------
+class CoreClock : public Clock
+{
+public:
+    uint32_t millis() override { return ::millis(); }
+    void getTimeOfDay(struct timeval *tv) override { gettimeofday(tv, NULL); }
+};
+
+CoreClock coreClock;
+Clock *currentClock = &coreClock;
+
+Clock *halClock()
+{
+    return currentClock;
+}
+void halSetClock(Clock *clock)
+{
+    currentClock = clock;
+}
+
+// http transfer using HTTPClient --------------------------------------------------------------
+// With keep-alive HTTPClient::end() leaves the connection open if the server answered with keep-alive,
+// the next begin() to the same server reuses it. With resolve once the server name is resolved by the first post
+// and the connection is opened to the address (ResolvedWiFiClient), the Host header keeps the name.
+// After an error the connection and the address are dropped and set up again by the next post.
+// WiFiClient that connects to the address resolved by HttpClientTransport instead of resolving the name again;
+// HTTPClient gets the name, so the Host header is the name of the server (name based virtual hosts, proxies)
+class ResolvedWiFiClient : public WiFiClient
+{
+public:
+    void setAddress(const char *name, const IPAddress &address)
+    {
+        snprintf(_name, sizeof(_name), "%s", name);
+        _address = address;
+    }
+    // HTTPClient::begin() takes a clone of the client
+    std::unique_ptr<WiFiClient> clone() const override
+    {
+        return std::unique_ptr<WiFiClient>(new ResolvedWiFiClient(*this));
+    }
+    using WiFiClient::connect;
+    int connect(const char *host, uint16_t port) override
+    {
+        if (_name[0] != '\0' && strcmp(host, _name) == 0)
+        {
+            return WiFiClient::connect(_address, port);
+        }
+        return WiFiClient::connect(host, port);
+    }
+
+private:
+    char _name[64] = "";
+    IPAddress _address;
+};
+
+class HttpClientTransport : public HttpTransport
+{
+public:
+    HttpClientTransport()
+    {
+        http.setReuse(true);
+    }
+    void setKeepAlive(bool keepAlive) override
+    {
+        _keepAlive = keepAlive;
+        http.setReuse(keepAlive);
+        if (!keepAlive)
+        {
+            close();
+        }
+    }
+    void setResolveOnce(bool resolveOnce) override
+    {
+        _resolveOnce = resolveOnce;
+        _resolved = false;
+    }
+    void close() override
+    {
+        disconnect();
+        _resolved = false;
+    }
+    int post(const char *url, const char *contentType, const char *body) override
+    {
+        stats.posts++;
+        bool reused = _keepAlive && http.connected();
+        int httpResponseCode = send(url, contentType, body);
+        if (httpResponseCode < 0 && reused)
+        {
+            // the server closed the kept connection in the meantime
+            stats.retries++;
+            disconnect();
+            reused = false;
+            httpResponseCode = send(url, contentType, body);
+        }
+        if (!reused)
+        {
+            stats.connects++;
+        }
+        if (httpResponseCode < 0)
+        {
+            stats.failures++;
+            close();
+        }
+        return httpResponseCode;
+    }
+
+private:
+    void disconnect()
+    {
+        // HTTPClient works on a copy of client: end() without reuse closes the connection
+        http.setReuse(false);
+        http.end();
+        http.setReuse(_keepAlive);
+    }
+    int send(const char *url, const char *contentType, const char *body)
+    {
+        if (!begin(url))
+        {
+            return HTTPC_ERROR_CONNECTION_FAILED;
+        }
+        //http.setAuthorization("REPLACE_WITH_SERVER_USERNAME", "REPLACE_WITH_SERVER_PASSWORD");
+        http.addHeader("Content-Type", contentType);
+        int httpResponseCode = http.POST((uint8_t *)body, strlen(body));
+        // Free resources, the connection is kept with setReuse(true)
+        http.end();
+        return httpResponseCode;
+    }
+    bool begin(const char *url)
+    {
+        if (!_resolveOnce)
+        {
+            return http.begin(client, url);
+        }
+        // http://host[:port]/path, the address is kept for all paths of the host
+        const char *prefix = "http://";
+        if (strncmp(url, prefix, strlen(prefix)) != 0)
+        {
+            return false;
+        }
+        const char *host = url + strlen(prefix);
+        const char *path = strchr(host, '/');
+        size_t hostLen = path ? (size_t)(path - host) : strlen(host);
+        if (!_resolved || hostLen != strlen(_host) || strncmp(host, _host, hostLen) != 0)
+        {
+            const char *colon = (const char *)memchr(host, ':', hostLen);
+            snprintf(_name, sizeof(_name), "%.*s", (int)(colon ? colon - host : hostLen), host);
+            _port = colon ? atoi(colon + 1) : 80;
+            stats.resolves++;
+            if (!WiFi.hostByName(_name, _address))
+            {
+                return false;
+            }
+            client.setAddress(_name, _address);
+            snprintf(_host, sizeof(_host), "%.*s", (int)hostLen, host);
+            _resolved = true;
+        }
+        // the name for the Host header, the client connects to _address
+        return http.begin(client, _name, _port, path ? path : "/");
+    }
+
+    ResolvedWiFiClient client;
+    HTTPClient http;
+    bool _keepAlive = true;
+    bool _resolveOnce = true;
+    bool _resolved = false;
+    char _host[80] = "";
+    char _name[64] = "";
+    uint16_t _port = 80;
+    IPAddress _address;
+};
+
+// non-blocking tcp using ESPAsyncTCP -----------------------------------------------------------
+// The callbacks of AsyncClient run in the system context between two calls of loop(); received bytes are
+// buffered until AsyncHttpTransport reads them in loop().
+class AsyncTcpConnection : public TcpConnection
+{
+public:
+    AsyncTcpConnection()
+    {
+        client.onConnect([](void *arg, AsyncClient *) { ((AsyncTcpConnection *)arg)->_state = TCP_CONNECTED; }, this);
+        client.onDisconnect([](void *arg, AsyncClient *) { ((AsyncTcpConnection *)arg)->_state = TCP_CLOSED; }, this);
+        client.onError([](void *arg, AsyncClient *, int8_t) { ((AsyncTcpConnection *)arg)->_state = TCP_CLOSED; }, this);
+        client.onTimeout([](void *, AsyncClient *client, uint32_t) { client->close(true); }, this);
+        client.onData([](void *arg, AsyncClient *, void *data, size_t len)
+                      { ((AsyncTcpConnection *)arg)->received((const byte *)data, len); }, this);
+    }
+    bool connect(const char *host, uint16_t port) override
+    {
+        close();
+        _state = TCP_CONNECTING;
+        client.setNoDelay(true);
+        if (!client.connect(host, port))        // the name is resolved asynchronously as well
+        {
+            _state = TCP_CLOSED;
+            return false;
+        }
+        return true;
+    }
+    TcpState state() override { return _state; }
+    size_t write(const char *data, size_t len) override
+    {
+        if (_state != TCP_CONNECTED || !client.canSend())
+        {
+            return 0;
+        }
+        size_t n = (len < client.space()) ? len : client.space();
+        if (n > 0)
+        {
+            n = client.add(data, n, ASYNC_WRITE_FLAG_COPY);
+            client.send();
+        }
+        return n;
+    }
+    size_t read(char *buffer, size_t size) override
+    {
+        size_t count = 0;
+        const byte *data;
+        size_t n;
+        while (count < size && (n = _rx.peek(&data)) > 0)
+        {
+            n = (n < size - count) ? n : size - count;
+            memcpy(buffer + count, data, n);
+            _rx.consume(n);
+            count += n;
+        }
+        return count;
+    }
+    void close() override
+    {
+        if (_state != TCP_CLOSED)
+        {
+            client.close(true);
+        }
+        _state = TCP_CLOSED;
+        _rx.clear();
+    }
+
+private:
+    void received(const byte *data, size_t len)
+    {
+        if (len > _rx.space())
+        {
+            client.close(true);         // response larger than expected from the middleware
+            return;
+        }
+        while (len > 0)
+        {
+            byte *space;
+            size_t n = _rx.reserve(&space);
+            n = (n < len) ? n : len;
+            memcpy(space, data, n);
+            _rx.commit(n);
+            data += n;
+            len -= n;
+        }
+    }
+
+    AsyncClient client;
+    volatile TcpState _state = TCP_CLOSED;
+    SmlRingBuffer<1024> _rx;
+};
+
+AsyncTcpConnection asyncTcpConnection;
+#if (VZ_HTTP_ASYNC)
+AsyncHttpTransport asyncHttpTransport(&asyncTcpConnection);
+#else
+HttpClientTransport httpClientTransport;
+#endif
+
+HttpTransport *halHttpTransport()
+{
+#if (VZ_HTTP_ASYNC)
+    return &asyncHttpTransport;
+#else
+    return &httpClientTransport;
+#endif
+}
+
+TcpConnection *halTcpConnection()
+{
+    return &asyncTcpConnection;
+}
+
+// segment files in LittleFS -----------------------------------------------------------------------
+class LittleFsSegmentStorage : public SegmentStorage
+{
+public:
+    bool begin() override
+    {
+        return LittleFS.begin() && (LittleFS.exists(VZ_BACKLOG_DIR) || LittleFS.mkdir(VZ_BACKLOG_DIR));
+    }
+    bool range(uint32_t *first, uint32_t *last) override
+    {
+        bool found = false;
+        Dir dir = LittleFS.openDir(VZ_BACKLOG_DIR);
+        while (dir.next())
+        {
+            String fileName = dir.fileName();
+            char *end;
+            uint32_t segment = strtoul(fileName.c_str(), &end, 16);
+            if (end == fileName.c_str() || strcmp(end, ".seg") != 0)
+            {
+                continue;
+            }
+            if (!found || segment < *first)
+            {
+                *first = segment;
+            }
+            if (!found || segment > *last)
+            {
+                *last = segment;
+            }
+            found = true;
+        }
+        return found;
+    }
+    bool append(uint32_t segment, const void *data, size_t len) override
+    {
+        File file = open(segment, "a");
+        if (!file)
+        {
+            return false;
+        }
+        bool ok = (file.write((const uint8_t *)data, len) == len);
+        file.close();
+        return ok;
+    }
+    size_t read(uint32_t segment, size_t offset, void *data, size_t len) override
+    {
+        File file = open(segment, "r");
+        if (!file)
+        {
+            return 0;
+        }
+        size_t n = file.seek(offset) ? file.read((uint8_t *)data, len) : 0;
+        file.close();
+        return n;
+    }
+    size_t size(uint32_t segment) override
+    {
+        char name[32];
+        path(segment, name, sizeof(name));
+        if (!LittleFS.exists(name))
+        {
+            return 0;
+        }
+        File file = LittleFS.open(name, "r");
+        size_t n = file ? file.size() : 0;
+        file.close();
+        return n;
+    }
+    void remove(uint32_t segment) override
+    {
+        char name[32];
+        path(segment, name, sizeof(name));
+        LittleFS.remove(name);
+    }
+    bool writeState(const void *data, size_t len) override
+    {
+        File file = LittleFS.open(VZ_BACKLOG_DIR "/cursor", "w");
+        if (!file)
+        {
+            return false;
+        }
+        bool ok = (file.write((const uint8_t *)data, len) == len);
+        file.close();
+        return ok;
+    }
+    bool readState(void *data, size_t len) override
+    {
+        if (!LittleFS.exists(VZ_BACKLOG_DIR "/cursor"))
+        {
+            return false;
+        }
+        File file = LittleFS.open(VZ_BACKLOG_DIR "/cursor", "r");
+        bool ok = file && (file.read((uint8_t *)data, len) == len);
+        file.close();
+        return ok;
+    }
+
+private:
+    void path(uint32_t segment, char *name, size_t size)
+    {
+        snprintf(name, size, VZ_BACKLOG_DIR "/%08x.seg", (unsigned)segment);
+    }
+    File open(uint32_t segment, const char *mode)
+    {
+        char name[32];
+        path(segment, name, sizeof(name));
+        return LittleFS.open(name, mode);
+    }
+};
+
+LittleFsSegmentStorage littleFsSegmentStorage;
+
+SegmentStorage *halSegmentStorage()
+{
+    return &littleFsSegmentStorage;
+}
+
+#endif  // ARDUINO
@@ -0,0 +1,686 @@
+#ifndef ARDUINO
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include "halNative.h"
+#include "smlDecimal.h"
+
+/* *** halNative.cpp host implementation of hal.h (PlatformIO env:native)
+
+2026-10-17 mh
+- first version: file byte source, system clock, socket and log http transport, stdout dash sink
+- FileByteSource: bulk readBytes()
+- SocketHttpTransport: HTTP/1.1 keep-alive, resolved address kept, one retry on a closed connection
+- SocketTcpConnection: non-blocking socket for the asynchronous http transport (smlAsyncHttp.cpp)
+- DirectorySegmentStorage: segment files of the backlog (smlBacklog.cpp) in a directory
+- StdoutDashSink: values formatted by smlDecimalFormat()
+- StdoutDashSink: meter of the values
+
+(C) M. Herbert, 2026.
+Licensed under the GNU General Public License v3.0
+
+*** end change log *** */
+
+HostSerial Serial;
+
+uint64_t hostMicros()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+// file input ----------------------------------------------------------------------------------
+FileByteSource::FileByteSource(FILE *file) : _file(file) {}
+
+int FileByteSource::available()
+{
+    if (_next < 0 && !_eof)
+    {
+        _next = fgetc(_file);
+        _eof = (_next == EOF);
+    }
+    return (_next >= 0) ? 1 : 0;
+}
+int FileByteSource::read()
+{
+    if (!available())
+    {
+        return -1;
+    }
+    int value = _next;
+    _next = -1;
+    return value;
+}
+
+size_t FileByteSource::readBytes(byte *buffer, size_t len)
+{
+    if (len == 0 || !available())
+    {
+        return 0;
+    }
+    buffer[0] = (byte)_next;
+    _next = -1;
+    return 1 + fread(buffer + 1, 1, len - 1, _file);
+}
+
+ByteSource *halCreateSerialSource(uint8_t pin)
+{
+    (void)pin;                  // there is only one "reading head" on the host: stdin
+    return new FileByteSource(stdin);
+}
+
+// clock ---------------------------------------------------------------------------------------
+SystemClock::SystemClock() : _startUs(hostMicros()) {}
+
+uint32_t SystemClock::millis()
+{
+    return (uint32_t)((hostMicros() - _startUs) / 1000);
+}
+void SystemClock::getTimeOfDay(struct timeval *tv)
+{
+    gettimeofday(tv, NULL);
+}
+
+SystemClock systemClock;
+Clock *currentClock = &systemClock;
+
+Clock *halClock()
+{
+    return currentClock;
+}
+void halSetClock(Clock *clock)
+{
+    currentClock = clock;
+}
+uint32_t millis()
+{
+    return currentClock->millis();
+}
+
+// http transfer -------------------------------------------------------------------------------
+// split http://host[:port]/path, returns false for unsupported urls
+static bool splitUrl(const char *url, char *host, size_t hostSize, char *port, size_t portSize, const char **path)
+{
+    const char *prefix = "http://";
+    if (strncmp(url, prefix, strlen(prefix)) != 0)
+    {
+        return false;
+    }
+    const char *begin = url + strlen(prefix);
+    const char *end = strchr(begin, '/');
+    *path = end ? end : "/";
+    size_t len = end ? (size_t)(end - begin) : strlen(begin);
+    const char *colon = (const char *)memchr(begin, ':', len);
+    size_t hostLen = colon ? (size_t)(colon - begin) : len;
+    if (hostLen == 0 || hostLen >= hostSize)
+    {
+        return false;
+    }
+    memcpy(host, begin, hostLen);
+    host[hostLen] = '\0';
+    snprintf(port, portSize, "%.*s", colon ? (int)(len - hostLen - 1) : 2, colon ? colon + 1 : "80");
+    return true;
+}
+
+SocketHttpTransport::~SocketHttpTransport()
+{
+    close();
+}
+
+void SocketHttpTransport::setKeepAlive(bool keepAlive)
+{
+    _keepAlive = keepAlive;
+    if (!keepAlive)
+    {
+        disconnect();
+    }
+}
+
+void SocketHttpTransport::setResolveOnce(bool resolveOnce)
+{
+    _resolveOnce = resolveOnce;
+}
+
+void SocketHttpTransport::close()
+{
+    disconnect();
+    _addressLen = 0;
+}
+
+void SocketHttpTransport::disconnect()
+{
+    if (_fd >= 0)
+    {
+        ::close(_fd);
+        _fd = -1;
+    }
+    _begin = _end = 0;
+}
+
+bool SocketHttpTransport::connectServer()
+{
+    if (_addressLen == 0 || !_resolveOnce)
+    {
+        struct addrinfo hints;
+        struct addrinfo *addr = NULL;
+        memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        stats.resolves++;
+        if (getaddrinfo(_host, _port, &hints, &addr) != 0 || addr == NULL)
+        {
+            return false;
+        }
+        memcpy(&_address, addr->ai_addr, addr->ai_addrlen);
+        _addressLen = addr->ai_addrlen;
+        freeaddrinfo(addr);
+    }
+    _fd = socket(_address.ss_family, SOCK_STREAM, 0);
+    if (_fd < 0 || connect(_fd, (struct sockaddr *)&_address, _addressLen) != 0)
+    {
+        close();
+        return false;
+    }
+    int on = 1;
+    setsockopt(_fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));     // header and body are sent separately
+    return true;
+}
+
+// receive more bytes of the response, false if the connection was closed
+bool SocketHttpTransport::fill()
+{
+    if (_begin > 0)
+    {
+        memmove(_buffer, _buffer + _begin, _end - _begin);
+        _end -= _begin;
+        _begin = 0;
+    }
+    if (_end >= sizeof(_buffer))
+    {
+        return false;                   // line too long
+    }
+    ssize_t n = recv(_fd, _buffer + _end, sizeof(_buffer) - _end, 0);
+    if (n <= 0)
+    {
+        return false;
+    }
+    _end += n;
+    return true;
+}
+
+// status code of the response; the body is skipped so that the connection can be used for the next request
+int SocketHttpTransport::readResponse(bool *keepAlive)
+{
+    // next line without CRLF, valid until the next call
+    auto readLine = [this]() -> char *
+    {
+        while (true)
+        {
+            char *eol = (char *)memmem(_buffer + _begin, _end - _begin, "\r\n", 2);
+            if (eol != NULL)
+            {
+                *eol = '\0';
+                char *line = _buffer + _begin;
+                _begin = eol + 2 - _buffer;
+                return line;
+            }
+            if (!fill())
+            {
+                return NULL;
+            }
+        }
+    };
+    auto skip = [this](size_t len) -> bool
+    {
+        while (len > 0)
+        {
+            if (_begin == _end && !fill())
+            {
+                return false;
+            }
+            size_t n = (_end - _begin < len) ? _end - _begin : len;
+            _begin += n;
+            len -= n;
+        }
+        return true;
+    };
+
+    // status line "HTTP/1.1 200 OK"
+    char *line = readLine();
+    int major;
+    int minor;
+    int code;
+    if (line == NULL || sscanf(line, "HTTP/%d.%d %d", &major, &minor, &code) != 3)
+    {
+        return -1;
+    }
+    bool close = (major == 1 && minor == 0);
+    long contentLength = -1;
+    bool chunked = false;
+    while ((line = readLine()) != NULL && *line != '\0')
+    {
+        if (!strncasecmp(line, "Content-Length:", 15))
+        {
+            contentLength = atol(line + 15);
+        }
+        else if (!strncasecmp(line, "Transfer-Encoding:", 18) && strcasestr(line + 18, "chunked"))
+        {
+            chunked = true;
+        }
+        else if (!strncasecmp(line, "Connection:", 11))
+        {
+            close = (strcasestr(line + 11, "close") != NULL);
+        }
+    }
+    if (line == NULL)
+    {
+        return -1;
+    }
+
+    // body
+    if (chunked)
+    {
+        size_t size;
+        do
+        {
+            if ((line = readLine()) == NULL)
+            {
+                return -1;
+            }
+            size = strtoul(line, NULL, 16);
+            if (size > 0 && !skip(size + 2))
+            {
+                return -1;
+            }
+        } while (size > 0);
+        while ((line = readLine()) != NULL && *line != '\0')
+        {
+            // trailer
+        }
+        if (line == NULL)
+        {
+            return -1;
+        }
+    }
+    else if (contentLength >= 0)
+    {
+        if (!skip(contentLength))
+        {
+            return -1;
+        }
+    }
+    else if (code >= 200 && code != 204 && code != 304)
+    {
+        while (fill())
+        {
+            _begin = _end;              // body up to the end of the connection
+        }
+        close = true;
+    }
+    *keepAlive = !close;
+    return code;
+}
+
+int SocketHttpTransport::send(const char *path, const char *contentType, const char *body)
+{
+    if (_fd < 0 && !connectServer())
+    {
+        return -1;
+    }
+    char header[512];
+    int headerLen = snprintf(header, sizeof(header),
+                             "POST %s HTTP/1.1\r\nHost: %s\r\nConnection: %s\r\n"
+                             "Content-Type: %s\r\nContent-Length: %u\r\n\r\n",
+                             path, _host, _keepAlive ? "keep-alive" : "close", contentType, (unsigned)strlen(body));
+    if (::send(_fd, header, headerLen, MSG_NOSIGNAL) != headerLen ||
+        ::send(_fd, body, strlen(body), MSG_NOSIGNAL) != (ssize_t)strlen(body))
+    {
+        disconnect();
+        return -1;
+    }
+    bool keepAlive = false;
+    int code = readResponse(&keepAlive);
+    if (code < 0 || !keepAlive || !_keepAlive)
+    {
+        disconnect();
+    }
+    return code;
+}
+
+int SocketHttpTransport::post(const char *url, const char *contentType, const char *body)
+{
+    stats.posts++;
+    char host[sizeof(_host)];
+    char port[sizeof(_port)];
+    const char *path;
+    if (!splitUrl(url, host, sizeof(host), port, sizeof(port), &path))
+    {
+        stats.failures++;
+        return -1;
+    }
+    if (strcmp(host, _host) != 0 || strcmp(port, _port) != 0)
+    {
+        close();                        // other server
+        snprintf(_host, sizeof(_host), "%s", host);
+        snprintf(_port, sizeof(_port), "%s", port);
+    }
+
+    bool reused = (_fd >= 0);
+    int code = send(path, contentType, body);
+    if (code < 0 && reused)
+    {
+        // the server closed the kept connection in the meantime
+        stats.retries++;
+        reused = false;
+        code = send(path, contentType, body);
+    }
+    if (!reused)
+    {
+        stats.connects++;
+    }
+    if (code < 0)
+    {
+        stats.failures++;
+        close();
+    }
+    return code;
+}
+
+// non-blocking tcp ------------------------------------------------------------------------------
+SocketTcpConnection::~SocketTcpConnection()
+{
+    close();
+}
+
+bool SocketTcpConnection::connect(const char *host, uint16_t port)
+{
+    close();
+    if (_addressLen == 0 || strcmp(host, _host) != 0 || port != _port)
+    {
+        // the name is resolved synchronously, on the host this is fast enough
+        struct addrinfo hints;
+        struct addrinfo *addr = NULL;
+        char service[8];
+        memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        snprintf(service, sizeof(service), "%u", port);
+        _addressLen = 0;
+        if (getaddrinfo(host, service, &hints, &addr) != 0 || addr == NULL)
+        {
+            return false;
+        }
+        memcpy(&_address, addr->ai_addr, addr->ai_addrlen);
+        _addressLen = addr->ai_addrlen;
+        freeaddrinfo(addr);
+        snprintf(_host, sizeof(_host), "%s", host);
+        _port = port;
+    }
+    _fd = socket(_address.ss_family, SOCK_STREAM, 0);
+    if (_fd < 0)
+    {
+        return false;
+    }
+    fcntl(_fd, F_SETFL, fcntl(_fd, F_GETFL) | O_NONBLOCK);
+    int on = 1;
+    setsockopt(_fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    if (::connect(_fd, (struct sockaddr *)&_address, _addressLen) == 0)
+    {
+        _state = TCP_CONNECTED;
+        return true;
+    }
+    if (errno != EINPROGRESS)
+    {
+        close();
+        return false;
+    }
+    _state = TCP_CONNECTING;
+    return true;
+}
+
+TcpState SocketTcpConnection::state()
+{
+    if (_state == TCP_CONNECTING)
+    {
+        struct pollfd fd = {_fd, POLLOUT, 0};
+        if (poll(&fd, 1, 0) > 0)
+        {
+            int error = 0;
+            socklen_t len = sizeof(error);
+            getsockopt(_fd, SOL_SOCKET, SO_ERROR, &error, &len);
+            if (error == 0)
+            {
+                _state = TCP_CONNECTED;
+            }
+            else
+            {
+                close();
+            }
+        }
+    }
+    return _state;
+}
+
+size_t SocketTcpConnection::write(const char *data, size_t len)
+{
+    if (state() != TCP_CONNECTED)
+    {
+        return 0;
+    }
+    ssize_t n = ::send(_fd, data, len, MSG_NOSIGNAL | MSG_DONTWAIT);
+    if (n < 0)
+    {
+        if (errno != EAGAIN && errno != EWOULDBLOCK)
+        {
+            close();
+        }
+        return 0;
+    }
+    return n;
+}
+
+size_t SocketTcpConnection::read(char *buffer, size_t size)
+{
+    if (state() != TCP_CONNECTED)
+    {
+        return 0;
+    }
+    ssize_t n = recv(_fd, buffer, size, MSG_DONTWAIT);
+    if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK))
+    {
+        close();                        // closed by the server
+        return 0;
+    }
+    return (n > 0) ? n : 0;
+}
+
+void SocketTcpConnection::close()
+{
+    if (_fd >= 0)
+    {
+        ::close(_fd);
+        _fd = -1;
+    }
+    _state = TCP_CLOSED;
+}
+
+// segment storage ------------------------------------------------------------------------------
+DirectorySegmentStorage::DirectorySegmentStorage(const char *directory)
+{
+    snprintf(_directory, sizeof(_directory), "%s", directory);
+}
+
+void DirectorySegmentStorage::path(uint32_t segment, char *name, size_t size)
+{
+    snprintf(name, size, "%s/%08x.seg", _directory, segment);
+}
+
+bool DirectorySegmentStorage::begin()
+{
+    return mkdir(_directory, 0755) == 0 || errno == EEXIST;
+}
+
+bool DirectorySegmentStorage::range(uint32_t *first, uint32_t *last)
+{
+    DIR *dir = opendir(_directory);
+    if (dir == NULL)
+    {
+        return false;
+    }
+    bool found = false;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL)
+    {
+        char *end;
+        uint32_t segment = strtoul(entry->d_name, &end, 16);
+        if (end == entry->d_name || strcmp(end, ".seg") != 0)
+        {
+            continue;
+        }
+        if (!found || segment < *first)
+        {
+            *first = segment;
+        }
+        if (!found || segment > *last)
+        {
+            *last = segment;
+        }
+        found = true;
+    }
+    closedir(dir);
+    return found;
+}
+
+bool DirectorySegmentStorage::append(uint32_t segment, const void *data, size_t len)
+{
+    char name[sizeof(_directory) + 16];
+    path(segment, name, sizeof(name));
+    FILE *file = fopen(name, "ab");
+    if (file == NULL)
+    {
+        return false;
+    }
+    bool ok = (fwrite(data, 1, len, file) == len);
+    return (fclose(file) == 0) && ok;
+}
+
+size_t DirectorySegmentStorage::read(uint32_t segment, size_t offset, void *data, size_t len)
+{
+    char name[sizeof(_directory) + 16];
+    path(segment, name, sizeof(name));
+    FILE *file = fopen(name, "rb");
+    if (file == NULL)
+    {
+        return 0;
+    }
+    size_t n = (fseek(file, offset, SEEK_SET) == 0) ? fread(data, 1, len, file) : 0;
+    fclose(file);
+    return n;
+}
+
+size_t DirectorySegmentStorage::size(uint32_t segment)
+{
+    char name[sizeof(_directory) + 16];
+    path(segment, name, sizeof(name));
+    struct stat info;
+    return (stat(name, &info) == 0) ? info.st_size : 0;
+}
+
+void DirectorySegmentStorage::remove(uint32_t segment)
+{
+    char name[sizeof(_directory) + 16];
+    path(segment, name, sizeof(name));
+    unlink(name);
+}
+
+bool DirectorySegmentStorage::writeState(const void *data, size_t len)
+{
+    char name[sizeof(_directory) + 16];
+    snprintf(name, sizeof(name), "%s/cursor", _directory);
+    FILE *file = fopen(name, "wb");
+    if (file == NULL)
+    {
+        return false;
+    }
+    bool ok = (fwrite(data, 1, len, file) == len);
+    return (fclose(file) == 0) && ok;
+}
+
+bool DirectorySegmentStorage::readState(void *data, size_t len)
+{
+    char name[sizeof(_directory) + 16];
+    snprintf(name, sizeof(name), "%s/cursor", _directory);
+    FILE *file = fopen(name, "rb");
+    if (file == NULL)
+    {
+        return false;
+    }
+    bool ok = (fread(data, 1, len, file) == len);
+    fclose(file);
+    return ok;
+}
+
+int LogHttpTransport::post(const char *url, const char *contentType, const char *body)
+{
+    stats.posts++;
+    if (_verbose)
+    {
+        printf("POST %s [%s] %s\n", url, contentType, body);
+    }
+    return 200;
+}
+
+SocketHttpTransport socketHttpTransport;
+
+HttpTransport *halHttpTransport()
+{
+    return &socketHttpTransport;
+}
+
+SocketTcpConnection socketTcpConnection;
+
+TcpConnection *halTcpConnection()
+{
+    return &socketTcpConnection;
+}
+
+DirectorySegmentStorage directorySegmentStorage("vzlog");
+
+SegmentStorage *halSegmentStorage()
+{
+    return &directorySegmentStorage;
+}
+
+// dash board ----------------------------------------------------------------------------------
+void StdoutDashSink::status(const char *text)
+{
+    printf("status: %s\n", text);
+}
+void StdoutDashSink::sensorState(int state)
+{
+    (void)state;                // the state trace is printed by process_message already
+}
+void StdoutDashSink::values(uint8_t meter, const char *timeStamp, int64_t powerIn, int64_t energyIn, int64_t energyOut)
+{
+    char power[24];
+    char in[24];
+    char out[24];
+    smlDecimalFormat(power, sizeof(power), powerIn, -SML_VALUE_DECIMALS, 1);
+    smlDecimalFormat(in, sizeof(in), energyIn, -SML_VALUE_DECIMALS, 1);
+    smlDecimalFormat(out, sizeof(out), energyOut, -SML_VALUE_DECIMALS, 1);
+    printf("dash: meter%u ts=%sms P=%sW E_in=%sWh E_out=%sWh\n", meter + 1, timeStamp, power, in, out);
+}
+
+#endif  // ARDUINO
@@ -0,0 +1,129 @@
+#ifndef HAL_NATIVE_H
+#define HAL_NATIVE_H
+#ifndef ARDUINO
+
+#include <stdio.h>
+#include <sys/socket.h>
+#include "hal.h"
+
+// read the bytes of a reading head from a file (or stdin), e.g. a raw capture of a meter
+class FileByteSource : public ByteSource
+{
+public:
+    FileByteSource(FILE *file);
+    int available() override;
+    int read() override;
+    size_t readBytes(byte *buffer, size_t len) override;
+    bool eof() { return _eof; }
+
+private:
+    FILE *_file;
+    int _next = -1;
+    bool _eof = false;
+};
+
+// host system time
+class SystemClock : public Clock
+{
+public:
+    SystemClock();
+    uint32_t millis() override;
+    void getTimeOfDay(struct timeval *tv) override;
+
+private:
+    uint64_t _startUs;
+};
+
+// http POST via a plain POSIX socket, url format http://host[:port]/path;
+// HTTP/1.1 keep-alive: the connection and the resolved address are kept between posts
+class SocketHttpTransport : public HttpTransport
+{
+public:
+    ~SocketHttpTransport();
+    int post(const char *url, const char *contentType, const char *body) override;
+    void setKeepAlive(bool keepAlive) override;
+    void setResolveOnce(bool resolveOnce) override;
+    void close() override;
+
+private:
+    bool connectServer();
+    void disconnect();
+    int send(const char *path, const char *contentType, const char *body);
+    int readResponse(bool *keepAlive);
+    bool fill();
+
+    int _fd = -1;
+    bool _keepAlive = true;
+    bool _resolveOnce = true;
+    char _host[128] = "";
+    char _port[8] = "";
+    struct sockaddr_storage _address;
+    socklen_t _addressLen = 0;          // 0: not resolved
+    char _buffer[1024];                 // received bytes of the response
+    size_t _begin = 0;
+    size_t _end = 0;
+};
+
+// non-blocking TCP client over a POSIX socket for AsyncHttpTransport; the resolved address of the host is kept
+class SocketTcpConnection : public TcpConnection
+{
+public:
+    ~SocketTcpConnection();
+    bool connect(const char *host, uint16_t port) override;
+    TcpState state() override;
+    size_t write(const char *data, size_t len) override;
+    size_t read(char *buffer, size_t size) override;
+    void close() override;
+
+private:
+    int _fd = -1;
+    TcpState _state = TCP_CLOSED;
+    char _host[128] = "";
+    uint16_t _port = 0;
+    struct sockaddr_storage _address;
+    socklen_t _addressLen = 0;          // 0: not resolved
+};
+
+// segment files in a directory of the host, e.g. to replay a server outage with the backlog
+class DirectorySegmentStorage : public SegmentStorage
+{
+public:
+    DirectorySegmentStorage(const char *directory);
+    bool begin() override;
+    bool range(uint32_t *first, uint32_t *last) override;
+    bool append(uint32_t segment, const void *data, size_t len) override;
+    size_t read(uint32_t segment, size_t offset, void *data, size_t len) override;
+    size_t size(uint32_t segment) override;
+    void remove(uint32_t segment) override;
+    bool writeState(const void *data, size_t len) override;
+    bool readState(void *data, size_t len) override;
+
+private:
+    void path(uint32_t segment, char *name, size_t size);
+    char _directory[128];
+};
+
+// no network: write each request to stdout and answer with 200
+class LogHttpTransport : public HttpTransport
+{
+public:
+    LogHttpTransport(bool verbose = true) : _verbose(verbose) {}
+    int post(const char *url, const char *contentType, const char *body) override;
+
+private:
+    bool _verbose;
+};
+
+// dash board replacement: values are written to stdout
+class StdoutDashSink : public DashSink
+{
+public:
+    void status(const char *text) override;
+    void sensorState(int state) override;
+    void values(uint8_t meter, const char *timeStamp, int64_t powerIn, int64_t energyIn, int64_t energyOut) override;
+};
+
+uint64_t hostMicros();                  // monotonic time of the host in us
+
+#endif  // ARDUINO
+#endif  // HAL_NATIVE_H
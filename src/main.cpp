@@ -1,5 +1,20 @@
 /* *** main.cpp to receive SML data from a (electrical) meter and send it to the Volkszaehler middleware.
 
+2026-10-17 mh
+- hardware access via hal.h; parse and publish moved to smlProcessFrame() in smlPipeline.cpp
+- dash board updates via CardDashSink
+- ESP8266 only (#ifdef ARDUINO), the host build uses mainNative.cpp, the benchmark smlBench.cpp
+- channel table on the configuration page (ChannelParameter, group "VZ Channels"), config version 2.3.0
+- configSaved() only sets configChanged, my_http.init() runs in loop() between two telegrams
+- my_http.loop() sends the queued requests of the asynchronous http transport (VZ_HTTP_ASYNC)
+- my_backlog: batches the server did not take are stored in LittleFS (VZ_BACKLOG) and posted later
+- my_history: values of the last telegrams in RAM, /history returns a time range (JSON or binary, chunked)
+- channel table with publish policy: relative deadband, max interval, direction (config version 2.4.0)
+- dash board cards from the scaled integer values of SmlHttp (smlDecimalFormat(), no floating point)
+- several reading heads (SENSOR_CONFIGS) run by my_scheduler, power and energy cards per further meter
+- free heap, largest block and fragmentation after the setup of the sensors (frame buffers in SmlFramePool)
+- defaults for the RAM of the ESP8266: 12 channels, 300 history samples, 4 queued requests (config version 2.5.0)
+
 2023-02-19 mh
 - add missing update of date/time in loop
 
@@ -80,6 +95,8 @@ The program provides a Web Access Point at boot time via http://192.168.4.1 (or
 It offers a configuration page both for the Access Point and a local WLAN for SSID name and password.
 Additional customer parameters are supported.  
 Configuration is stored in EEPROM.  
+The Volkszaehler channels are configured in group "VZ Channels", one line per channel:
+"OBIS id, UUID[, factor[, min interval[, deadband[%][, max interval[, [derive] [dir|mean|min|max|power] [meter1..4]]]]]]" (see smlChannel.cpp), an empty line is an unused channel.  
 At initial boot, the defined default password *MY_WIFI_AP_DEFAULT_PASSWORD* is used for AP mode access.
 
 If no client connects before the timeout (configured to 30sec), the device will automatically continue in STA (station) mode and connect to a local WLAN if configured.
@@ -110,6 +127,7 @@ It is based on https://github.com/ayushsharma82/ESP-DASH, with only minor modifi
 ## Implementation
 Using classes  
 **Sensor:**      receive data and put it into a buffer  
+**SmlScheduler:** runs the sensors of several reading heads (meters) in turn  
 **SmlHttp:**     transfers data to Volkszaehler data base  
 **smlDebug:**    functions for output of sml messages to serial monitor [3]  
 
@@ -127,8 +145,9 @@ Used 3rd party libs:
 **TimeLib**             low level date/time functions  
 
 *** end description *** */
+#if defined(ARDUINO) && !defined(SML_BENCH)
 // c and cpp
-#include <list>
+#include <memory>
 #include <stdio.h>
 #include <string.h>
 #include <time.h>
@@ -149,12 +168,14 @@ Used 3rd party libs:
 #include "smlDebug.h"
 #include "Sensor.h"
 #include "smlHttp.h"
+#include "smlPipeline.h"
+#include "smlScheduler.h"
 
 // local function declaration
 
 
 // sensor stuff
-std::list<Sensor *> *sensors = new std::list<Sensor *>();
+SmlScheduler my_scheduler;              // reading heads of SENSOR_CONFIGS, Sensor::meter is the index
 // callback for sensor, main processing function
 void process_message(byte *buffer, size_t len, Sensor *sensor, State sensorState);
 
@@ -169,7 +190,9 @@ void startHtml(AsyncWebServerRequest *request);
 void onConfiguration(AsyncWebServerRequest *request);
 
 void onReset(AsyncWebServerRequest *request);
+void onHistory(AsyncWebServerRequest *request);
 boolean needReset = false;
+boolean configChanged = false;  // set by configSaved(), my_http takes the new channel table in loop()
 
 String currentHtmlPage ="";     // sub-headline for different modes
 String currentSSID = "unknown";
@@ -201,6 +224,8 @@ char      s_DateTime[NMAX_DATE_TIME] = "1960-01-01 00:00";
 // volkszaehler stuff
 SmlHttpConfig myHttpConfig;
 SmlHttp       my_http;
+SmlBacklog    my_backlog(halSegmentStorage());
+SmlHistory    my_history;
 
 // server and WiFi stuff
 // class for WiFi and webserver configuration page, connects to WiFi in AP or STA mode
@@ -218,12 +243,6 @@ TextParameter confVZserverParam = TextParameter("VZ Server", "vzServer", myHttpC
                                                    VZ_SERVER, nullptr, "vzServer");
 TextParameter confVZmiddlewareParam = TextParameter("VZ Middleware", "vzMiddleware", myHttpConfig.vzMiddleware, sizeof(myHttpConfig.vzMiddleware),
                                                    VZ_MIDDLEWARE, nullptr, "vzMiddleware");
-TextParameter confVZuuidPowInParam = TextParameter("UUID PowerIn", "UUID-PowerIn", &myHttpConfig.uuidValue[vzPOWER_IN][0], sizeOfUUID,
-                                                   VZ_UUID_POWER_IN, nullptr, "UUID-PowerIn");
-TextParameter confVZuuidEnInParam = TextParameter("UUID EnergyIn", "UUID-EnergyIn", &myHttpConfig.uuidValue[vzENERGY_IN][0], sizeOfUUID,
-                                                   VZ_UUID_ENERGY_IN, nullptr, "UUID-EnergyIn");
-TextParameter confVZuuidEnOutParam = TextParameter("UUID EnergyOut", "UUID-EnergyOut", &myHttpConfig.uuidValue[vzENERGY_OUT][0], sizeOfUUID,
-                                                   VZ_UUID_ENERGY_OUT, nullptr, "UUID-EnergyOut");
 TextParameter confVZuuidTestParam = TextParameter("UUID Test", "UUID-Test", &myHttpConfig.uuidValue[vzTEST][0], sizeOfUUID,
                                                    VZ_UUID_TEST, nullptr, "UUID-Test");
 TextParameter confVZuuidSmlHeartBeatParam = TextParameter("UUID SmlHeartBeat", "UUID-SmlHeartBeat", &myHttpConfig.uuidValue[vzSML_HEART_BEAT][0], sizeOfUUID,
@@ -232,6 +251,57 @@ NumberParameter confTimezoneParam = NumberParameter("TimezoneOffset[h]", "Timezo
                                                    TIMEZONE_DEFAULT, nullptr, "TimezoneOffset");
 ParameterGroup paramGroup = ParameterGroup("VZ Settings", "VZ-Settings");
 
+// one channel of the table as a line of text on the configuration page, stored as SmlChannelConfig in EEPROM
+class ChannelParameter : public TextParameter
+{
+public:
+  ChannelParameter() : TextParameter(_label, _id, _spec, sizeof(_spec), nullptr, "OBIS id, UUID, factor, min interval s, deadband[%], max interval s, [derive] dir|mean|min|max|power [meter1..4]") {}
+  void setChannel(uint8_t index, SmlChannelConfig *channel, const char *defaultSpec)
+  {
+    snprintf(_label, sizeof(_label), "Channel %d", index + 1);
+    snprintf(_id, sizeof(_id), "ch%d", index + 1);
+    _channel = channel;
+    defaultValue = defaultSpec;
+  }
+  void applyDefaultValue() override
+  {
+    TextParameter::applyDefaultValue();
+    smlChannelParse(_spec, _channel);
+  }
+
+protected:
+  int getStorageSize() override { return sizeof(SmlChannelConfig); }
+  void storeValue(std::function<void(SerializationData* serializationData)> doStore) override
+  {
+    if (!smlChannelParse(_spec, _channel))
+    {
+      DEBUG("%s: invalid channel '%s', not used", _label, _spec);
+    }
+    SerializationData serializationData;
+    serializationData.length = sizeof(SmlChannelConfig);
+    serializationData.data = (byte*)_channel;
+    doStore(&serializationData);
+  }
+  void loadValue(std::function<void(SerializationData* serializationData)> doLoad) override
+  {
+    SerializationData serializationData;
+    serializationData.length = sizeof(SmlChannelConfig);
+    serializationData.data = (byte*)_channel;
+    doLoad(&serializationData);
+    _channel->uuid[sizeof(_channel->uuid) - 1] = '\0';
+    smlChannelFormat(*_channel, _spec, sizeof(_spec));
+  }
+
+private:
+  char _label[12];
+  char _id[6];
+  char _spec[SML_CHANNEL_SPEC_LEN] = "";
+  SmlChannelConfig *_channel;
+};
+const char *channelDefaults[] = SML_CHANNEL_DEFAULTS;
+ChannelParameter confChannelParam[SML_CHANNELS_MAX];
+ParameterGroup channelGroup = ParameterGroup("VZ Channels", "VZ-Channels");
+
 Parameter* thingName;                   // name set on configuration page, might override WIFI_AP_SSID
 char wifiAPssid[IOTWEBCONF_WORD_LEN] = WIFI_AP_SSID;
 
@@ -247,14 +317,57 @@ Card card_TimeStamp(&dashboard, GENERIC_CARD, "Time Stamp (ms)");
 Card card_EpochTime(&dashboard, GENERIC_CARD, "Epoch Time (s)");
 Card card_status(&dashboard, STATUS_CARD, "Loop Status", "empty");
 Card card_SensorStatus(&dashboard, STATUS_CARD, "Sensor Status", "empty");
+// further meters: power and energy in, created in setup()
+Card *card_meterPower[SML_METERS_MAX] = {};
+Card *card_meterEnergy[SML_METERS_MAX] = {};
+char meterCardName[SML_METERS_MAX][2][48];
 
 String s_loopCount;
 char myStringBuf[80]; // emulate string conversion for uint64_t because old framework needs to be used.
 
-double energyIn=0.0;
-double energyOut=0.0;
 double vzTestValue=0.0;
-float powerIn=0.0;
+
+// dash board output of smlProcessFrame()
+class CardDashSink : public DashSink
+{
+public:
+  void status(const char *text) override
+  {
+    card_status.update(text);
+    dashboard.sendUpdates();
+  }
+  void sensorState(int state) override
+  {
+    card_SensorStatus.update(state);
+    dashboard.sendUpdates();
+  }
+  void values(uint8_t meter, const char *timeStamp, int64_t powerIn, int64_t energyIn, int64_t energyOut) override
+  {
+    // scaled integers, no floating point: W with 1 decimal, Wh -> kWh with 5 decimals
+    if (meter > 0)
+    {
+      if (card_meterPower[meter] != NULL)
+      {
+        smlDecimalFormat(myStringBuf, sizeof(myStringBuf), powerIn, -SML_VALUE_DECIMALS, 1);
+        card_meterPower[meter]->update(myStringBuf);
+        smlDecimalFormat(myStringBuf, sizeof(myStringBuf), energyIn, -SML_VALUE_DECIMALS - 3, 5);
+        card_meterEnergy[meter]->update(myStringBuf);
+        dashboard.sendUpdates();
+      }
+      return;
+    }
+    smlDecimalFormat(myStringBuf, sizeof(myStringBuf), powerIn, -SML_VALUE_DECIMALS, 1);
+    card_power.update(myStringBuf);
+    smlDecimalFormat(myStringBuf, sizeof(myStringBuf), energyIn, -SML_VALUE_DECIMALS - 3, 5);
+    card_energy.update(myStringBuf);
+    smlDecimalFormat(myStringBuf, sizeof(myStringBuf), energyOut, -SML_VALUE_DECIMALS - 3, 5);
+    card_energy2.update(myStringBuf);
+    s_timeStamp = timeStamp;
+    card_TimeStamp.update(s_timeStamp);
+    dashboard.sendUpdates();
+  }
+};
+CardDashSink cardDash;
 
 //----------------------------------------------------------------------------------------------------
 
@@ -282,17 +395,22 @@ void setup()
   server.on("/start", handleRoot);
   server.on("/config", onConfiguration);
   server.on("/reset", onReset);
+  server.on("/history", HTTP_GET, onHistory);
 
   // own config parameter group
   paramGroup.addItem(&confVZserverParam);
   paramGroup.addItem(&confVZmiddlewareParam);
-  paramGroup.addItem(&confVZuuidPowInParam);
-  paramGroup.addItem(&confVZuuidEnInParam);
-  paramGroup.addItem(&confVZuuidEnOutParam);
   paramGroup.addItem(&confVZuuidSmlHeartBeatParam);
   paramGroup.addItem(&confVZuuidTestParam);
   paramGroup.addItem(&confTimezoneParam);
   confWeb.addParameterGroup(&paramGroup);
+  for (uint8_t i = 0; i < SML_CHANNELS_MAX; i++)
+  {
+    confChannelParam[i].setChannel(i, &myHttpConfig.channel[i],
+                                   (i < sizeof(channelDefaults) / sizeof(channelDefaults[0])) ? channelDefaults[i] : "");
+    channelGroup.addItem(&confChannelParam[i]);
+  }
+  confWeb.addParameterGroup(&channelGroup);
 
   // handler for web configuration
   confWeb.setConfigSavedCallback(&configSaved);
@@ -320,6 +438,11 @@ void setup()
       
       my_http.init(myHttpConfig);
 	  }
+  if (VZ_BACKLOG && my_backlog.begin())
+  {
+    my_http.setBacklog(&my_backlog);
+  }
+  my_http.setHistory(&my_history);
 
   card_Title.update(wifiAPssid);
   card_status.update("Starting");
@@ -357,10 +480,18 @@ void setup()
     const SensorConfig *config = SENSOR_CONFIGS;
     for (uint8_t i = 0; i < NUM_OF_SENSORS; i++, config++)
     {
-      Sensor *sensor = new Sensor(config, process_message);
-      sensors->push_back(sensor);
+      my_scheduler.add(new Sensor(config, process_message));
+      if (i > 0)
+      {
+        snprintf(meterCardName[i][0], sizeof(meterCardName[i][0]), "Power In (W) %s", config->name);
+        snprintf(meterCardName[i][1], sizeof(meterCardName[i][1]), "Energy In (kWh) %s", config->name);
+        card_meterPower[i] = new Card(&dashboard, GENERIC_CARD, meterCardName[i][0]);
+        card_meterEnergy[i] = new Card(&dashboard, GENERIC_CARD, meterCardName[i][1]);
+      }
     }
-    DEBUG("Sensor setup done.");
+    my_http.setScheduler(&my_scheduler);
+    DEBUG("Sensor setup done, heap %u bytes free, largest block %u bytes, fragmentation %u %%.", ESP.getFreeHeap(),
+          ESP.getMaxFreeBlockSize(), ESP.getHeapFragmentation());
   }
 
   // start in AP mode
@@ -386,7 +517,14 @@ void loop()
     needReset = false;
        // post to volkszaehler
     s_epochtime = String(getEpochTime());
-    my_http.postHttp(String(confVZuuidSmlHeartBeatParam.valueBuffer), s_epochtime, HEART_BEAT_RESET);
+    my_http.postHttp(confVZuuidSmlHeartBeatParam.valueBuffer, s_epochtime.c_str(), HEART_BEAT_RESET);
+    uint32_t resetTime = millis();
+    while (my_http.busy() && (millis() - resetTime) < 1000)    // send the queued requests
+    {
+      my_http.loop();
+      delay(10);
+    }
+    my_backlog.flush();               // records buffered in RAM
 
 		delay(1000);
 		ESP.restart();
@@ -394,6 +532,12 @@ void loop()
 
   confWeb.doLoop();
 
+  if (configChanged)    // not in the web server callback: it may run while a telegram is published
+  {
+    configChanged = false;
+    my_http.init(myHttpConfig);
+  }
+
   // need to wait until WiFi connection is established.
   if(b_WiFi_connected)
   {
@@ -416,7 +560,7 @@ void loop()
             waitForTime++;
         }
 
-        my_http.postHttp(String(confVZuuidSmlHeartBeatParam.valueBuffer), s_epochtime, HEART_BEAT_WIFI_CONFIG);
+        my_http.postHttp(confVZuuidSmlHeartBeatParam.valueBuffer, s_epochtime.c_str(), HEART_BEAT_WIFI_CONFIG);
         if(epochtime > 1672531200ULL)     // now we have a valid time
         {
           // here, we should have connection to ntp server and valid time
@@ -444,13 +588,11 @@ void loop()
       }
       else
       {
-        // Execute sensor state machines
-        for (std::list<Sensor*>::iterator it = sensors->begin(); it != sensors->end(); ++it)
-        {
-          (*it)->loop();
-        }
+        // Execute sensor state machines, the input of all reading heads is pumped after each step
+        my_scheduler.loop();
       }
     }
+    my_http.loop();     // asynchronous http: send the queued requests without waiting for the server
   }
 	yield();
 
@@ -481,7 +623,7 @@ void loop()
       // heart beat post to volkszaehler
       if ((count10000 != HEART_BEAT_RESET) && (count10000 != HEART_BEAT_WIFI_CONFIG))
       {
-        my_http.postHttp(String(confVZuuidSmlHeartBeatParam.valueBuffer), s_epochtime, count10000); // count10000 should fit into a float
+        my_http.postHttp(confVZuuidSmlHeartBeatParam.valueBuffer, s_epochtime.c_str(), count10000); // count10000 should fit into a float
       }
     }
 
@@ -508,6 +650,9 @@ void loop()
 // call back function for libSML
 // process_message is a wrapper around the parse and publish method of class Sensor
 //
+// 2026-10-17 mh
+// - parse and publish moved to smlProcessFrame()
+//
 // 2022-12-07 mh
 // - sensor state to support update of dash board
 //
@@ -520,52 +665,9 @@ void process_message(byte *buffer, size_t len, Sensor *sensor, State sensorState
 
   if( sensorState == PROCESS_MESSAGE)
   {
-    // Parse
-    sml_file *file = sml_file_parse(buffer + 8, len - 16);
-
-    if(VERBOSE_LEVEL_MeterProtocol) 
-    {
-      DEBUG_SML_FILE(file);     // output of received messages
-    }
-    my_http.publish(sensor, file);
-
-    // free the malloc'd memory
-    sml_file_free(file);
-
-    // update dashboard
-    s_timeStamp = my_http.getTimeStamp();
-    powerIn = my_http.getValue(vzPOWER_IN);
-    energyIn = my_http.getValue(vzENERGY_IN);
-    energyOut = my_http.getValue(vzENERGY_OUT);
-
-    card_status.update("data published");
-    card_power.update(powerIn);
-    sprintf(myStringBuf,"%.5f",energyIn/1000.);
-    card_energy.update(myStringBuf);
-    sprintf(myStringBuf,"%.5f",energyOut/1000.);
-    card_energy2.update(myStringBuf);
-    card_TimeStamp.update(s_timeStamp);
-    dashboard.sendUpdates();
-
-    if (VERBOSE_LEVEL_MeterData)
-    {
-      Serial.print("ts=");
-      Serial.print(s_timeStamp);
-      Serial.print("ms, ");
-      Serial.print("P=");
-      Serial.print(powerIn);
-      Serial.print("W, ");
-      Serial.print("E_in=");
-      Serial.print(energyIn);
-      Serial.print("Wh, ");
-      Serial.print("E_out=");
-      Serial.print(energyOut);
-      Serial.println("Wh");
-      Serial.flush();
-    }
+    smlProcessFrame(buffer, len, sensor, my_http, &cardDash);
   }
-  card_SensorStatus.update(sensorState);
-  dashboard.sendUpdates();
+  cardDash.sensorState(sensorState);
       Serial.print("** Sensor State: ");
       Serial.println(sensorState);
 
@@ -579,6 +681,9 @@ void configSaved()
 //
 // configSaved() callback handler for confWeb, when configuration was saved.
 //
+// 2026-10-17 mh
+// - my_http.init() deferred to loop()
+//
 // 2023-01-12	mh
 // - first version
 //
@@ -586,6 +691,7 @@ void configSaved()
 // Licensed under the GNU General Public License v3.0
 {
 	DEBUG("Configuration was updated.");
+  configChanged = true;               // channel table may have changed, my_http.init() by loop()
 	//needReset = true;   // mh: erstmal kein reset 
 }
 // ##########################################################################################
@@ -621,6 +727,41 @@ void onReset(AsyncWebServerRequest *request)
   request->send(200, "text/html; charset=UTF-8", "Rebooting after 1 sec.");
 }
 // ##########################################################################################
+// request handler for /history
+void onHistory(AsyncWebServerRequest *request)
+//
+// onHistory() returns the samples of my_history in a time range, chunked
+// /history?from=<ms>&to=<ms>&format=json|bin or /history?last=<s>
+//
+// 2026-10-17	mh
+// - first version
+//
+// (C) M. Herbert, 2026.
+// Licensed under the GNU General Public License v3.0
+{
+  uint64_t fromMs = 0;
+  uint64_t toMs = UINT64_MAX;
+  if (request->hasParam("last"))
+  {
+    uint64_t lastMs = strtoull(request->getParam("last")->value().c_str(), NULL, 10) * 1000;
+    fromMs = (my_history.lastMs() > lastMs) ? my_history.lastMs() - lastMs : 0;
+  }
+  if (request->hasParam("from"))
+  {
+    fromMs = strtoull(request->getParam("from")->value().c_str(), NULL, 10);
+  }
+  if (request->hasParam("to"))
+  {
+    toMs = strtoull(request->getParam("to")->value().c_str(), NULL, 10);
+  }
+  bool binary = request->hasParam("format") && request->getParam("format")->value() == "bin";
+  std::shared_ptr<SmlHistory::Reader> reader = std::make_shared<SmlHistory::Reader>(
+      my_history, fromMs, toMs, binary ? SmlHistory::FORMAT_BINARY : SmlHistory::FORMAT_JSON);
+  AsyncWebServerResponse *response = request->beginChunkedResponse(binary ? "application/octet-stream" : "application/json",
+      [reader](uint8_t *buffer, size_t maxLen, size_t /*index*/) -> size_t { return reader->read(buffer, maxLen); });
+  request->send(response);
+}
+// ##########################################################################################
 // request handler for /start
 void startHtml(AsyncWebServerRequest *request)
 //
@@ -777,4 +918,5 @@ void getDateTime(char* s_DateTime)
   Hour = hour();
   Minute = minute();
   sprintf(s_DateTime,"%4d-%02d-%02d %02d:%02d",Year,Month,Day,Hour,Minute);
-}
\ No newline at end of file
+}
+#endif  // ARDUINO
@@ -0,0 +1,372 @@
+/* *** mainNative.cpp host (Linux) main program, PlatformIO env:native
+
+2026-10-17 mh
+- first version: raw meter bytes from a file or stdin -> Sensor -> smlProcessFrame() -> http transport
+- replay of captures (smlReplay) in real time, Nx or as fast as possible, frame rate summary
+- replay summary: framing and CRC errors
+- -c: channel table (smlChannel.cpp) instead of SML_CHANNEL_DEFAULTS
+- replay summary: posts and connections of the http transport
+- remaining batches posted at the end of the input, replay summary of tuples and batches
+- -a: asynchronous http transport (smlAsyncHttp.cpp), my_http.loop() after each sensor.loop()
+- -b: backlog of the batches the server did not take (smlBacklog.cpp) in a directory
+- replay summary: values sent and suppressed by the publish policy of the channels
+- -H: history (smlHistory.cpp) written at the end of the input as /history of the ESP8266 would send it
+- replay summary: steps and slews of the time base of the telegrams (smlTime.cpp)
+- several captures are replayed at the same time as several meters (SmlScheduler), replay summary per meter
+- replay summary: telegrams received, processed and dropped (frame buffers of Sensor)
+- replay summary: peak use and fragmentation of the frame pool (smlFramePool.cpp), largest telegram
+- replay summary: telegrams evaluated by the learned layout and parsed completely (smlLayout.cpp)
+- replay summary: parses of libsml in the parse arena (smlArena.cpp), if any
+- replay summary: telegrams decoded during the reception (smlStream.cpp), entries decoded before the end sequence
+
+(C) M. Herbert, 2026.
+Licensed under the GNU General Public License v3.0
+
+*** end change log *** */
+
+/* ***
+# SMLReaderVZ native #
+Runs the complete receive -> parse -> publish path of the firmware as a Linux process,
+e.g. to profile the pipeline without a meter.
+
+## Usage ##
+```bash
+.pio/build/native/program [-s server] [-m middleware] [-a] [-b backlog] [-H history.json] [-i interval] [-r speed] [-q] [-c channel ...] [capture.bin ...]
+```
+- capture.bin: raw bytes as sent by the meter, stdin if omitted; with -r several captures are replayed at the same
+  time as meter1, meter2 ... (channels with the word meter<n>, see smlChannel.cpp)
+- -r: replay the capture (see smlReplay.cpp for the format) with virtual time: 1 = real time (9600 Baud),
+  N = N times faster, 0 = as fast as possible. A summary with the frame rate is written to stderr.
+- -s: post to this Volkszaehler server, without -s requests are only written to stdout
+- -m: middleware name, default VZ_MIDDLEWARE
+- -a: post with the asynchronous transport as the ESP8266 with VZ_HTTP_ASYNC (with -s)
+- -b: store the tuples the server did not take in this directory and post them when it answers again
+  (as the ESP8266 with VZ_BACKLOG in LittleFS); the backlog is kept between the runs
+- -H: write the history of the last SML_HISTORY_SAMPLES telegrams to this file at the end, binary if the name ends
+  with .bin, JSON otherwise
+- -i: read out interval in sec as SensorConfig::interval, default 0 (a file is read much faster than 9600 Baud)
+- -q: quiet, do not print the http requests
+- -c: channel "OBIS id, UUID[, factor[, min interval[, deadband]]]" (see smlChannel.cpp), may be repeated;
+  replaces the channels of SML_CHANNEL_DEFAULTS
+
+*** end description *** */
+#if !defined(ARDUINO) && !defined(SML_BENCH)
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "config.h"
+#include "halNative.h"
+#include "Sensor.h"
+#include "smlArena.h"
+#include "smlAsyncHttp.h"
+#include "smlHttp.h"
+#include "smlPipeline.h"
+#include "smlReplay.h"
+#include "smlScheduler.h"
+#include "smlTime.h"
+
+SmlHttpConfig myHttpConfig;
+SmlHttp       my_http;
+StdoutDashSink stdoutDash;
+uint32_t framesProcessed = 0;
+
+// post the requests left in the queue of the asynchronous transport, at most 10 s
+static void drainHttp()
+{
+  uint64_t startUs = hostMicros();
+  while (my_http.busy() && (hostMicros() - startUs) < 10000000ULL)
+  {
+    my_http.loop();
+    usleep(100);
+  }
+}
+
+void process_message(byte *buffer, size_t len, Sensor *sensor, State sensorState)
+{
+  if (sensorState == PROCESS_MESSAGE)
+  {
+    framesProcessed++;
+    smlProcessFrame(buffer, len, sensor, my_http, &stdoutDash);
+  }
+  stdoutDash.sensorState(sensorState);
+}
+
+int main(int argc, char **argv)
+{
+  const char *serverName = NULL;
+  const char *middlewareName = VZ_MIDDLEWARE;
+  uint8_t interval = 0;
+  double speed = -1;              // < 0: no replay
+  bool quiet = false;
+  bool async = false;
+  const char *backlogDir = NULL;
+  const char *historyFile = NULL;
+  uint8_t channels = 0;
+  int opt;
+  while ((opt = getopt(argc, argv, "s:m:ab:H:i:r:qc:")) != -1)
+  {
+    switch (opt)
+    {
+    case 's':
+      serverName = optarg;
+      break;
+    case 'm':
+      middlewareName = optarg;
+      break;
+    case 'a':
+      async = true;
+      break;
+    case 'b':
+      backlogDir = optarg;
+      break;
+    case 'H':
+      historyFile = optarg;
+      break;
+    case 'i':
+      interval = (uint8_t)atoi(optarg);
+      break;
+    case 'r':
+      speed = atof(optarg);
+      break;
+    case 'q':
+      quiet = true;
+      break;
+    case 'c':
+      if (channels == 0)
+      {
+        for (uint8_t i = 0; i < SML_CHANNELS_MAX; i++)
+        {
+          smlChannelParse("", &myHttpConfig.channel[i]);
+        }
+      }
+      if (channels >= SML_CHANNELS_MAX || !smlChannelParse(optarg, &myHttpConfig.channel[channels]))
+      {
+        fprintf(stderr, "invalid channel: %s\n", optarg);
+        return 1;
+      }
+      channels++;
+      break;
+    default:
+      fprintf(stderr, "usage: %s [-s server] [-m middleware] [-a] [-b backlog] [-H history.json] [-i interval] [-r speed] [-q] [-c channel ...] [capture.bin ...]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  FILE *input = stdin;
+  if (optind < argc)
+  {
+    input = fopen(argv[optind], "rb");
+    if (input == NULL)
+    {
+      perror(argv[optind]);
+      return 1;
+    }
+  }
+
+  // channel UUIDs as defined in config.h (default of SmlHttpConfig) or by -c
+  if (serverName != NULL)
+  {
+    snprintf(myHttpConfig.vzServer, sizeof(myHttpConfig.vzServer), "%s", serverName);
+  }
+  snprintf(myHttpConfig.vzMiddleware, sizeof(myHttpConfig.vzMiddleware), "%s", middlewareName);
+  my_http.init(myHttpConfig);
+
+  LogHttpTransport logTransport(!quiet);
+  AsyncHttpTransport asyncTransport(halTcpConnection());
+  if (serverName == NULL)
+  {
+    my_http.setTransport(&logTransport);
+  }
+  else if (async)
+  {
+    my_http.setTransport(&asyncTransport);
+  }
+  DirectorySegmentStorage backlogStorage(backlogDir ? backlogDir : "");
+  SmlBacklog backlog(&backlogStorage);
+  if (backlogDir != NULL)
+  {
+    if (!backlog.begin())
+    {
+      fprintf(stderr, "%s: no backlog directory\n", backlogDir);
+      return 1;
+    }
+    my_http.setBacklog(&backlog);
+  }
+  SmlHistory *history = new SmlHistory();
+  my_http.setHistory(history);
+
+  SensorConfig config = {.pin = SENSOR_CONFIGS[0].pin,
+                         .name = SENSOR_CONFIGS[0].name,
+                         .numeric_only = SENSOR_CONFIGS[0].numeric_only,
+                         .interval = interval};
+  if (speed >= 0)
+  {
+    // one sensor per capture, all on the virtual time of one clock
+    uint8_t meters = (argc - optind > 1) ? (uint8_t)(argc - optind) : 1;
+    if (meters > SML_METERS_MAX)
+    {
+      fprintf(stderr, "at most %d captures\n", SML_METERS_MAX);
+      return 1;
+    }
+    SmlReplayClock clock(speed);
+    Clock *systemClock = halClock();
+    halSetClock(&clock);                // before the sensors: their read timeout starts on the replay clock
+    SmlScheduler scheduler;
+    SmlReplay *replay[SML_METERS_MAX];
+    SensorConfig *meterConfig[SML_METERS_MAX];
+    char names[SML_METERS_MAX][16];
+    for (uint8_t i = 0; i < meters; i++)
+    {
+      replay[i] = new SmlReplay(&clock);
+      if (!((i == 0) ? replay[i]->load(input) : replay[i]->load(argv[optind + i])))
+      {
+        fprintf(stderr, "no replay data\n");
+        return 1;
+      }
+      snprintf(names[i], sizeof(names[i]), "meter%u", i + 1);
+      meterConfig[i] = new SensorConfig{.pin = config.pin, .name = (meters > 1) ? names[i] : config.name,
+                                        .numeric_only = config.numeric_only, .interval = config.interval};
+      scheduler.add(new Sensor(meterConfig[i], replay[i], process_message));   // sensor owns the replay
+    }
+    my_http.setScheduler(&scheduler);
+    clock.rewind();
+    uint64_t startUs = hostMicros();
+    {
+      bool finished = false;
+      while (!finished || scheduler.pending())
+      {
+        scheduler.loop();
+        my_http.loop();
+        clock.step();                   // as fast as possible: to the next byte of the meters
+        finished = true;
+        for (uint8_t i = 0; i < meters; i++)
+        {
+          finished = finished && replay[i]->finished();
+        }
+      }
+      my_http.sendBatches(scheduler.sensor(0));
+      drainHttp();
+      uint64_t wallUs = hostMicros() - startUs;
+      size_t bytes = 0;
+      uint64_t durationUs = 0;
+      SensorStats total = {};
+      for (uint8_t i = 0; i < meters; i++)
+      {
+        bytes += replay[i]->size();
+        durationUs = (replay[i]->durationUs() > durationUs) ? replay[i]->durationUs() : durationUs;
+        total.framingErrors += scheduler.sensor(i)->stats.framingErrors;
+        total.crcErrors += scheduler.sensor(i)->stats.crcErrors;
+        total.framesReceived += scheduler.sensor(i)->stats.framesReceived;
+        total.framesProcessed += scheduler.sensor(i)->stats.framesProcessed;
+        total.framesDropped += scheduler.sensor(i)->stats.framesDropped;
+        total.framesDecoded += scheduler.sensor(i)->stats.framesDecoded;
+        total.framesDiscarded += scheduler.sensor(i)->stats.framesDiscarded;
+        total.entriesEarly += scheduler.sensor(i)->stats.entriesEarly;
+        if (scheduler.sensor(i)->stats.frameMax > total.frameMax)
+        {
+          total.frameMax = scheduler.sensor(i)->stats.frameMax;
+        }
+      }
+      fprintf(stderr, "replay: %zu bytes, %.3f s capture, %u frames in %.3f s = %.1f frames/s (%.1f x real time)\n",
+              bytes, durationUs / 1e6, framesProcessed, wallUs / 1e6,
+              wallUs ? framesProcessed * 1e6 / wallUs : 0., wallUs ? (double)durationUs / wallUs : 0.);
+      fprintf(stderr, "replay: %u framing errors, %u CRC errors\n", total.framingErrors, total.crcErrors);
+      fprintf(stderr, "replay: %u frames received, %u processed, %u dropped (no free frame buffer)\n",
+              total.framesReceived, total.framesProcessed, total.framesDropped);
+      fprintf(stderr, "replay: %u frames decoded during the reception (%u entries before the end sequence), "
+              "%u discarded (CRC error)\n", total.framesDecoded, total.entriesEarly, total.framesDiscarded);
+      const SmlFramePoolStats &pool = smlFramePool()->getStats();
+      fprintf(stderr, "replay: frame pool %u of %u bytes peak, fragmentation peak %u %%, %u grown, %u moved, "
+              "%u failures, largest telegram %u bytes\n", pool.peakBytes, SML_FRAME_POOL_SIZE,
+              pool.peakFragmentation, pool.grows, pool.moves, pool.failures, total.frameMax);
+      SmlLayoutStats layout = {};
+      for (uint8_t i = 0; i < meters; i++)
+      {
+        layout.hits += my_http.getLayoutStats(i).hits;
+        layout.misses += my_http.getLayoutStats(i).misses;
+        layout.learned += my_http.getLayoutStats(i).learned;
+      }
+      fprintf(stderr, "replay: layout cache %u telegrams by the learned offsets, %u parsed completely, "
+              "%u layouts learned\n", layout.hits, layout.misses, layout.learned);
+      const SmlArenaStats &arena = smlParseArena()->getStats();
+      if (arena.parses > 0)
+      {
+        fprintf(stderr, "replay: parse arena %u parses, %u allocations, %u on the heap (arena full), peak %u bytes\n",
+                arena.parses, arena.allocs, arena.spills, arena.peakBytes);
+      }
+      for (uint8_t i = 0; meters > 1 && i < meters; i++)
+      {
+        const SensorStats &stats = scheduler.sensor(i)->stats;
+        const SmlMeterStats &meter = my_http.getMeterStats(i);
+        fprintf(stderr, "replay: meter%u %u frames, %u framing errors, %u CRC errors, ring peak %u bytes, "
+                "%u tuples in %u batches\n", i + 1, meter.telegrams, stats.framingErrors, stats.crcErrors,
+                stats.ringPeak, meter.tuples, meter.batches);
+      }
+      const HttpStats &http = my_http.getHttpStats();
+      fprintf(stderr, "replay: %u posts, %u connections, %u retries, %u failures, %u dropped\n",
+              http.posts, http.connects, http.retries, http.failures, http.dropped);
+      const SmlBatchStats &batch = my_http.getBatchStats();
+      const SmlPublishStats &publish = my_http.getPublishStats();
+      fprintf(stderr, "replay: %u values sent, %u suppressed (%u interval, %u deadband), %u heartbeats, %u direction changes, "
+              "%u aggregated\n",
+              publish.sent, publish.suppressedInterval + publish.suppressedDeadband, publish.suppressedInterval,
+              publish.suppressedDeadband, publish.heartbeats, publish.directions, publish.aggregated);
+      fprintf(stderr, "replay: %u tuples in %u batches, %u dropped\n", batch.tuples, batch.batches, batch.dropped);
+      const SmlTimeStats &time = smlTimeBase()->getStats();
+      fprintf(stderr, "replay: time base %u steps, %u slews, last error %d ms\n", time.steps, time.slews, (int)time.error);
+      if (backlogDir != NULL)
+      {
+        const SmlBacklogStats &stored = backlog.getStats();
+        fprintf(stderr, "replay: backlog %u records stored, %u posted, %u dropped, %u pending\n",
+                stored.records, stored.drained, stored.dropped, backlog.pending());
+      }
+    }
+    halSetClock(systemClock);
+    my_http.setScheduler(NULL);
+    for (uint8_t i = 0; i < meters; i++)
+    {
+      delete scheduler.sensor(i);
+      delete meterConfig[i];
+    }
+  }
+  else
+  {
+    FileByteSource *source = new FileByteSource(input);
+    Sensor sensor(&config, source, process_message);
+    while (!source->eof() || sensor.pending())
+    {
+      sensor.loop();
+      my_http.loop();
+    }
+    my_http.sendBatches(&sensor);
+    drainHttp();
+  }
+
+  backlog.flush();
+  FILE *historyOutput = historyFile ? fopen(historyFile, "wb") : NULL;
+  if (historyOutput != NULL)
+  {
+    // in chunks as the web server requests them
+    size_t nameLen = strlen(historyFile);
+    bool binary = nameLen > 4 && !strcmp(historyFile + nameLen - 4, ".bin");
+    SmlHistory::Reader reader(*history, 0, UINT64_MAX, binary ? SmlHistory::FORMAT_BINARY : SmlHistory::FORMAT_JSON);
+    uint8_t chunk[256];
+    size_t len;
+    while ((len = reader.read(chunk, sizeof(chunk))) > 0)
+    {
+      fwrite(chunk, 1, len, historyOutput);
+    }
+    fclose(historyOutput);
+  }
+  else if (historyFile != NULL)
+  {
+    perror(historyFile);
+  }
+  if (input != stdin)
+  {
+    fclose(input);
+  }
+  return 0;
+}
+#endif  // ARDUINO
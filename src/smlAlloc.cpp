@@ -0,0 +1,174 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hal.h"
+#include "smlAlloc.h"
+#include "smlArena.h"
+#ifndef ARDUINO
+#include <malloc.h>
+#endif
+
+/* *** smlAlloc.cpp heap statistics for the benchmark
+
+2026-10-17 mh
+- first version: counting wrappers of malloc/calloc/realloc/free (linker option --wrap)
+- SML_PARSE_ARENA: the wrappers take the blocks of sml_file_parse() from the parse arena (smlArena.cpp)
+
+(C) M. Herbert, 2026.
+Licensed under the GNU General Public License v3.0
+
+*** end change log *** */
+
+SmlAllocCounters smlAllocStats;
+
+#ifdef ARDUINO
+static uint32_t startFreeHeap = 0;
+
+static inline void trackHeap()
+{
+    uint32_t freeHeap = ESP.getFreeHeap();
+    if (startFreeHeap == 0)
+    {
+        startFreeHeap = freeHeap;
+    }
+    if (freeHeap < startFreeHeap && (startFreeHeap - freeHeap) > smlAllocStats.peakBytes)
+    {
+        smlAllocStats.peakBytes = startFreeHeap - freeHeap;
+    }
+}
+void smlAllocResetPeak()
+{
+    startFreeHeap = ESP.getFreeHeap();
+    smlAllocStats.peakBytes = 0;
+}
+#else
+static inline void trackHeap()
+{
+    if (smlAllocStats.liveBytes > smlAllocStats.peakBytes)
+    {
+        smlAllocStats.peakBytes = smlAllocStats.liveBytes;
+    }
+}
+void smlAllocResetPeak()
+{
+    smlAllocStats.peakBytes = smlAllocStats.liveBytes;
+}
+#endif
+
+#if defined(SML_ALLOC_WRAP) || defined(SML_PARSE_ARENA)
+#ifdef ARDUINO
+    #define USABLE_SIZE(ptr) 0
+#else
+    #define USABLE_SIZE(ptr) malloc_usable_size(ptr)
+#endif
+
+// counters of the heap, with SML_ALLOC_WRAP only
+static inline void *counted(void *ptr, size_t oldSize)
+{
+#ifdef SML_ALLOC_WRAP
+    if (ptr != NULL)
+    {
+        smlAllocStats.mallocs++;
+        smlAllocStats.liveBytes += USABLE_SIZE(ptr) - oldSize;
+        trackHeap();
+    }
+#else
+    (void)oldSize;
+#endif
+    return ptr;
+}
+
+// block of the parse arena (smlArena.cpp) while it is active, otherwise NULL
+static inline void *arenaAlloc(size_t size)
+{
+#ifdef SML_PARSE_ARENA
+    SmlParseArena *arena = smlParseArena();
+    if (arena->active())
+    {
+        return arena->alloc(size);
+    }
+#else
+    (void)size;
+#endif
+    return NULL;
+}
+static inline bool arenaOwns(void *ptr)
+{
+#ifdef SML_PARSE_ARENA
+    return smlParseArena()->owns(ptr);
+#else
+    (void)ptr;
+    return false;
+#endif
+}
+
+extern "C"
+{
+    void *__real_malloc(size_t size);
+    void *__real_calloc(size_t n, size_t size);
+    void *__real_realloc(void *ptr, size_t size);
+    void __real_free(void *ptr);
+
+    void *__wrap_malloc(size_t size)
+    {
+        void *ptr = arenaAlloc(size);
+        return (ptr != NULL) ? ptr : counted(__real_malloc(size), 0);
+    }
+    void *__wrap_calloc(size_t n, size_t size)
+    {
+        void *ptr = (size == 0 || n <= SIZE_MAX / size) ? arenaAlloc(n * size) : NULL;
+        if (ptr != NULL)
+        {
+            memset(ptr, 0, n * size);
+            return ptr;
+        }
+        return counted(__real_calloc(n, size), 0);
+    }
+    void *__wrap_realloc(void *ptr, size_t size)
+    {
+#ifdef SML_PARSE_ARENA
+        SmlParseArena *arena = smlParseArena();
+        if (arena->owns(ptr))
+        {
+            // moved to a new block, the size of the old one is not known: at most up to the top of the arena
+            if (arena->active())
+            {
+                void *block = arena->realloc(ptr, size);
+                if (block != NULL)
+                {
+                    return block;
+                }
+            }
+            size_t available = arena->extent(ptr);
+            void *newPtr = counted(__real_malloc(size), 0);
+            if (newPtr != NULL)
+            {
+                memcpy(newPtr, ptr, (size < available) ? size : available);
+            }
+            return newPtr;
+        }
+        if (ptr == NULL)
+        {
+            return __wrap_malloc(size);
+        }
+#endif
+        size_t oldSize = (ptr != NULL) ? USABLE_SIZE(ptr) : 0;
+        return counted(__real_realloc(ptr, size), oldSize);
+    }
+    void __wrap_free(void *ptr)
+    {
+        if (arenaOwns(ptr))
+        {
+            return;                 // released with the arena
+        }
+#ifdef SML_ALLOC_WRAP
+        if (ptr != NULL)
+        {
+            smlAllocStats.frees++;
+            smlAllocStats.liveBytes -= USABLE_SIZE(ptr);
+        }
+#endif
+        __real_free(ptr);
+    }
+}
+#endif  // SML_ALLOC_WRAP || SML_PARSE_ARENA
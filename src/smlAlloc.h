@@ -0,0 +1,21 @@
+#ifndef SML_ALLOC_H
+#define SML_ALLOC_H
+
+#include <stdint.h>
+
+// Heap statistics of malloc/calloc/realloc/free.
+// Counting requires the linker to wrap the allocation functions, see alloc_wrap_flags in platformio.ini;
+// without it all counters stay 0.
+struct SmlAllocCounters
+{
+    uint32_t mallocs;           // successful malloc, calloc and realloc calls
+    uint32_t frees;
+    uint32_t liveBytes;         // currently allocated (host only, 0 on the ESP8266)
+    uint32_t peakBytes;         // max of liveBytes, on the ESP8266: max drop of free heap since smlAllocResetPeak()
+};
+
+extern SmlAllocCounters smlAllocStats;
+
+void smlAllocResetPeak();
+
+#endif // SML_ALLOC_H
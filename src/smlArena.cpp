@@ -0,0 +1,129 @@
+#include <string.h>
+#include "smlArena.h"
+
+/* *** smlArena.cpp tree of sml_file_parse() in a bump arena instead of the heap
+
+2026-10-17 mh
+- first version: allocations of libsml during sml_file_parse() from one block, reset by the next parse
+
+(C) M. Herbert, 2026.
+Licensed under the GNU General Public License v3.0
+
+*** end change log *** */
+
+/* ***
+# Description SmlParseArena #
+sml_file_parse() of libsml copies the message and builds a tree of about 10 small blocks per list entry,
+sml_file_free() releases them again; between them publish() and its http posts allocate as well. Over days this
+fragments the 40 KB heap of the ESP8266. With SML_PARSE_ARENA (arena_flags in platformio.ini) the allocations of
+libsml during smlFileParse() are taken from one block of SML_PARSE_ARENA_SIZE bytes instead:
+- malloc, calloc and realloc are wrapped by the linker (--wrap, smlAlloc.cpp); while the arena is active they return
+  the next 8 byte aligned bytes of the arena (bump allocation, no header per block), free() of a block of the arena
+  does nothing.
+- The arena is active only within sml_file_parse(). The allocations of publish(), of the http transport and of the
+  debug output go to the heap as before, even while the tree is in use; the ESP8266 has no other thread that could
+  allocate during the parse (no malloc in interrupts).
+- The tree is valid until the next smlFileParse(), which starts the arena from the beginning. smlFileFree() does not
+  walk the tree unless a block of it went to the heap (tree larger than the arena, SmlArenaStats::spills).
+- The block of the arena is allocated at the first parse and kept, i.e. it is not allocated at all if the messages
+  are evaluated by SmlObisReader (SML_ZERO_COPY_PARSER) without VERBOSE_LEVEL_MeterProtocol.
+
+Without SML_PARSE_ARENA smlFileParse() and smlFileFree() are sml_file_parse() and sml_file_free().
+smlBench -a compares both: heap allocations, time of parse and free and, on the ESP8266, the fragmentation.
+
+## Usage ##
+```bash
+sml_file *file = smlFileParse(buffer + 8, len - 16);
+...
+smlFileFree(file);
+```
+
+*** end description *** */
+
+SmlParseArena *smlParseArena()
+{
+    static SmlParseArena arena;
+    return &arena;
+}
+
+#ifdef SML_PARSE_ARENA
+extern "C" void *__real_malloc(size_t size);
+
+static const size_t ARENA_ALIGN = 8;
+
+void SmlParseArena::begin()
+{
+    if (_base == NULL)
+    {
+        _base = (byte *)__real_malloc(SML_PARSE_ARENA_SIZE);
+        _size = (_base != NULL) ? SML_PARSE_ARENA_SIZE : 0;
+    }
+    _top = 0;
+    _spilled = false;
+    _active = (_base != NULL);
+    _stats.parses++;
+}
+
+void SmlParseArena::end()
+{
+    _active = false;
+    if (_top > _stats.peakBytes)
+    {
+        _stats.peakBytes = _top;
+    }
+}
+
+void *SmlParseArena::alloc(size_t size)
+{
+    size_t top = (_top + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+    if (size > _size || top > _size - size)
+    {
+        _spilled = true;
+        _stats.spills++;
+        return NULL;
+    }
+    _top = top + size;
+    _stats.allocs++;
+    return _base + top;
+}
+
+// the size of a block is not stored: at most the bytes up to the top of the arena are copied
+void *SmlParseArena::realloc(void *ptr, size_t size)
+{
+    size_t available = extent(ptr);
+    void *block = alloc(size);
+    if (block != NULL)
+    {
+        memmove(block, ptr, (size < available) ? size : available);
+    }
+    return block;
+}
+
+sml_file *smlFileParse(byte *message, size_t len)
+{
+    SmlParseArena *arena = smlParseArena();
+    arena->begin();
+    sml_file *file = sml_file_parse(message, len);
+    arena->end();
+    return file;
+}
+
+void smlFileFree(sml_file *file)
+{
+    if (smlParseArena()->spilled())
+    {
+        sml_file_free(file);        // the blocks on the heap; free() of the blocks in the arena does nothing
+    }
+}
+
+#else
+sml_file *smlFileParse(byte *message, size_t len)
+{
+    return sml_file_parse(message, len);
+}
+
+void smlFileFree(sml_file *file)
+{
+    sml_file_free(file);
+}
+#endif  // SML_PARSE_ARENA
@@ -0,0 +1,51 @@
+#ifndef SML_ARENA_H
+#define SML_ARENA_H
+
+#include <sml/sml_file.h>
+#include "hal.h"
+
+#ifndef SML_PARSE_ARENA_SIZE
+#define SML_PARSE_ARENA_SIZE 4096       // tree of one sml_file_parse() incl. the copy of the message, bytes
+#endif
+
+struct SmlArenaStats
+{
+    uint32_t parses;                // sml_file_parse() in the arena
+    uint32_t allocs;                // allocations taken from the arena
+    uint32_t spills;                // allocations of a parse on the heap: arena full
+    uint32_t peakBytes;             // largest tree of a parse
+};
+
+// bump allocator for the tree of sml_file_parse() (see smlArena.cpp); the allocation functions of libsml are
+// redirected to it by the wrappers of smlAlloc.cpp (SML_PARSE_ARENA, linker option --wrap)
+class SmlParseArena
+{
+public:
+    void begin();                   // the following allocations come from the arena, its previous blocks are void
+    void end();                     // the following allocations come from the heap, the blocks stay valid
+    bool active() const { return _active; }
+    bool owns(const void *ptr) const { return ptr >= _base && ptr < _base + _size; }
+    void *alloc(size_t size);       // NULL if the arena is full (SmlArenaStats::spills)
+    void *realloc(void *ptr, size_t size);
+    // bytes from a block to the top of the arena, at least the size of the block
+    size_t extent(const void *ptr) const { return ((const byte *)ptr < _base + _top) ? _base + _top - (const byte *)ptr : 0; }
+    bool spilled() const { return _spilled; }   // a block of the last parse is on the heap
+    const SmlArenaStats &getStats() const { return _stats; }
+
+private:
+    byte *_base = NULL;             // allocated at the first begin(), not at all with SML_ZERO_COPY_PARSER
+    size_t _size = 0;
+    size_t _top = 0;
+    bool _active = false;
+    bool _spilled = false;
+    SmlArenaStats _stats = {};
+};
+
+SmlParseArena *smlParseArena();
+
+// sml_file_parse() / sml_file_free() of libsml, in the arena with SML_PARSE_ARENA: one tree at a time,
+// the next smlFileParse() reuses the arena; smlFileFree() frees only blocks that went to the heap
+sml_file *smlFileParse(byte *message, size_t len);
+void smlFileFree(sml_file *file);
+
+#endif // SML_ARENA_H
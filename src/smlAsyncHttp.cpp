@@ -0,0 +1,447 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include "smlAsyncHttp.h"
+
+/* *** smlAsyncHttp.cpp asynchronous http transport: bounded request queue, state machine driven by loop()
+
+2026-10-17 mh
+- first version: requests of SmlHttp are queued and sent over a non-blocking TcpConnection (ESPAsyncTCP)
+- the result of each request to an HttpListener (setListener())
+
+(C) M. Herbert, 2026.
+Licensed under the GNU General Public License v3.0
+
+*** end change log *** */
+
+/* ***
+# Description AsyncHttpTransport #
+HTTPClient::POST() blocks loop() for the whole round trip (connect, request, response). Meanwhile Sensor::loop()
+is not called and the SoftwareSerial buffer may overflow, i.e. telegrams are lost.
+
+AsyncHttpTransport is a HttpTransport whose post() only copies url, content type and body into a queue of
+VZ_HTTP_QUEUE requests and returns HTTP_QUEUED, or HTTP_QUEUE_FULL if the queue is full (SmlHttp then keeps the
+tuples in the batch of the channel). loop() advances a state machine that never waits for the network:
+```bash
+IDLE        --(request queued)-->           CONNECTING (or SENDING on the kept connection)
+CONNECTING  --(connected)-->                SENDING
+SENDING     --(header and body written)-->  RECEIVING
+RECEIVING   --(response complete)-->        IDLE, next request
+any state   --(error, VZ_HTTP_TIMEOUT)-->   WAIT_RETRY --(VZ_HTTP_RETRY)--> IDLE, same request
+```
+The response is parsed byte by byte (status line, Content-Length, chunked, Connection: close), so the connection
+stays open for the next request. A request that failed on a kept connection is sent again at once on a new one,
+otherwise after VZ_HTTP_RETRY; after VZ_HTTP_ATTEMPTS errors it is dropped. The result of each request, response
+code or -1 if it was dropped, goes to the HttpListener (setListener()) with the id of the request, SmlHttp then
+stores the tuples of a request the server did not take in the backlog.
+
+stats (hal.h) holds queue depth, requests in flight, dropped requests and the counters of the synchronous transports.
+
+## Usage ##
+```bash
+AsyncHttpTransport transport(halTcpConnection());
+my_http.setTransport(&transport);
+loop(): my_http.loop();                 // calls transport.loop()
+```
+
+*** end description *** */
+
+// split http://host[:port]/path; hostPort: host[:port] for the Host header
+static bool splitUrl(const char *url, char *hostPort, size_t size, char *host, uint16_t *port, const char **path)
+{
+    const char *prefix = "http://";
+    if (strncmp(url, prefix, strlen(prefix)) != 0)
+    {
+        return false;
+    }
+    const char *begin = url + strlen(prefix);
+    const char *end = strchr(begin, '/');
+    *path = end ? end : "/";
+    size_t len = end ? (size_t)(end - begin) : strlen(begin);
+    const char *colon = (const char *)memchr(begin, ':', len);
+    size_t hostLen = colon ? (size_t)(colon - begin) : len;
+    if (hostLen == 0 || len >= size)
+    {
+        return false;
+    }
+    snprintf(hostPort, size, "%.*s", (int)len, begin);
+    snprintf(host, size, "%.*s", (int)hostLen, begin);
+    *port = colon ? (uint16_t)atoi(colon + 1) : 80;
+    return true;
+}
+
+// case insensitive test of a header line "Name: value" for the name and a token of the value
+static bool headerHas(const char *line, const char *name, const char *token)
+{
+    size_t nameLen = strlen(name);
+    if (strncasecmp(line, name, nameLen) != 0 || line[nameLen] != ':')
+    {
+        return false;
+    }
+    if (token == NULL)
+    {
+        return true;
+    }
+    size_t tokenLen = strlen(token);
+    for (const char *value = line + nameLen + 1; *value != '\0'; value++)
+    {
+        if (strncasecmp(value, token, tokenLen) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+int AsyncHttpTransport::post(const char *url, const char *contentType, const char *body)
+{
+    stats.posts++;
+    if (_count == VZ_HTTP_QUEUE)
+    {
+        stats.dropped++;
+        return HTTP_QUEUE_FULL;
+    }
+    Request &request = _queue[(_head + _count) % VZ_HTTP_QUEUE];
+    if (strlen(url) >= sizeof(request.url) || strlen(contentType) >= sizeof(request.contentType) ||
+        strlen(body) >= sizeof(request.body))
+    {
+        stats.failures++;
+        return -1;
+    }
+    strcpy(request.url, url);
+    strcpy(request.contentType, contentType);
+    strcpy(request.body, body);
+    request.id = stats.posts;
+    request.attempts = 0;
+    _count++;
+    stats.depth = _count;
+    loop();                             // start at once if the connection is idle
+    return HTTP_QUEUED;
+}
+
+void AsyncHttpTransport::close()
+{
+    _connection->close();
+    stats.inFlight = 0;
+    setState(IDLE);                     // a request in flight is sent again
+}
+
+void AsyncHttpTransport::setState(State state)
+{
+    _state = state;
+    _stateMs = halClock()->millis();
+}
+
+void AsyncHttpTransport::loop()
+{
+    if (_state != IDLE && _state != WAIT_RETRY && (halClock()->millis() - _stateMs) > VZ_HTTP_TIMEOUT)
+    {
+        fail();
+    }
+    switch (_state)
+    {
+    case IDLE:
+        if (_count > 0 && start() && _state == SENDING && send())
+        {
+            receive();
+        }
+        break;
+    case CONNECTING:
+        switch (_connection->state())
+        {
+        case TCP_CONNECTED:
+            setState(SENDING);
+            if (send())
+            {
+                receive();
+            }
+            break;
+        case TCP_CLOSED:
+            fail();
+            break;
+        default:
+            break;
+        }
+        break;
+    case SENDING:
+        if (send())
+        {
+            receive();
+        }
+        break;
+    case RECEIVING:
+        receive();
+        break;
+    case WAIT_RETRY:
+        if ((halClock()->millis() - _stateMs) >= VZ_HTTP_RETRY)
+        {
+            setState(IDLE);
+        }
+        break;
+    }
+}
+
+// set up the request at the head of the queue, false on an error
+bool AsyncHttpTransport::start()
+{
+    Request &request = _queue[_head];
+    char hostPort[sizeof(_host)];
+    char host[sizeof(_host)];
+    uint16_t port;
+    const char *path;
+    if (!splitUrl(request.url, hostPort, sizeof(hostPort), host, &port, &path))
+    {
+        stats.failures++;
+        complete(-1);
+        return false;
+    }
+    _bodyLen = strlen(request.body);
+    _headerLen = snprintf(_header, sizeof(_header),
+                          "POST %s HTTP/1.1\r\nHost: %s\r\nConnection: %s\r\n"
+                          "Content-Type: %s\r\nContent-Length: %u\r\n\r\n",
+                          path, hostPort, _keepAlive ? "keep-alive" : "close", request.contentType, (unsigned)_bodyLen);
+    if (_headerLen >= sizeof(_header))
+    {
+        stats.failures++;
+        complete(-1);
+        return false;
+    }
+    _sent = 0;
+    _lineLen = 0;
+    _inBody = false;
+    _code = 0;
+    _contentLength = -1;
+    _chunked = false;
+    _close = !_keepAlive;
+
+    if (_connection->state() == TCP_CONNECTED && _keepAlive && port == _port && strcmp(host, _host) == 0)
+    {
+        _reused = true;
+        setState(SENDING);
+        return true;
+    }
+    _connection->close();
+    _reused = false;
+    snprintf(_host, sizeof(_host), "%s", host);
+    _port = port;
+    stats.connects++;
+    if (!_connection->connect(_host, _port))
+    {
+        fail();
+        return false;
+    }
+    setState(CONNECTING);
+    return true;
+}
+
+// write what the connection takes, true when the request is sent completely
+bool AsyncHttpTransport::send()
+{
+    const char *body = _queue[_head].body;
+    while (_sent < _headerLen + _bodyLen)
+    {
+        size_t n = (_sent < _headerLen) ? _connection->write(_header + _sent, _headerLen - _sent)
+                                        : _connection->write(body + _sent - _headerLen, _bodyLen - (_sent - _headerLen));
+        if (n == 0)
+        {
+            if (_connection->state() == TCP_CLOSED)
+            {
+                fail();
+            }
+            return false;
+        }
+        _sent += n;
+    }
+    stats.inFlight = 1;
+    setState(RECEIVING);
+    return true;
+}
+
+// read the received part of the response
+bool AsyncHttpTransport::receive()
+{
+    char data[128];
+    size_t n;
+    while (_state == RECEIVING && (n = _connection->read(data, sizeof(data))) > 0)
+    {
+        for (size_t i = 0; i < n; i++)
+        {
+            int result = parse(data[i]);
+            if (result < 0)
+            {
+                fail();
+                return false;
+            }
+            if (result > 0)
+            {
+                complete(_code);
+                return true;
+            }
+        }
+    }
+    if (_state == RECEIVING && _connection->state() == TCP_CLOSED)
+    {
+        if (_inBody && _bodyState == BODY_CLOSE)
+        {
+            complete(_code);
+            return true;
+        }
+        fail();
+    }
+    return false;
+}
+
+// one byte of the response: 1 at the end of the response, -1 on an error, 0 otherwise
+int AsyncHttpTransport::parse(char c)
+{
+    if (_inBody)
+    {
+        switch (_bodyState)
+        {
+        case BODY_CLOSE:
+            return 0;
+        case BODY_LENGTH:
+            return (--_remaining == 0) ? 1 : 0;
+        case BODY_CHUNK_DATA:
+            if (--_remaining == 0)
+            {
+                _bodyState = BODY_CHUNK_END;
+            }
+            return 0;
+        default:
+            break;                      // line
+        }
+    }
+    if (c != '\n')
+    {
+        if (_lineLen + 1 >= sizeof(_line))
+        {
+            return -1;
+        }
+        _line[_lineLen++] = c;
+        return 0;
+    }
+    if (_lineLen > 0 && _line[_lineLen - 1] == '\r')
+    {
+        _lineLen--;
+    }
+    _line[_lineLen] = '\0';
+    _lineLen = 0;
+    return _inBody ? parseBodyLine(_line) : parseHeader(_line);
+}
+
+// status or header line
+int AsyncHttpTransport::parseHeader(const char *line)
+{
+    if (_code == 0)
+    {
+        // status line "HTTP/1.1 200 OK"
+        int major;
+        int minor;
+        if (sscanf(line, "HTTP/%d.%d %d", &major, &minor, &_code) != 3 || _code <= 0)
+        {
+            return -1;
+        }
+        _close |= (major == 1 && minor == 0);
+        return 0;
+    }
+    if (*line != '\0')
+    {
+        if (headerHas(line, "Content-Length", NULL))
+        {
+            _contentLength = atol(line + 15);
+        }
+        else if (headerHas(line, "Transfer-Encoding", "chunked"))
+        {
+            _chunked = true;
+        }
+        else if (headerHas(line, "Connection", "close"))
+        {
+            _close = true;
+        }
+        return 0;
+    }
+
+    // end of the header
+    _inBody = true;
+    if (_chunked)
+    {
+        _bodyState = BODY_CHUNK_SIZE;
+    }
+    else if (_contentLength > 0)
+    {
+        _bodyState = BODY_LENGTH;
+        _remaining = _contentLength;
+    }
+    else if (_contentLength == 0 || _code < 200 || _code == 204 || _code == 304)
+    {
+        return 1;
+    }
+    else
+    {
+        _bodyState = BODY_CLOSE;        // body up to the end of the connection
+        _close = true;
+    }
+    return 0;
+}
+
+// chunk size, end of chunk data or trailer line
+int AsyncHttpTransport::parseBodyLine(const char *line)
+{
+    switch (_bodyState)
+    {
+    case BODY_CHUNK_SIZE:
+        _remaining = strtoul(line, NULL, 16);
+        _bodyState = (_remaining > 0) ? BODY_CHUNK_DATA : BODY_TRAILER;
+        return 0;
+    case BODY_CHUNK_END:
+        _bodyState = BODY_CHUNK_SIZE;
+        return 0;
+    case BODY_TRAILER:
+        return (*line == '\0') ? 1 : 0;
+    default:
+        return -1;
+    }
+}
+
+// response received or request dropped: result to the listener, next request
+void AsyncHttpTransport::complete(int code)
+{
+    _lastCode = code;
+    stats.inFlight = 0;
+    if (_listener != NULL)
+    {
+        _listener->requestDone(_queue[_head].id, code);
+    }
+    _head = (_head + 1) % VZ_HTTP_QUEUE;
+    _count--;
+    stats.depth = _count;
+    if (_close)
+    {
+        _connection->close();
+    }
+    setState(IDLE);
+}
+
+// connection error or timeout: the request is sent again on a new connection
+void AsyncHttpTransport::fail()
+{
+    _connection->close();
+    stats.inFlight = 0;
+    if (_reused)
+    {
+        // the server closed the kept connection in the meantime
+        stats.retries++;
+        _reused = false;
+        setState(IDLE);
+        return;
+    }
+    if (++_queue[_head].attempts >= VZ_HTTP_ATTEMPTS)
+    {
+        stats.failures++;
+        complete(-1);
+        return;
+    }
+    setState(WAIT_RETRY);
+}
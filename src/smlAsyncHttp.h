@@ -0,0 +1,89 @@
+#ifndef SML_ASYNC_HTTP_H
+#define SML_ASYNC_HTTP_H
+
+#include "config.h"
+#include "hal.h"
+
+// http POST without waiting: post() copies the request into a bounded queue, loop() sends the queued requests
+// one after the other over a non-blocking TcpConnection (keep-alive), see smlAsyncHttp.cpp
+class AsyncHttpTransport : public HttpTransport
+{
+public:
+    AsyncHttpTransport(TcpConnection *connection) : _connection(connection) {}
+    int post(const char *url, const char *contentType, const char *body) override;    // HTTP_QUEUED or < 0
+    void loop() override;
+    bool busy() override { return _count > 0; }
+    void setListener(HttpListener *listener) override { _listener = listener; }
+    void setKeepAlive(bool keepAlive) override { _keepAlive = keepAlive; }
+    void close() override;
+    int lastCode() { return _lastCode; }    // response code of the last completed request
+
+private:
+    enum State
+    {
+        IDLE,
+        CONNECTING,
+        SENDING,
+        RECEIVING,
+        WAIT_RETRY
+    };
+    enum BodyState                      // response body
+    {
+        BODY_LENGTH,                    // Content-Length bytes
+        BODY_CHUNK_SIZE,
+        BODY_CHUNK_DATA,
+        BODY_CHUNK_END,                 // CRLF after the data of a chunk
+        BODY_TRAILER,
+        BODY_CLOSE                      // up to the end of the connection
+    };
+    struct Request
+    {
+        char url[160];
+        char contentType[40];
+        char body[VZ_HTTP_BODY_MAX];
+        uint32_t id;                    // stats.posts after the post()
+        uint8_t attempts;
+    };
+
+    bool start();
+    bool send();
+    bool receive();
+    int parse(char c);
+    int parseHeader(const char *line);
+    int parseBodyLine(const char *line);
+    void complete(int code);
+    void fail();
+    void setState(State state);
+
+    TcpConnection *_connection;
+    HttpListener *_listener = NULL;
+    Request _queue[VZ_HTTP_QUEUE];
+    uint8_t _head = 0;
+    uint8_t _count = 0;
+    State _state = IDLE;
+    uint32_t _stateMs = 0;
+    bool _keepAlive = true;
+    bool _reused = false;
+    char _host[64] = "";                // host and port of the connection
+    uint16_t _port = 0;
+
+    // request in flight
+    char _header[320];
+    size_t _headerLen = 0;
+    size_t _bodyLen = 0;
+    size_t _sent = 0;
+
+    // response
+    char _line[256];                    // status and header lines
+    size_t _lineLen = 0;
+    bool _inBody = false;
+    BodyState _bodyState = BODY_LENGTH;
+    size_t _remaining = 0;
+    long _contentLength = -1;
+    bool _chunked = false;
+    int _code = 0;
+    int _lastCode = 0;
+    bool _close = false;
+};
+
+#endif // SML_ASYNC_HTTP_H
@@ -0,0 +1,301 @@
+#include <string.h>
+#include "smlBacklog.h"
+#include "smlCrc16.h"
+
+/* *** smlBacklog.cpp store-and-forward of tuples in flash while the Volkszaehler server is unreachable
+
+2026-10-17 mh
+- first version: fixed size records in append-only segment files (LittleFS), cursor, rotation of the segments
+- value of a record as scaled integer (smlDecimal.h) instead of double
+
+(C) M. Herbert, 2026.
+Licensed under the GNU General Public License v3.0
+
+*** end change log *** */
+
+/* ***
+# Description SmlBacklog #
+If a batch of a channel cannot be posted, SmlHttp writes its tuples to the backlog instead of dropping them.
+When the server answers again, SmlHttp posts the backlog in batches, VZ_BACKLOG_DRAIN requests per telegram.
+
+## Format ##
+A record is 16 bytes: time stamp (s, ms), index of the channel in the channel table, a check byte and the value.
+The records are appended to segment files VZ_BACKLOG_DIR/<number>.seg of up to VZ_BACKLOG_SEGMENT bytes,
+the number increases with each segment. The state file holds the cursor (segment, offset) of the oldest record
+not posted yet; on begin() the records before the cursor are skipped, a record torn by a power loss is detected
+by its check byte and dropped.
+
+A record holds only the index of the channel. The state file also holds the UUID hash of each channel (bind());
+when the UUID of a channel changes, its records up to the current segment are dropped by peek() and the next
+records go to a new segment, i.e. no value is posted to the UUID of another channel.
+
+## Flash wear ##
+- Records are collected in RAM and written in blocks of VZ_BACKLOG_BUFFER records (one 256 byte page),
+  i.e. a write programs one data page and one metadata page of LittleFS for 256 bytes of records.
+  At most VZ_BACKLOG_BUFFER records are lost on a power loss.
+- Segments are never rewritten: a posted segment is removed as a whole and LittleFS allocates the blocks of the
+  next segment elsewhere (wear leveling of LittleFS).
+- With more than VZ_BACKLOG_SEGMENTS segments the oldest segment is removed (SmlBacklogStats::dropped).
+- The cursor is written after VZ_BACKLOG_CURSOR posted records, when a segment is removed and by flush().
+  After a power loss up to VZ_BACKLOG_CURSOR records may be posted a second time.
+
+SmlBacklogStats::programBytes estimates the programmed flash from these operations (page granularity),
+programBytes / bytes is the write amplification (about 2 while the server is down, smlBench -l).
+
+## Usage ##
+```bash
+SmlBacklog backlog(halSegmentStorage());
+backlog.begin();
+backlog.bind(channel, smlChannelUuidHash(uuid)); // for each channel of the table
+backlog.add(channel, sec, ms, value);           // buffered, written by peek(), flush() or when the buffer is full
+n = backlog.peek(records, max);                 // oldest records
+backlog.consume(n);                             // posted; asynchronous: when the server confirmed them
+```
+
+*** end description *** */
+
+static const size_t FLASH_PAGE = 256;           // program size of LittleFS on the ESP8266
+
+static_assert(sizeof(SmlBacklogRecord) == 16, "SmlBacklogRecord must be 16 bytes");
+
+struct SmlBacklogState
+{
+    uint32_t segment;                           // cursor
+    uint32_t offset;
+    uint32_t uuid[SML_CHANNELS_MAX];
+    uint32_t discard[SML_CHANNELS_MAX];
+};
+
+uint8_t SmlBacklog::check(const SmlBacklogRecord &record)
+{
+    SmlBacklogRecord copy = record;
+    copy.check = 0;
+    return (uint8_t)smlCrc16((const byte *)&copy, sizeof(copy));
+}
+
+bool SmlBacklog::begin()
+{
+    if (!_storage->begin())
+    {
+        return false;
+    }
+    SmlBacklogState cursor;
+    bool state = _storage->readState(&cursor, sizeof(cursor));
+    if (state)
+    {
+        memcpy(_uuid, cursor.uuid, sizeof(_uuid));
+        memcpy(_discard, cursor.discard, sizeof(_discard));
+        for (uint8_t i = 0; i < SML_CHANNELS_MAX; i++)
+        {
+            _sealed = (_discard[i] > _sealed) ? _discard[i] : _sealed;
+        }
+    }
+    _writeSegment = _sealed;                    // empty: the first segment after the sealed ones
+    _readSegment = _sealed + 1;
+    uint32_t first;
+    uint32_t last;
+    if (_storage->range(&first, &last))
+    {
+        _readSegment = first;
+        _readOffset = 0;
+        _writeSegment = last;
+        _writeSize = _storage->size(last);
+        if (state && cursor.segment >= first && cursor.segment <= last)
+        {
+            while (_readSegment < cursor.segment)
+            {
+                _storage->remove(_readSegment++);       // posted, but not removed before the reset
+            }
+            _readOffset = cursor.offset;
+        }
+        if (_writeSize % sizeof(SmlBacklogRecord) != 0)
+        {
+            _writeSize = VZ_BACKLOG_SEGMENT;            // torn record at the end: next records to a new segment
+        }
+        _stored = 0;
+        for (uint32_t segment = _readSegment; segment <= _writeSegment; segment++)
+        {
+            _stored += _storage->size(segment) / sizeof(SmlBacklogRecord);
+        }
+        _stored -= (_readOffset / sizeof(SmlBacklogRecord) < _stored) ? _readOffset / sizeof(SmlBacklogRecord) : _stored;
+    }
+    _ready = true;
+    return true;
+}
+
+void SmlBacklog::bind(uint8_t channel, uint32_t uuidHash)
+{
+    if (channel >= SML_CHANNELS_MAX || _uuid[channel] == uuidHash)
+    {
+        return;
+    }
+    if (_uuid[channel] != 0)
+    {
+        writeBuffer();
+        _discard[channel] = _writeSegment;
+        _sealed = _writeSegment;
+    }
+    _uuid[channel] = uuidHash;
+    saveCursor();
+}
+
+void SmlBacklog::add(uint8_t channel, uint32_t sec, uint16_t ms, int64_t value)
+{
+    if (_count == VZ_BACKLOG_BUFFER)
+    {
+        writeBuffer();
+    }
+    SmlBacklogRecord &record = _buffer[_count++];
+    record.sec = sec;
+    record.ms = ms;
+    record.channel = channel;
+    record.value = value;
+    record.check = check(record);
+}
+
+void SmlBacklog::flush()
+{
+    writeBuffer();
+    if (_unsaved > 0)
+    {
+        saveCursor();
+    }
+}
+
+void SmlBacklog::writeBuffer()
+{
+    if (_count == 0)
+    {
+        return;
+    }
+    size_t len = _count * sizeof(SmlBacklogRecord);
+    if (!_ready)
+    {
+        _stats.dropped += _count;
+        _count = 0;
+        return;
+    }
+    if (_writeSegment + 1 == _readSegment || _writeSegment <= _sealed || _writeSize + len > VZ_BACKLOG_SEGMENT)
+    {
+        newSegment();
+    }
+    if (_storage->append(_writeSegment, _buffer, len))
+    {
+        _writeSize += len;
+        _stored += _count;
+        _stats.records += _count;
+        _stats.appends++;
+        _stats.bytes += len;
+        _stats.programBytes += (len + FLASH_PAGE - 1) / FLASH_PAGE * FLASH_PAGE + FLASH_PAGE;
+    }
+    else
+    {
+        _stats.dropped += _count;
+    }
+    _count = 0;
+}
+
+void SmlBacklog::newSegment()
+{
+    _writeSegment++;
+    _writeSize = 0;
+    if (_writeSegment - _readSegment + 1 > VZ_BACKLOG_SEGMENTS)
+    {
+        // rotation: the oldest records are dropped
+        uint32_t records = (readSize() - _readOffset) / sizeof(SmlBacklogRecord);
+        _stats.dropped += records;
+        _stored -= (records < _stored) ? records : _stored;
+        _consumed += records;
+        removeReadSegment();
+        saveCursor();
+    }
+}
+
+// size of the segment of the cursor
+size_t SmlBacklog::readSize()
+{
+    return (_readSegment == _writeSegment) ? _writeSize : _storage->size(_readSegment);
+}
+
+void SmlBacklog::removeReadSegment()
+{
+    _storage->remove(_readSegment);
+    _stats.programBytes += FLASH_PAGE;
+    _readSegment++;
+    _readOffset = 0;
+}
+
+void SmlBacklog::saveCursor()
+{
+    SmlBacklogState state;
+    state.segment = _readSegment;
+    state.offset = _readOffset;
+    memcpy(state.uuid, _uuid, sizeof(_uuid));
+    memcpy(state.discard, _discard, sizeof(_discard));
+    _storage->writeState(&state, sizeof(state));
+    _unsaved = 0;
+    _stats.programBytes += FLASH_PAGE;
+}
+
+size_t SmlBacklog::peek(SmlBacklogRecord *records, size_t max)
+{
+    writeBuffer();
+    while (max > 0 && _readSegment <= _writeSegment)
+    {
+        size_t size = readSize();
+        if (_readOffset + sizeof(SmlBacklogRecord) > size)
+        {
+            consume(0, false);                          // end of the segment (a torn record at the end is skipped)
+            continue;
+        }
+        size_t n = (size - _readOffset) / sizeof(SmlBacklogRecord);
+        n = (n < max) ? n : max;
+        n = _storage->read(_readSegment, _readOffset, records, n * sizeof(SmlBacklogRecord)) / sizeof(SmlBacklogRecord);
+        if (n == 0)
+        {
+            consume((size - _readOffset) / sizeof(SmlBacklogRecord), false);     // segment not readable
+            continue;
+        }
+        size_t valid = 0;
+        while (valid < n && records[valid].check == check(records[valid]) &&
+               (records[valid].channel >= SML_CHANNELS_MAX || _readSegment > _discard[records[valid].channel]))
+        {
+            valid++;
+        }
+        if (valid > 0)
+        {
+            return valid;
+        }
+        consume(1, false);                              // invalid record, or of a channel with another UUID now
+    }
+    return 0;
+}
+
+void SmlBacklog::consume(size_t n, bool posted)
+{
+    if (posted)
+    {
+        _stats.drained += n;
+    }
+    else
+    {
+        _stats.dropped += n;
+    }
+    _stored -= (n < _stored) ? n : _stored;
+    _readOffset += n * sizeof(SmlBacklogRecord);
+    _unsaved += n;
+    _consumed += n;
+    if (_readOffset + sizeof(SmlBacklogRecord) > readSize())
+    {
+        if (_readSegment == _writeSegment)
+        {
+            _writeSize = VZ_BACKLOG_SEGMENT;            // the next records to a new segment
+        }
+        removeReadSegment();
+        saveCursor();
+    }
+    else if (_unsaved >= VZ_BACKLOG_CURSOR)
+    {
+        saveCursor();
+    }
+}
@@ -0,0 +1,71 @@
+#ifndef SML_BACKLOG_H
+#define SML_BACKLOG_H
+
+#include "config.h"
+#include "hal.h"
+
+// one stored tuple (16 bytes)
+struct SmlBacklogRecord
+{
+    uint32_t sec;                   // time stamp
+    uint16_t ms;
+    uint8_t channel;                // index of SmlHttpConfig::channel
+    uint8_t check;                  // CRC of the other bytes, detects a record torn by a power loss
+    int64_t value;                  // 10^-SML_VALUE_DECIMALS (smlDecimal.h)
+};
+
+struct SmlBacklogStats
+{
+    uint32_t records;               // records written to flash
+    uint32_t drained;               // records posted from the backlog
+    uint32_t dropped;               // records lost: oldest segment removed, invalid record, channel removed or rebound
+    uint32_t appends;               // write operations (data)
+    uint32_t bytes;                 // bytes of the records written
+    uint32_t programBytes;          // estimated programmed flash: data pages, metadata page per write, cursor, remove
+};
+
+// append-only log of tuples in numbered segment files, read by a cursor (see smlBacklog.cpp)
+class SmlBacklog
+{
+public:
+    SmlBacklog(SegmentStorage *storage) : _storage(storage) {}
+    bool begin();                   // find the segments and the cursor of the storage
+    // UUID (smlChannelUuidHash()) of a channel, after begin(): a new UUID discards the records of the channel
+    void bind(uint8_t channel, uint32_t uuidHash);
+    void add(uint8_t channel, uint32_t sec, uint16_t ms, int64_t value);
+    void flush();                   // write the records buffered in RAM and the cursor
+    // oldest records of the current segment; the RAM buffer is written first
+    size_t peek(SmlBacklogRecord *records, size_t max);
+    void consume(size_t n, bool posted = true);
+    // records consumed or removed by the rotation since begin(): peek() returns the same records while it is unchanged
+    uint32_t consumed() { return _consumed; }
+    bool empty() { return _count == 0 && _stored == 0; }
+    uint32_t pending() { return _count + _stored; }
+    const SmlBacklogStats &getStats() { return _stats; }
+
+private:
+    void writeBuffer();
+    void newSegment();
+    void removeReadSegment();
+    void saveCursor();
+    size_t readSize();
+    static uint8_t check(const SmlBacklogRecord &record);
+
+    SegmentStorage *_storage;
+    bool _ready = false;
+    uint32_t _readSegment = 1;      // empty: _writeSegment + 1 == _readSegment
+    uint32_t _readOffset = 0;
+    uint32_t _writeSegment = 0;
+    uint32_t _writeSize = 0;
+    uint32_t _stored = 0;           // records in flash after the cursor
+    uint32_t _unsaved = 0;          // records consumed since the last write of the cursor
+    uint32_t _consumed = 0;
+    uint32_t _uuid[SML_CHANNELS_MAX] = {};      // UUID hash of the channel, 0: unknown
+    uint32_t _discard[SML_CHANNELS_MAX] = {};   // records of the channel up to this segment are dropped
+    uint32_t _sealed = 0;           // highest segment of _discard, the next records go to a later segment
+    SmlBacklogRecord _buffer[VZ_BACKLOG_BUFFER];
+    uint8_t _count = 0;
+    SmlBacklogStats _stats = {};
+};
+
+#endif // SML_BACKLOG_H
@@ -0,0 +1,1767 @@
+/* *** smlBench.cpp benchmark of the SML frame path, PlatformIO env:native_bench and env:d1_mini_bench
+
+2026-10-17 mh
+- first version: per frame timing of start/end sequence search, parse, publish, free; malloc counts and peak heap
+- framing benchmark (-s): SmlScanner against the former byte-wise start and end sequence search
+- CRC16 benchmark (-s): bitwise, libsml, smlCrc16
+- cross-check (-x): SmlObisReader against sml_file_parse(), entries, time and mallocs of both
+- http latency (-p, host only): post with a connection per post against keep-alive
+- http latency (-p): asynchronous transport, longest blocking call of post() or loop()
+- backlog (-l): append and drain throughput of SmlBacklog, write amplification
+- derived power (-d): SmlPowerDerivation (64 bit integer) against the same algorithm in double with pow()
+- value path (-v): scaled integers of smlDecimal.cpp against double, pow() and "%.2f" per entry
+- several meters (-m, host only): replay of simultaneous synthetic streams, SmlScheduler against the former loop
+- frame handoff (-o, host only): Sensor::receive() between the posts of a long processing against pump()
+- frame pool (-g, host only): memory of the frame buffers before and after SmlFramePool, peak use and fragmentation
+- layout cache (-c): evaluation by the learned offsets (smlLayout.cpp) against the complete walk, same values expected
+- parse arena (-a): sml_file_parse() in the parse arena (smlArena.cpp) against the heap, mallocs, time, fragmentation
+- push decoder (-e): entries decoded during the reception (smlStream.cpp) against the walk at the processing
+
+(C) M. Herbert, 2026.
+Licensed under the GNU General Public License v3.0
+
+*** end change log *** */
+
+/* ***
+# SMLReaderVZ benchmark #
+Feeds SML frames through Sensor -> smlProcessFrame() and reports per frame
+- time of the stages (see smlProfile.h) in us
+- malloc calls per stage, malloc/free calls and peak heap of the frame (see smlAlloc.h)
+
+as CSV (one line per frame) or JSON (frames and summary with mean/min/max), to track regressions between versions.
+Publishing uses a transport without network, i.e. the publish stage measures the evaluation and formatting only.
+
+The framing benchmark (-s) runs the byte stream in blocks of BENCH_BLOCK bytes through SmlScanner and through the
+former byte-wise search of Sensor.cpp (LegacyFramer) and reports frames found, time and throughput of both
+(the scanner includes the CRC calculation). The CRC16 of the stream is calculated bit by bit, by libsml and by
+smlCrc16 in blocks as in Sensor, with the same result expected.
+
+The cross-check (-x) evaluates each frame with sml_file_parse() and with SmlObisReader (SML_ZERO_COPY_PARSER)
+and compares the list entries (OBIS, unit, scaler, type, value); differences are printed per frame.
+It reports time and malloc calls per frame of both.
+
+The http benchmark (-p, host only) posts -n values to the given url (e.g. a local http server), once with a new
+connection and name resolution per post as before, once over one kept connection (VZ_HTTP_KEEP_ALIVE),
+once with the asynchronous transport (VZ_HTTP_ASYNC), and reports the latency per post and the longest
+post() or loop() call, i.e. how long the application loop is blocked.
+
+The backlog benchmark (-l) appends -n records to SmlBacklog (as SmlHttp while the server is unreachable) and
+reads them back in batches of VZ_BATCH_TUPLES records with peek()/consume() (as the drain when the server answers
+again). It reports records/s of both and the write amplification, i.e. the estimated programmed flash
+(SmlBacklogStats::programBytes) per byte of records. Use an empty directory: records already stored are drained too.
+
+The derived power benchmark (-d) feeds -n readings of a simulated energy counter (0.1 Wh resolution, scaler -1,
+one telegram per second, changing load) to SmlPowerDerivation and to the same algorithm with
+value * pow(10, scaler) in double as SmlHttp did before. It reports the time per reading of both, the number of power
+values, the readings where only one of them posts a value (differences: the decay limit equals the last power, but
+the difference of two counter readings is not exact in double) and the largest difference of the power values
+(rounding of the integer division, < 0.001 W expected).
+
+The value benchmark (-v) takes the numeric entries of the telegram and converts each of them as SmlHttp posts it:
+scaler, factor and the text of the http body, once as before (value * pow(10, scaler) in double, factor as float,
+snprintf "%.2f") and once with smlDecimalScale(), smlDecimalMultiply() and smlDecimalFormat(). It reports the ticks
+(CPU cycles on the ESP8266, ns on the host) per entry of both and the entries whose texts differ (the factor
+1.0001 is not exact as float; exact halves are rounded away from zero by smlDecimalFormat(), by the binary value
+in double).
+
+The meters benchmark (-m, host only) replays -m synthetic streams of the built-in telegram at the same time
+(SmlReplayClock as fast as possible), -n telegrams per meter with slightly different intervals (about 1 s), so the
+telegrams of the meters meet in all phases. The device is modelled in virtual time: the SoftwareSerial buffer keeps
+BENCH_SERIAL_BUFFER bytes (SmlReplay::setCapacity(), older input is lost) and the processing of a telegram takes
+a given time (SmlReplayClock::spend(), e.g. parse, publish and a blocking http post). For processing times of
+20 ms to 160 ms it reports the telegrams received, the bytes lost and the largest ring buffer fill of SmlScheduler
+and of the former loop over the sensors (pump and step of one sensor after the other). Expected: no loss with the
+scheduler as long as one processing fits into the SoftwareSerial buffer (133 ms for 128 bytes at 9600 Baud).
+
+The frame handoff benchmark (-o, host only) replays -n built-in telegrams at 1 s intervals to one sensor with the
+same SoftwareSerial model. The processing is a series of blocking http posts of BENCH_POST_MS each, every 5th
+telegram flushes a longer series (1 s to 8 s). Between the posts either Sensor::receive() runs (input and framing
+into a spare frame buffer, as SmlHttp does) or only Sensor::pump() (input to the ring buffer, the former behaviour).
+It reports the telegrams received, processed and dropped for want of a free frame buffer, framing and CRC errors
+and the bytes lost in SoftwareSerial. Expected: with receive() no bytes lost and no framing errors, a telegram that
+finds all SENSOR_FRAME_BUFFERS busy is dropped as a whole; with pump() losses once a processing exceeds the ring
+buffer (about 1.1 s).
+
+The frame pool benchmark (-g, host only) replays -n synthetic telegrams of 300, 452 and 1600 bytes of three meters
+(own start sequence, payload, end sequence and CRC) at the same time; the processing is two posts of BENCH_POST_MS
+with the reception of all sensors in between. It reports the memory of the frame buffers as embedded in each Sensor
+before (SENSOR_FRAME_BUFFERS * BUFFER_SIZE per sensor, on the heap with the Sensor object) and as SmlFramePool
+(SML_FRAME_POOL_SIZE, static), the heap of a Sensor object (sizeof), the peak use and fragmentation of the pool, grown and
+moved frame buffers and the telegrams received and dropped, and the largest telegram learned per meter.
+On the ESP8266 the frame benchmark prints the free heap, its largest block and the peak use of the frame pool.
+
+The layout cache benchmark (-c) publishes -n passes of the built-in telegram with SmlHttp::publish() of the message
+bytes, once with the layout cache (SmlObisLayout, smlLayout.cpp) and once with the complete walk of SmlObisReader.
+Each pass changes the bytes of all numeric values (as a meter does), every 50th pass also the scaler of the last
+numeric entry, i.e. the structure: this telegram and the next one are parsed completely and the layout is learned
+again. It reports hits, misses and layouts learned, the passes where the values of the channels differ between both
+(none expected) and the time per telegram of the parse stage (match and the walk, see smlProfile.h) and of the
+whole publish() of both.
+
+The parse arena benchmark (-a) parses -n built-in telegrams or the telegrams of a capture (a long replay) with
+sml_file_parse() of libsml, once by smlFileParse() in the parse arena (SML_PARSE_ARENA) and once on the heap, each
+followed by the free of the tree. Between parse and free each telegram allocates a block of 16 to 215 bytes that
+lives for BENCH_ARENA_KEEP telegrams, as the processing between parse and free does (http body, transport).
+It reports per telegram the heap allocations (0 expected in the arena unless it spills), the time of parse and free
+and the fragmentation of the heap at the end and its peak (ESP.getHeapFragmentation() on the ESP8266, on the host
+the share of the free bytes of malloc outside of the top chunk, mallinfo2()), the peak use of the arena and the
+allocations that spilled to the heap.
+
+The push decoder benchmark (-e) receives -n built-in telegrams (BENCH_DECODE_BLOCK bytes per loop()) or the
+telegrams of a capture twice: once with the entries decoded during the reception (SmlObisStream,
+Sensor::setStreamDecode()) and once without. The processing publishes each telegram with SmlHttp::publish() (layout
+cache off) and, for comparison, by the complete walk of the message. It reports per telegram the time of the
+reception (end sequence search including the decoding), of the processing from the received telegram to the
+published values, the telegrams whose channel values differ from the walk (none expected) and the bytes of the
+telegram received after the entry of OBIS_ID_POWER_IN was decoded, i.e. how long before the CRC the power value is
+decoded (as ms at BENCH_BAUD).
+
+## Usage ##
+host:
+```bash
+pio run -e native_bench
+.pio/build/native_bench/program [-f csv|json] [-n frames] [-s|-x|-d|-v|-m meters|-o|-g|-c|-a|-e|-p url|-l dir] [capture]
+```
+- capture: replayed as fast as possible (see smlReplay.cpp), otherwise the built-in telegram of smlBenchData.h is used
+- -n: number of frames of the built-in telegram, default 1000
+- -s: framing and CRC benchmark only
+- -x: cross-check of SmlObisReader against libsml
+- -p: http latency per post, e.g. -p http://localhost:8080/middleware.php/data.json; -n is the number of posts
+- -l: backlog in this directory; -n is the number of records
+- -d: derived power; -n is the number of readings
+- -v: value path; -n is the number of passes over the entries of the telegram
+- -m: number of meters (2 to SML_METERS_MAX); -n is the number of telegrams per meter
+- -o: frame handoff; -n is the number of telegrams
+- -g: frame pool; -n is the number of telegrams per meter
+- -c: layout cache; -n is the number of passes
+- -a: parse arena; -n is the number of built-in telegrams, or the telegrams of the capture
+- -e: push decoder; -n is the number of built-in telegrams, or the telegrams of the capture
+
+device (ESP8266): `pio run -e d1_mini_bench -t upload -t monitor`, the built-in telegram is processed
+SML_BENCH_FRAMES times after boot and the result is printed over Serial as CSV followed by the JSON summary
+the framing and CRC benchmark, the cross-check of 100 frames, the backlog with SML_BENCH_BACKLOG records in
+LittleFS (VZ_BACKLOG_DIR), the derived power of SML_BENCH_DERIVE readings, the value path, the layout cache,
+the parse arena and the push decoder.
+
+*** end description *** */
+#ifdef SML_BENCH
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "config.h"
+#include "Sensor.h"
+#include "smlAlloc.h"
+#include "smlArena.h"
+#include "smlAsyncHttp.h"
+#include "smlBacklog.h"
+#include "smlBenchData.h"
+#include "smlDecimal.h"
+#include "smlDerive.h"
+#include "smlHttp.h"
+#include "smlPipeline.h"
+#include "smlProfile.h"
+#include "smlScheduler.h"
+#include "smlCrc16.h"
+#include "smlObis.h"
+#include "smlScanner.h"
+#include <sml/sml_crc16.h>
+#ifdef ARDUINO
+    #define BENCH_PRINTF(format, ...) Serial.printf(format, ##__VA_ARGS__)
+    #define BENCH_PLATFORM "esp8266"
+#else
+    #include <malloc.h>
+    #include <unistd.h>
+    #include "halNative.h"
+    #include "smlReplay.h"
+    #define BENCH_PRINTF(format, ...) printf(format, ##__VA_ARGS__)
+    #define BENCH_PLATFORM "native"
+#endif
+
+#ifndef SML_BENCH_FRAMES
+    #define SML_BENCH_FRAMES 1000
+#endif
+#ifndef SML_BENCH_BACKLOG
+    #define SML_BENCH_BACKLOG 2048
+#endif
+#ifndef SML_BENCH_DERIVE
+    #define SML_BENCH_DERIVE 10000
+#endif
+#define BENCH_BLOCK 64              // bytes per call of the framing, about the bytes received per loop()
+
+// built-in telegram, repeated; block > 0: at most block bytes per pump() of the sensor, as received between two loop()
+class TelegramByteSource : public ByteSource
+{
+public:
+    TelegramByteSource(uint32_t frames, size_t block = 0) : _frames(frames), _block(block) {}
+    int available() override
+    {
+        if (_block > 0 && _sent >= _block)
+        {
+            _sent = 0;
+            return 0;
+        }
+        return (_frame < _frames) ? 1 : 0;
+    }
+    int read() override
+    {
+        if (_frame >= _frames)
+        {
+            return -1;
+        }
+        _sent++;
+        int value = pgm_read_byte(&SML_BENCH_TELEGRAM[_pos]);
+        if (++_pos == sizeof(SML_BENCH_TELEGRAM))
+        {
+            _pos = 0;
+            _frame++;
+        }
+        return value;
+    }
+    bool finished() { return _frame >= _frames; }
+
+private:
+    uint32_t _frames;
+    uint32_t _frame = 0;
+    size_t _pos = 0;
+    size_t _block;
+    size_t _sent = 0;
+};
+
+// no network, only the cost of evaluation and formatting is measured
+class NullHttpTransport : public HttpTransport
+{
+public:
+    int post(const char * /*url*/, const char * /*contentType*/, const char * /*body*/) override { return 200; }
+};
+class NullDashSink : public DashSink
+{
+public:
+    void status(const char * /*text*/) override {}
+    void sensorState(int /*state*/) override {}
+    void values(uint8_t /*meter*/, const char * /*timeStamp*/, int64_t /*powerIn*/, int64_t /*energyIn*/,
+                int64_t /*energyOut*/) override {}
+};
+
+// running min/max/sum of a column
+struct BenchColumn
+{
+    double sum = 0;
+    double min = 1e30;
+    double max = 0;
+    void add(double value)
+    {
+        sum += value;
+        min = (value < min) ? value : min;
+        max = (value > max) ? value : max;
+    }
+};
+
+enum BenchColumnId
+{
+    COL_MALLOCS = PROFILE_N_STAGES,
+    COL_FREES,
+    COL_PEAK_HEAP,
+    COL_LEN,
+    N_COLUMNS
+};
+
+SmlHttpConfig benchHttpConfig;
+SmlHttp benchHttp;
+NullHttpTransport nullTransport;
+NullDashSink nullDash;
+BenchColumn columns[N_COLUMNS];
+uint32_t benchFrames = 0;
+bool benchJson = false;
+uint32_t frameMallocs = 0;
+uint32_t frameFrees = 0;
+
+void benchFrame(byte *buffer, size_t len, Sensor *sensor, State sensorState)
+{
+    if (sensorState != PROCESS_MESSAGE)
+    {
+        return;
+    }
+    smlProcessFrame(buffer, len, sensor, benchHttp, &nullDash);
+
+    // the start and end search of this frame are accumulated since the previous frame
+    double value[N_COLUMNS];
+    for (int i = 0; i < PROFILE_N_STAGES; i++)
+    {
+        value[i] = (double)smlProfile[i].ticks / SML_PROFILE_TICKS_PER_US;
+    }
+    value[COL_MALLOCS] = smlAllocStats.mallocs - frameMallocs;
+    value[COL_FREES] = smlAllocStats.frees - frameFrees;
+    value[COL_PEAK_HEAP] = smlAllocStats.peakBytes;
+    value[COL_LEN] = len;
+    for (int i = 0; i < N_COLUMNS; i++)
+    {
+        columns[i].add(value[i]);
+    }
+
+    if (benchJson)
+    {
+        BENCH_PRINTF("%s{\"frame\":%u,\"len\":%u", benchFrames ? ",\n" : "", (unsigned)benchFrames, (unsigned)len);
+        for (int i = 0; i < PROFILE_N_STAGES; i++)
+        {
+            BENCH_PRINTF(",\"%s_us\":%.3f,\"%s_mallocs\":%u", smlProfileStageName[i], value[i],
+                         smlProfileStageName[i], (unsigned)smlProfile[i].mallocs);
+        }
+        BENCH_PRINTF(",\"mallocs\":%u,\"frees\":%u,\"peak_heap\":%u}",
+                     (unsigned)value[COL_MALLOCS], (unsigned)value[COL_FREES], (unsigned)value[COL_PEAK_HEAP]);
+    }
+    else
+    {
+        BENCH_PRINTF("%u,%u", (unsigned)benchFrames, (unsigned)len);
+        for (int i = 0; i < PROFILE_N_STAGES; i++)
+        {
+            BENCH_PRINTF(",%.3f,%u", value[i], (unsigned)smlProfile[i].mallocs);
+        }
+        BENCH_PRINTF(",%u,%u,%u\n", (unsigned)value[COL_MALLOCS], (unsigned)value[COL_FREES], (unsigned)value[COL_PEAK_HEAP]);
+    }
+
+    benchFrames++;
+    smlProfileReset();
+    frameMallocs = smlAllocStats.mallocs;
+    frameFrees = smlAllocStats.frees;
+    smlAllocResetPeak();
+}
+
+// the reading head of all benchmark modes: pin of the first sensor of config.h, no minimum interval
+SensorConfig benchSensorConfig = {.pin = SENSOR_CONFIGS[0].pin, .name = "bench", .numeric_only = false, .interval = 0};
+
+// frames of source (TelegramByteSource, SmlReplay) through Sensor to frameCallback until the source is read and the
+// last frame processed; begin() after the setup of the sensor. The sensor deletes the source.
+template <class Source>
+void benchSensorRun(Source *source, void (*frameCallback)(byte *buffer, size_t len, Sensor *sensor, State sensorState),
+                    void (*begin)() = NULL, bool streamDecode = SML_STREAM_DECODE)
+{
+    Sensor sensor(&benchSensorConfig, source, frameCallback);
+    sensor.setStreamDecode(streamDecode);
+    if (begin != NULL)
+    {
+        begin();
+    }
+    while (!source->finished() || sensor.pending())
+    {
+        sensor.loop();
+    }
+}
+
+void benchBegin()
+{
+    benchHttp.init(benchHttpConfig);
+    benchHttp.setTransport(&nullTransport);
+    smlProfileReset();
+    frameMallocs = smlAllocStats.mallocs;
+    frameFrees = smlAllocStats.frees;
+    smlAllocResetPeak();
+
+    if (benchJson)
+    {
+        BENCH_PRINTF("{\"version\":\"%s\",\"platform\":\"%s\",\"frames\":[\n", WIFI_AP_CONFIG_VERSION, BENCH_PLATFORM);
+    }
+    else
+    {
+        BENCH_PRINTF("frame,len");
+        for (int i = 0; i < PROFILE_N_STAGES; i++)
+        {
+            BENCH_PRINTF(",%s_us,%s_mallocs", smlProfileStageName[i], smlProfileStageName[i]);
+        }
+        BENCH_PRINTF(",mallocs,frees,peak_heap\n");
+    }
+}
+
+void benchEnd()
+{
+    const char *name[N_COLUMNS];
+    char stageName[PROFILE_N_STAGES][24];
+    for (int i = 0; i < PROFILE_N_STAGES; i++)
+    {
+        snprintf(stageName[i], sizeof(stageName[i]), "%s_us", smlProfileStageName[i]);
+        name[i] = stageName[i];
+    }
+    name[COL_MALLOCS] = "mallocs";
+    name[COL_FREES] = "frees";
+    name[COL_PEAK_HEAP] = "peak_heap";
+    name[COL_LEN] = "len";
+
+    // summary: JSON object, for CSV output as trailing comment lines
+    BENCH_PRINTF(benchJson ? "\n],\"summary\":{\"frames\":%u" : "# summary: frames=%u\n", (unsigned)benchFrames);
+    for (int i = 0; i < N_COLUMNS && benchFrames > 0; i++)
+    {
+        BENCH_PRINTF(benchJson ? ",\"%s\":{\"mean\":%.3f,\"min\":%.3f,\"max\":%.3f}" : "# %s: mean=%.3f min=%.3f max=%.3f\n",
+                     name[i], columns[i].sum / benchFrames, columns[i].min, columns[i].max);
+    }
+    if (benchJson)
+    {
+        BENCH_PRINTF("}}\n");
+    }
+}
+
+// framing benchmark --------------------------------------------------------------------------
+// start and end sequence search of Sensor.cpp before SmlScanner, for comparison
+class LegacyFramer
+{
+public:
+    uint32_t frames = 0;
+    void feed(const byte *data, size_t len)
+    {
+        for (size_t n = 0; n < len; n++)
+        {
+            if (_trailer > 0)
+            {
+                _buffer[_position++] = data[n];
+                if (--_trailer == 0)
+                {
+                    frames++;
+                    _inMessage = false;
+                    _position = 0;
+                }
+            }
+            else if (!_inMessage)
+            {
+                _buffer[_position] = data[n];
+                _position = (_buffer[_position] == START_SEQUENCE[_position]) ? (_position + 1) : 0;
+                _inMessage = (_position == sizeof(START_SEQUENCE));
+            }
+            else
+            {
+                if ((_position + 3) == BUFFER_SIZE)
+                {
+                    _inMessage = false;
+                    _position = 0;
+                    continue;
+                }
+                _buffer[_position++] = data[n];
+                int last_index_of_end_seq = sizeof(END_SEQUENCE) - 1;
+                for (int i = 0; i <= last_index_of_end_seq; i++)
+                {
+                    if (END_SEQUENCE[last_index_of_end_seq - i] != _buffer[_position - (i + 1)])
+                    {
+                        break;
+                    }
+                    if (i == last_index_of_end_seq)
+                    {
+                        _trailer = 3;
+                    }
+                }
+            }
+        }
+    }
+
+private:
+    byte _buffer[BUFFER_SIZE];
+    size_t _position = 0;
+    bool _inMessage = false;
+    uint8_t _trailer = 0;
+};
+
+// the same with SmlScanner as used by Sensor.cpp
+class ScannerFramer
+{
+public:
+    uint32_t frames = 0;
+    void feed(const byte *data, size_t len)
+    {
+        while (len > 0)
+        {
+            size_t consumed = 1;
+            if (_trailer > 0)
+            {
+                _buffer[_position++] = *data;
+                if (--_trailer == 0)
+                {
+                    frames++;
+                    _inMessage = false;
+                }
+            }
+            else if (!_inMessage)
+            {
+                if (_scanner.findStart(data, len, &consumed) == SML_SCAN_START)
+                {
+                    memcpy(_buffer, START_SEQUENCE, sizeof(START_SEQUENCE));
+                    _position = sizeof(START_SEQUENCE);
+                    _inMessage = true;
+                }
+            }
+            else
+            {
+                SmlScanResult result = _scanner.readMessage(data, len, &consumed, _buffer, &_position, BUFFER_SIZE);
+                if (result == SML_SCAN_END)
+                {
+                    _trailer = SML_TRAILER_LEN;
+                }
+                else if (result != SML_SCAN_MORE)
+                {
+                    _inMessage = false;
+                    _scanner.reset();
+                }
+            }
+            data += consumed;
+            len -= consumed;
+        }
+    }
+
+private:
+    SmlScanner _scanner;
+    byte _buffer[BUFFER_SIZE];
+    size_t _position = 0;
+    bool _inMessage = false;
+    uint8_t _trailer = 0;
+};
+
+template <class Framer>
+void benchFramer(const char *name, const byte *stream, size_t len, uint32_t repeat, bool last)
+{
+    Framer *framer = new Framer();
+    uint32_t start = smlProfileTicks();
+    for (uint32_t r = 0; r < repeat; r++)
+    {
+        for (size_t pos = 0; pos < len; pos += BENCH_BLOCK)
+        {
+            framer->feed(stream + pos, (len - pos < BENCH_BLOCK) ? len - pos : BENCH_BLOCK);
+        }
+    }
+    double us = (double)(uint32_t)(smlProfileTicks() - start) / SML_PROFILE_TICKS_PER_US;
+    double bytes = (double)len * repeat;
+    BENCH_PRINTF(benchJson ? "\"%s\":{\"frames\":%u,\"bytes\":%.0f,\"us\":%.1f,\"MB_per_s\":%.3f}%s"
+                           : "# framing %s: frames=%u bytes=%.0f us=%.1f MB/s=%.3f%s",
+                 name, (unsigned)framer->frames, bytes, us, (us > 0) ? bytes / us : 0., last ? "" : (benchJson ? "," : "\n"));
+    delete framer;
+}
+
+// CRC benchmark ------------------------------------------------------------------------------
+// bit by bit, reference for the table driven versions
+static uint16_t crcBitwise(const byte *data, size_t len)
+{
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < len; i++)
+    {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 1) ? (crc >> 1) ^ 0x8408 : (crc >> 1);
+        }
+    }
+    return crc ^ 0xFFFF;
+}
+// smlCrc16 as used by Sensor: incremental in blocks
+static uint16_t crcIncremental(const byte *data, size_t len)
+{
+    uint16_t crc = SML_CRC16_INIT;
+    for (size_t pos = 0; pos < len; pos += BENCH_BLOCK)
+    {
+        crc = smlCrc16Update(crc, data + pos, (len - pos < BENCH_BLOCK) ? len - pos : BENCH_BLOCK);
+    }
+    return smlCrc16Final(crc);
+}
+// libsml, returns the crc byte swapped
+static uint16_t crcLibsml(const byte *data, size_t len)
+{
+    uint16_t crc = sml_crc16_calculate((unsigned char *)data, (int)len);
+    return (uint16_t)((crc >> 8) | (crc << 8));
+}
+
+void benchCrc(const char *name, uint16_t (*crcFunction)(const byte *data, size_t len),
+              const byte *stream, size_t len, uint32_t repeat, bool last)
+{
+    uint16_t crc = 0;
+    uint32_t start = smlProfileTicks();
+    for (uint32_t r = 0; r < repeat; r++)
+    {
+        crc ^= crcFunction(stream, len);
+    }
+    double us = (double)(uint32_t)(smlProfileTicks() - start) / SML_PROFILE_TICKS_PER_US;
+    double bytes = (double)len * repeat;
+    crc = crcFunction(stream, len);
+    BENCH_PRINTF(benchJson ? "\"%s\":{\"crc\":\"%04X\",\"bytes\":%.0f,\"us\":%.1f,\"MB_per_s\":%.3f}%s"
+                           : "# crc %s: crc=%04X bytes=%.0f us=%.1f MB/s=%.3f%s",
+                 name, crc, bytes, us, (us > 0) ? bytes / us : 0., last ? "" : (benchJson ? "," : "\n"));
+}
+
+// framing and CRC on the same stream, repeated until about 1 MB (host) / 64 kB (ESP8266) are processed
+void benchStream(const byte *stream, size_t len)
+{
+#ifdef ARDUINO
+    uint32_t repeat = 65536 / len + 1;
+#else
+    uint32_t repeat = 1048576 / len + 1;
+#endif
+    BENCH_PRINTF(benchJson ? "{\"framing\":{\"block\":%u," : "# framing: block=%u\n", (unsigned)BENCH_BLOCK);
+    benchFramer<LegacyFramer>("legacy", stream, len, repeat, false);
+    benchFramer<ScannerFramer>("scanner", stream, len, repeat, true);
+    BENCH_PRINTF(benchJson ? "},\"crc\":{" : "\n# crc of the stream\n");
+    benchCrc("bitwise", crcBitwise, stream, len, repeat, false);
+    benchCrc("libsml", crcLibsml, stream, len, repeat, false);
+    benchCrc("smlCrc16", crcIncremental, stream, len, repeat, true);
+    BENCH_PRINTF(benchJson ? "}}\n" : "\n");
+}
+
+// cross-check of SmlObisReader against libsml ------------------------------------------------
+#define CROSS_MAX_ENTRIES 32
+
+struct CrossCheck
+{
+    uint32_t frames;
+    uint32_t entries;
+    uint32_t mismatches;
+    uint32_t libsmlTicks;           // sml_file_parse() + sml_file_free()
+    uint32_t libsmlMallocs;
+    uint32_t readerTicks;           // SmlObisReader
+    uint32_t readerMallocs;
+};
+CrossCheck cross;
+SmlObisEntry crossExpected[CROSS_MAX_ENTRIES];
+SmlObisEntry crossActual[CROSS_MAX_ENTRIES];
+
+static bool sameEntry(const SmlObisEntry &a, const SmlObisEntry &b)
+{
+    return !memcmp(a.obis, b.obis, sizeof(a.obis)) && a.unit == b.unit && a.scaler == b.scaler && a.type == b.type &&
+           a.value == b.value && a.strLen == b.strLen && (a.strLen == 0 || !memcmp(a.str, b.str, a.strLen));
+}
+
+void crossCheckFrame(byte *buffer, size_t len, Sensor * /*sensor*/, State sensorState)
+{
+    if (sensorState != PROCESS_MESSAGE)
+    {
+        return;
+    }
+
+    // libsml: the entries point into the tree, i.e. compare before sml_file_free()
+    uint32_t mallocs = smlAllocStats.mallocs;
+    uint32_t start = smlProfileTicks();
+    sml_file *file = sml_file_parse(buffer + 8, len - 16);
+    uint32_t parseTicks = smlProfileTicks() - start;
+    size_t expected = 0;
+    for (int i = 0; i < file->messages_len; i++)
+    {
+        sml_message *message = file->messages[i];
+        if (*message->message_body->tag != SML_MESSAGE_GET_LIST_RESPONSE)
+        {
+            continue;
+        }
+        sml_get_list_response *body = (sml_get_list_response *)message->message_body->data;
+        for (sml_list *entry = body->val_list; entry != NULL && expected < CROSS_MAX_ENTRIES; entry = entry->next)
+        {
+            if (smlObisFromList(entry, &crossExpected[expected]))
+            {
+                expected++;
+            }
+        }
+    }
+
+    uint32_t readerMallocs = smlAllocStats.mallocs;
+    start = smlProfileTicks();
+    SmlObisReader reader(buffer + 8, len - 16);
+    size_t actual = 0;
+    while (actual < CROSS_MAX_ENTRIES && reader.next(&crossActual[actual]))
+    {
+        actual++;
+    }
+    cross.readerTicks += smlProfileTicks() - start;
+    cross.readerMallocs += smlAllocStats.mallocs - readerMallocs;
+
+    bool match = (actual == expected) && !reader.error();
+    for (size_t i = 0; match && i < actual; i++)
+    {
+        match = sameEntry(crossExpected[i], crossActual[i]);
+    }
+    if (!match)
+    {
+        cross.mismatches++;
+        BENCH_PRINTF("# cross-check frame %u: libsml %u entries, SmlObisReader %u entries%s\n", (unsigned)cross.frames,
+                     (unsigned)expected, (unsigned)actual, reader.error() ? " (error)" : "");
+        for (size_t i = 0; i < expected || i < actual; i++)
+        {
+            const SmlObisEntry *e = (i < expected) ? &crossExpected[i] : &crossActual[i];
+            const SmlObisEntry *a = (i < actual) ? &crossActual[i] : &crossExpected[i];
+            BENCH_PRINTF("#   %d-%d:%d.%d.%d*%d type %02X/%02X unit %u/%u scaler %d/%d value %lld/%lld%s\n",
+                         e->obis[0], e->obis[1], e->obis[2], e->obis[3], e->obis[4], e->obis[5], e->type, a->type,
+                         e->unit, a->unit, e->scaler, a->scaler, (long long)e->value, (long long)a->value,
+                         (i < expected && i < actual && sameEntry(*e, *a)) ? "" : "  <--");
+        }
+    }
+
+    start = smlProfileTicks();
+    sml_file_free(file);
+    cross.libsmlTicks += parseTicks + (smlProfileTicks() - start);
+    cross.libsmlMallocs += readerMallocs - mallocs;
+    cross.entries += expected;
+    cross.frames++;
+}
+
+void crossCheckBegin()
+{
+    memset(&cross, 0, sizeof(cross));
+}
+
+void crossCheckEnd()
+{
+    double frames = cross.frames ? cross.frames : 1;
+    BENCH_PRINTF(benchJson ? "{\"cross_check\":{\"frames\":%u,\"entries\":%u,\"mismatches\":%u,"
+                             "\"libsml_us\":%.3f,\"libsml_mallocs\":%.1f,\"reader_us\":%.3f,\"reader_mallocs\":%.1f}}\n"
+                           : "# cross-check: frames=%u entries=%u mismatches=%u\n"
+                             "# per frame: libsml_us=%.3f libsml_mallocs=%.1f reader_us=%.3f reader_mallocs=%.1f\n",
+                 (unsigned)cross.frames, (unsigned)cross.entries, (unsigned)cross.mismatches,
+                 cross.libsmlTicks / frames / SML_PROFILE_TICKS_PER_US, cross.libsmlMallocs / frames,
+                 cross.readerTicks / frames / SML_PROFILE_TICKS_PER_US, cross.readerMallocs / frames);
+}
+
+// backlog ------------------------------------------------------------------------------------
+void benchBacklog(SegmentStorage *storage, uint32_t records)
+{
+    SmlBacklog backlog(storage);
+    if (!backlog.begin())
+    {
+        BENCH_PRINTF("# backlog: no storage\n");
+        return;
+    }
+    // append: 3 channels as SmlHttp with the default channel table
+    double appendTicks = 0;
+    for (uint32_t i = 0; i < records; i++)
+    {
+        uint32_t start = smlProfileTicks();
+        backlog.add((uint8_t)(i % 3), 1676800000u + i / 3, 0, 12345670 + (int64_t)i * 1000);
+        appendTicks += (uint32_t)(smlProfileTicks() - start);
+    }
+    uint32_t start = smlProfileTicks();
+    backlog.flush();
+    appendTicks += (uint32_t)(smlProfileTicks() - start);
+    SmlBacklogStats appended = backlog.getStats();
+
+    // drain in batches
+    double drainTicks = 0;
+    uint32_t drained = 0;
+    uint32_t batches = 0;
+    SmlBacklogRecord batch[VZ_BATCH_TUPLES];
+    size_t n;
+    do
+    {
+        start = smlProfileTicks();
+        n = backlog.peek(batch, VZ_BATCH_TUPLES);
+        backlog.consume(n);
+        drainTicks += (uint32_t)(smlProfileTicks() - start);
+        drained += n;
+        batches += (n > 0) ? 1 : 0;
+    } while (n > 0);
+    const SmlBacklogStats &stats = backlog.getStats();
+
+    double appendS = appendTicks / SML_PROFILE_TICKS_PER_US / 1e6;
+    double drainS = drainTicks / SML_PROFILE_TICKS_PER_US / 1e6;
+    BENCH_PRINTF(benchJson ? "{\"backlog\":{\"records\":%u,\"appends\":%u,\"append_records_s\":%.0f,"
+                             "\"drained\":%u,\"batches\":%u,\"drain_records_s\":%.0f,\"dropped\":%u,"
+                             "\"bytes\":%u,\"program_bytes_append\":%u,\"program_bytes\":%u,"
+                             "\"amplification_append\":%.2f,\"amplification\":%.2f}}\n"
+                           : "# backlog: records=%u appends=%u append_records_s=%.0f\n"
+                             "# backlog: drained=%u batches=%u drain_records_s=%.0f dropped=%u\n"
+                             "# backlog: bytes=%u program_bytes_append=%u program_bytes=%u "
+                             "amplification_append=%.2f amplification=%.2f\n",
+                 (unsigned)appended.records, (unsigned)appended.appends, appendS > 0 ? appended.records / appendS : 0.,
+                 (unsigned)drained, (unsigned)batches, drainS > 0 ? drained / drainS : 0., (unsigned)stats.dropped,
+                 (unsigned)stats.bytes, (unsigned)appended.programBytes, (unsigned)stats.programBytes,
+                 stats.bytes ? (double)appended.programBytes / stats.bytes : 0.,
+                 stats.bytes ? (double)stats.programBytes / stats.bytes : 0.);
+}
+
+// derived power ------------------------------------------------------------------------------
+// the algorithm of SmlPowerDerivation in double, value * pow(10, scaler) as SmlHttp::publishEntry() of other channels
+class DoublePowerDerivation
+{
+public:
+    bool add(int64_t value, int8_t scaler, uint32_t frameMs, double *power)
+    {
+        double energy = (double)value * pow(10, scaler);
+        if (!_valid || energy < _last)
+        {
+            _valid = true;
+            _energy = energy;
+            _energyMs = frameMs;
+            _last = energy;
+            _step = pow(10, scaler);
+            _power = 0;
+            return false;
+        }
+        uint32_t dt = frameMs - _energyMs;
+        if (dt == 0)
+        {
+            return false;
+        }
+        if (energy != _last)
+        {
+            _last = energy;
+            if (dt < SML_DERIVE_MIN_MS)
+            {
+                return false;
+            }
+            _power = (energy - _energy) * 3600000. / dt;
+            _energy = energy;
+            _energyMs = frameMs;
+            *power = _power;
+            return true;
+        }
+        double limit = _step * 3600000. / dt;
+        if (limit < _power)
+        {
+            _power = limit;
+            *power = _power;
+            return true;
+        }
+        return false;
+    }
+
+private:
+    bool _valid = false;
+    double _energy = 0;
+    uint32_t _energyMs = 0;
+    double _last = 0;
+    double _step = 0;
+    double _power = 0;
+};
+
+void benchDerive(uint32_t readings)
+{
+    // simulated counter in 0.1 Wh: load steps between 0 and 3 kW every 5 min, one telegram per second
+    int64_t *counter = new int64_t[readings];
+    double energy = 1234567.8;
+    uint32_t seed = 1;
+    double load = 0;
+    for (uint32_t i = 0; i < readings; i++)
+    {
+        if (i % 300 == 0)
+        {
+            seed = seed * 1103515245u + 12345u;
+            load = (seed >> 16) % 3000;
+        }
+        energy += load / 3600.;
+        counter[i] = (int64_t)(energy * 10);
+    }
+
+    SmlPowerDerivation fixed;
+    DoublePowerDerivation floating;
+    uint32_t fixedTicks = 0;
+    uint32_t doubleTicks = 0;
+    uint32_t values = 0;
+    uint32_t differences = 0;
+    double maxDiff = 0;
+    double sum = 0;
+    for (uint32_t i = 0; i < readings; i++)
+    {
+        uint32_t frameMs = 1000 * i;
+        int64_t powerMw = 0;
+        double power = 0;
+        uint32_t start = smlProfileTicks();
+        bool fixedValue = fixed.add(counter[i], -1, frameMs, &powerMw);
+        fixedTicks += (uint32_t)(smlProfileTicks() - start);
+        start = smlProfileTicks();
+        bool doubleValue = floating.add(counter[i], -1, frameMs, &power);
+        doubleTicks += (uint32_t)(smlProfileTicks() - start);
+        if (fixedValue != doubleValue)
+        {
+            differences++;              // decay limit against the last power: the counter difference is not exact in double
+        }
+        else if (fixedValue)
+        {
+            double diff = fabs(powerMw * 0.001 - power);
+            maxDiff = (diff > maxDiff) ? diff : maxDiff;
+            sum += power;
+            values++;
+        }
+    }
+    delete[] counter;
+
+    double n = readings ? readings : 1;
+    BENCH_PRINTF(benchJson ? "{\"derive\":{\"readings\":%u,\"values\":%u,\"differences\":%u,\"max_diff_w\":%.6f,"
+                             "\"mean_w\":%.1f,\"fixed_us\":%.3f,\"double_us\":%.3f}}\n"
+                           : "# derive: readings=%u values=%u differences=%u max_diff_w=%.6f mean_w=%.1f\n"
+                             "# derive per reading: fixed_us=%.3f double_us=%.3f\n",
+                 (unsigned)readings, (unsigned)values, (unsigned)differences, maxDiff, values ? sum / values : 0.,
+                 fixedTicks / n / SML_PROFILE_TICKS_PER_US, doubleTicks / n / SML_PROFILE_TICKS_PER_US);
+}
+
+// value path -----------------------------------------------------------------------------------
+void benchValues(const byte *message, size_t len, uint32_t passes)
+{
+    SmlObisEntry entries[32];
+    size_t count = 0;
+    SmlObisReader reader(message, len);
+    while (count < sizeof(entries) / sizeof(entries[0]) && reader.next(&entries[count]))
+    {
+        if (entries[count].type == SML_TYPE_INTEGER || entries[count].type == SML_TYPE_UNSIGNED)
+        {
+            count++;
+        }
+    }
+    // factor of the channel: float in the EEPROM, scaled integer in SmlHttp
+    float factor = 1.0001f;
+    int64_t factorMantissa = 10001;
+    int8_t factorScaler = -4;
+    char doubleText[32];
+    char fixedText[32];
+    uint32_t doubleTicks = 0;
+    uint32_t fixedTicks = 0;
+    uint32_t differences = 0;
+    for (uint32_t pass = 0; pass < passes; pass++)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            const SmlObisEntry &entry = entries[i];
+            uint32_t start = smlProfileTicks();
+            double value = (double)entry.value * pow(10, entry.scaler) * factor;
+            snprintf(doubleText, sizeof(doubleText), "%.2f", value);
+            doubleTicks += (uint32_t)(smlProfileTicks() - start);
+
+            start = smlProfileTicks();
+            int64_t scaled = 0;
+            smlDecimalScale(entry.value, entry.scaler, SML_VALUE_DECIMALS, &scaled);
+            scaled = smlDecimalMultiply(scaled, factorMantissa, factorScaler);
+            smlDecimalFormat(fixedText, sizeof(fixedText), scaled, -SML_VALUE_DECIMALS, 2);
+            fixedTicks += (uint32_t)(smlProfileTicks() - start);
+            if (pass == 0 && strcmp(doubleText, fixedText) != 0)
+            {
+                differences++;
+            }
+        }
+    }
+    double n = (count && passes) ? (double)count * passes : 1;
+    BENCH_PRINTF(benchJson ? "{\"values\":{\"entries\":%u,\"passes\":%u,\"differences\":%u,"
+                             "\"double_ticks\":%.1f,\"fixed_ticks\":%.1f,\"double_us\":%.3f,\"fixed_us\":%.3f}}\n"
+                           : "# values: entries=%u passes=%u differences=%u\n"
+                             "# values per entry: double_ticks=%.1f fixed_ticks=%.1f double_us=%.3f fixed_us=%.3f\n",
+                 (unsigned)count, (unsigned)passes, (unsigned)differences, doubleTicks / n, fixedTicks / n,
+                 doubleTicks / n / SML_PROFILE_TICKS_PER_US, fixedTicks / n / SML_PROFILE_TICKS_PER_US);
+}
+
+// layout cache ---------------------------------------------------------------------------------
+#define BENCH_LAYOUT_VALUES 32
+
+void benchLayout(const byte *telegram, size_t len, uint32_t passes)
+{
+    byte *message = new byte[len];
+    memcpy(message, telegram, len);
+    // value bytes of the numeric entries, changed with each pass
+    byte *value[BENCH_LAYOUT_VALUES];
+    size_t count = 0;
+    SmlObisReader reader(message, len);
+    SmlObisEntry entry;
+    while (count < BENCH_LAYOUT_VALUES && reader.next(&entry))
+    {
+        if (entry.type == SML_TYPE_INTEGER || entry.type == SML_TYPE_UNSIGNED)
+        {
+            value[count++] = (byte *)reader.valueAt();
+        }
+    }
+    byte *scaler = (count > 0) ? value[count - 1] - 1 : NULL;     // scaler of the last numeric entry: 52 xx
+    const uint64_t keys[] = {smlObisKey(OBIS_ID_ENERGY_IN), smlObisKey(OBIS_ID_ENERGY_OUT), smlObisKey(OBIS_ID_POWER_IN)};
+
+    SmlHttp *cached = new SmlHttp();
+    SmlHttp *walked = new SmlHttp();
+    cached->init(benchHttpConfig);
+    cached->setTransport(&nullTransport);
+    cached->setLayoutCache(true);
+    walked->init(benchHttpConfig);
+    walked->setTransport(&nullTransport);
+    walked->setLayoutCache(false);
+    uint32_t cachedParse = 0;       // PROFILE_PARSE: match() or the walk
+    uint32_t cachedTicks = 0;       // publish()
+    uint32_t walkedParse = 0;
+    uint32_t walkedTicks = 0;
+    uint32_t differences = 0;
+    for (uint32_t pass = 0; pass < passes; pass++)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            size_t n = (value[i][0] & 0x0F) - 1;
+            value[i][n] = (byte)(pass * 7 + i);
+            value[i][(n > 1) ? n - 1 : n] ^= (byte)(pass >> 3);
+        }
+        if (scaler != NULL && scaler[-1] == 0x52)
+        {
+            scaler[0] = (pass % 50 == 49) ? 0xFE : 0xFF;
+        }
+        smlProfileReset();
+        uint32_t start = smlProfileTicks();
+        cached->publish(NULL, message, len);
+        cachedTicks += smlProfileTicks() - start;
+        cachedParse += smlProfile[PROFILE_PARSE].ticks;
+        smlProfileReset();
+        start = smlProfileTicks();
+        walked->publish(NULL, message, len);
+        walkedTicks += smlProfileTicks() - start;
+        walkedParse += smlProfile[PROFILE_PARSE].ticks;
+        for (size_t k = 0; k < sizeof(keys) / sizeof(keys[0]); k++)
+        {
+            if (cached->getObisValue(keys[k]) != walked->getObisValue(keys[k]))
+            {
+                differences++;
+                break;
+            }
+        }
+    }
+    const SmlLayoutStats &stats = cached->getLayoutStats(0);
+    double n = passes ? passes : 1;
+    BENCH_PRINTF(benchJson ? "{\"layout\":{\"passes\":%u,\"values\":%u,\"hits\":%u,\"misses\":%u,\"learned\":%u,"
+                             "\"differences\":%u,\"cached_parse_us\":%.3f,\"walked_parse_us\":%.3f,"
+                             "\"cached_us\":%.3f,\"walked_us\":%.3f}}\n"
+                           : "# layout: passes=%u values=%u hits=%u misses=%u learned=%u differences=%u\n"
+                             "# layout per telegram: cached_parse_us=%.3f walked_parse_us=%.3f cached_us=%.3f walked_us=%.3f\n",
+                 (unsigned)passes, (unsigned)count, (unsigned)stats.hits, (unsigned)stats.misses,
+                 (unsigned)stats.learned, (unsigned)differences, cachedParse / n / SML_PROFILE_TICKS_PER_US,
+                 walkedParse / n / SML_PROFILE_TICKS_PER_US, cachedTicks / n / SML_PROFILE_TICKS_PER_US,
+                 walkedTicks / n / SML_PROFILE_TICKS_PER_US);
+    delete cached;
+    delete walked;
+    delete[] message;
+}
+
+// parse arena --------------------------------------------------------------------------------
+#define BENCH_ARENA_KEEP 3          // telegrams a block allocated during the processing lives
+
+struct ArenaMode
+{
+    uint32_t frames;
+    uint32_t heapMallocs;           // allocations on the heap by parse and free
+    uint32_t parseTicks;
+    uint32_t freeTicks;
+    uint8_t peakFragmentation;
+};
+ArenaMode arenaMode;
+bool arenaOn = false;
+void *arenaKeep[BENCH_ARENA_KEEP];
+
+static uint8_t benchHeapFragmentation()
+{
+#ifdef ARDUINO
+    return ESP.getHeapFragmentation();
+#else
+    struct mallinfo2 info = mallinfo2();
+    return info.fordblks ? (uint8_t)((info.fordblks - info.keepcost) * 100 / info.fordblks) : 0;
+#endif
+}
+
+void arenaFrame(byte *buffer, size_t len, Sensor * /*sensor*/, State sensorState)
+{
+    if (sensorState != PROCESS_MESSAGE)
+    {
+        return;
+    }
+    uint32_t mallocs = smlAllocStats.mallocs;
+    uint32_t start = smlProfileTicks();
+    sml_file *file = arenaOn ? smlFileParse(buffer + 8, len - 16) : sml_file_parse(buffer + 8, len - 16);
+    arenaMode.parseTicks += smlProfileTicks() - start;
+    arenaMode.heapMallocs += smlAllocStats.mallocs - mallocs;
+
+    // processing between parse and free
+    size_t slot = arenaMode.frames % BENCH_ARENA_KEEP;
+    free(arenaKeep[slot]);
+    arenaKeep[slot] = malloc(16 + (arenaMode.frames * 37) % 200);
+
+    mallocs = smlAllocStats.mallocs;
+    start = smlProfileTicks();
+    if (arenaOn)
+    {
+        smlFileFree(file);
+    }
+    else
+    {
+        sml_file_free(file);
+    }
+    arenaMode.freeTicks += smlProfileTicks() - start;
+    arenaMode.heapMallocs += smlAllocStats.mallocs - mallocs;
+    uint8_t fragmentation = benchHeapFragmentation();
+    arenaMode.peakFragmentation = (fragmentation > arenaMode.peakFragmentation) ? fragmentation : arenaMode.peakFragmentation;
+    arenaMode.frames++;
+}
+
+void benchArenaMode(const char *name, const char *capture, uint32_t frames, bool arena, bool last)
+{
+    memset(&arenaMode, 0, sizeof(arenaMode));
+    arenaOn = arena;
+#ifndef ARDUINO
+    if (capture != NULL)
+    {
+        Clock *systemClock = halClock();
+        SmlReplay *replay = new SmlReplay(0.0);
+        if (!replay->load(capture))
+        {
+            fprintf(stderr, "%s: no replay data\n", capture);
+        }
+        halSetClock(replay);
+        benchSensorRun(replay, arenaFrame);
+        halSetClock(systemClock);
+    }
+    else
+#endif
+    {
+        benchSensorRun(new TelegramByteSource(frames), arenaFrame);
+    }
+    uint8_t fragmentation = benchHeapFragmentation();
+    for (size_t i = 0; i < BENCH_ARENA_KEEP; i++)
+    {
+        free(arenaKeep[i]);
+        arenaKeep[i] = NULL;
+    }
+    double n = arenaMode.frames ? arenaMode.frames : 1;
+    BENCH_PRINTF(benchJson ? "\"%s\":{\"frames\":%u,\"heap_mallocs\":%.1f,\"parse_us\":%.3f,\"free_us\":%.3f,"
+                             "\"fragmentation\":%u,\"peak_fragmentation\":%u}%s"
+                           : "# arena %s: frames=%u heap_mallocs=%.1f parse_us=%.3f free_us=%.3f fragmentation=%u%% "
+                             "peak_fragmentation=%u%%\n%s",
+                 name, (unsigned)arenaMode.frames, arenaMode.heapMallocs / n,
+                 arenaMode.parseTicks / n / SML_PROFILE_TICKS_PER_US, arenaMode.freeTicks / n / SML_PROFILE_TICKS_PER_US,
+                 (unsigned)fragmentation, (unsigned)arenaMode.peakFragmentation, (benchJson && !last) ? "," : "");
+}
+
+void benchArena(const char *capture, uint32_t frames)
+{
+    BENCH_PRINTF(benchJson ? "{\"arena\":{" : "");
+    benchArenaMode("arena", capture, frames, true, false);
+    benchArenaMode("heap", capture, frames, false, false);
+    const SmlArenaStats &stats = smlParseArena()->getStats();
+    BENCH_PRINTF(benchJson ? "\"size\":%u,\"peak_bytes\":%u,\"allocs\":%u,\"spills\":%u}}\n"
+                           : "# arena: size=%u peak_bytes=%u allocs=%u spills=%u\n",
+                 (unsigned)SML_PARSE_ARENA_SIZE, (unsigned)stats.peakBytes, (unsigned)stats.allocs, (unsigned)stats.spills);
+}
+
+// push decoder -------------------------------------------------------------------------------
+#define BENCH_BAUD 9600             // of the meter, 10 bits per byte
+#define BENCH_DECODE_BLOCK 16       // bytes received per loop(), about 17 ms at BENCH_BAUD
+
+struct DecodeMode
+{
+    uint32_t frames;
+    uint32_t decoded;               // telegrams with entries decoded during the reception
+    uint32_t differences;           // telegrams with other channel values than the walk
+    uint32_t powerFrames;           // telegrams with OBIS_ID_POWER_IN decoded during the reception
+    uint32_t powerLead;             // bytes of these telegrams received after the power entry
+    uint32_t processTicks;          // publish() of the received telegram
+};
+DecodeMode decodeMode;
+SmlHttp *decodeHttp = NULL;         // publish() of the processing
+SmlHttp *walkHttp = NULL;           // complete walk, for comparison
+
+void decodeFrame(byte *buffer, size_t len, Sensor *sensor, State sensorState)
+{
+    if (sensorState != PROCESS_MESSAGE)
+    {
+        return;
+    }
+    const SmlObisStream *entries = sensor->frameEntries();
+    if (entries->committed())
+    {
+        decodeMode.decoded++;
+        for (uint8_t i = 0; i < entries->count(); i++)
+        {
+            SmlObisEntry entry;
+            entries->entry(buffer + 8, i, &entry);
+            if (smlObisKey(entry.obis) == smlObisKey(OBIS_ID_POWER_IN))
+            {
+                decodeMode.powerFrames++;
+                decodeMode.powerLead += len - 8 - entries->decodedAt(i);
+            }
+        }
+    }
+    uint32_t start = smlProfileTicks();
+    decodeHttp->publish(sensor, buffer + 8, len - 16);
+    decodeMode.processTicks += smlProfileTicks() - start;
+    walkHttp->publish(NULL, buffer + 8, len - 16);
+    const uint64_t keys[] = {smlObisKey(OBIS_ID_ENERGY_IN), smlObisKey(OBIS_ID_ENERGY_OUT), smlObisKey(OBIS_ID_POWER_IN)};
+    for (size_t k = 0; k < sizeof(keys) / sizeof(keys[0]); k++)
+    {
+        if (decodeHttp->getObisValue(keys[k]) != walkHttp->getObisValue(keys[k]))
+        {
+            decodeMode.differences++;
+            break;
+        }
+    }
+    decodeMode.frames++;
+}
+
+void benchDecodeMode(const char *name, const char *capture, uint32_t frames, bool decode, bool last)
+{
+    memset(&decodeMode, 0, sizeof(decodeMode));
+    decodeHttp = new SmlHttp();
+    walkHttp = new SmlHttp();
+    decodeHttp->init(benchHttpConfig);
+    decodeHttp->setTransport(&nullTransport);
+    decodeHttp->setLayoutCache(false);
+    walkHttp->init(benchHttpConfig);
+    walkHttp->setTransport(&nullTransport);
+    walkHttp->setLayoutCache(false);
+    smlProfileReset();
+#ifndef ARDUINO
+    if (capture != NULL)
+    {
+        Clock *systemClock = halClock();
+        SmlReplay *replay = new SmlReplay(0.0);
+        if (!replay->load(capture))
+        {
+            fprintf(stderr, "%s: no replay data\n", capture);
+        }
+        halSetClock(replay);
+        benchSensorRun(replay, decodeFrame, NULL, decode);
+        halSetClock(systemClock);
+    }
+    else
+#endif
+    {
+        benchSensorRun(new TelegramByteSource(frames, BENCH_DECODE_BLOCK), decodeFrame, NULL, decode);
+    }
+    double n = decodeMode.frames ? decodeMode.frames : 1;
+    double lead = decodeMode.powerFrames ? (double)decodeMode.powerLead / decodeMode.powerFrames : 0;
+    BENCH_PRINTF(benchJson ? "\"%s\":{\"frames\":%u,\"decoded\":%u,\"differences\":%u,\"reception_us\":%.3f,"
+                             "\"processing_us\":%.3f,\"power_lead_bytes\":%.1f,\"power_lead_ms\":%.1f}%s"
+                           : "# decode %s: frames=%u decoded=%u differences=%u reception_us=%.3f processing_us=%.3f "
+                             "power_lead_bytes=%.1f power_lead_ms=%.1f\n%s",
+                 name, (unsigned)decodeMode.frames, (unsigned)decodeMode.decoded, (unsigned)decodeMode.differences,
+                 smlProfile[PROFILE_END_SEARCH].ticks / n / SML_PROFILE_TICKS_PER_US,
+                 decodeMode.processTicks / n / SML_PROFILE_TICKS_PER_US, lead, lead * 10000 / BENCH_BAUD,
+                 (benchJson && !last) ? "," : "");
+    delete decodeHttp;
+    delete walkHttp;
+    decodeHttp = NULL;
+    walkHttp = NULL;
+}
+
+void benchDecode(const char *capture, uint32_t frames)
+{
+    BENCH_PRINTF(benchJson ? "{\"decode\":{" : "");
+    benchDecodeMode("stream", capture, frames, true, false);
+    benchDecodeMode("walk", capture, frames, false, true);
+    BENCH_PRINTF(benchJson ? "}}\n" : "");
+}
+
+#ifndef ARDUINO
+// http latency -------------------------------------------------------------------------------
+// latency: post until the response is received; call: longest post() or loop() call, i.e. the blocking of loop()
+void benchHttpMode(const char *name, HttpTransport *transport, const char *url, uint32_t posts, bool last)
+{
+    BenchColumn latency;
+    double maxCall = 0;
+    uint32_t failures = 0;
+    char body[sizeOfUUID + 80];
+    for (uint32_t i = 0; i < posts; i++)
+    {
+        snprintf(body, sizeof(body), "uuid=%s&ts=%u000&value=%.2f", VZ_UUID_POWER_IN, 1676800000u + i, 100. + i);
+        uint64_t start = hostMicros();
+        uint64_t call = start;
+        if (transport->post(url, "application/x-www-form-urlencoded", body) < 0)
+        {
+            failures++;
+        }
+        while (true)
+        {
+            uint64_t now = hostMicros();
+            maxCall = (now - call > maxCall) ? now - call : maxCall;
+            if (!transport->busy())
+            {
+                break;
+            }
+            call = now;
+            transport->loop();
+        }
+        latency.add((double)(hostMicros() - start));
+    }
+    failures += transport->stats.failures;
+    BENCH_PRINTF(benchJson ? "\"%s\":{\"posts\":%u,\"failures\":%u,\"connects\":%u,"
+                             "\"mean_us\":%.1f,\"min_us\":%.1f,\"max_us\":%.1f,\"max_call_us\":%.1f}%s"
+                           : "# http %s: posts=%u failures=%u connects=%u mean_us=%.1f min_us=%.1f max_us=%.1f max_call_us=%.1f%s",
+                 name, (unsigned)posts, (unsigned)failures, (unsigned)transport->stats.connects,
+                 posts ? latency.sum / posts : 0., posts ? latency.min : 0., latency.max, maxCall,
+                 last ? "" : (benchJson ? "," : "\n"));
+}
+
+// several meters ----------------------------------------------------------------------------
+#define BENCH_SERIAL_BUFFER 128     // SENSOR_SERIAL_BUFFER_SIZE of halArduino.cpp
+
+SmlReplayClock *meterClock = NULL;
+uint32_t meterProcessMs = 0;
+uint32_t meterFrames[SML_METERS_MAX];
+
+// replay of frames telegrams of meter on clock into a serial buffer of BENCH_SERIAL_BUFFER bytes: interval
+// 1000 ms + 13 ms * meter, first telegram after 250 ms * meter
+SmlReplay *benchMeterReplay(SmlReplayClock *clock, uint8_t meter, uint32_t frames, const byte *telegram, size_t len)
+{
+    SmlReplay *replay = new SmlReplay(clock);
+    replay->setCapacity(BENCH_SERIAL_BUFFER);
+    for (uint32_t frame = 0; frame < frames; frame++)
+    {
+        replay->append(250000ULL * meter + (1000000ULL + 13000ULL * meter) * frame, telegram, len);
+    }
+    return replay;
+}
+
+// processing of a telegram on the device, modelled as time of the replay clock
+void meterFrame(byte * /*buffer*/, size_t /*len*/, Sensor *sensor, State sensorState)
+{
+    if (sensorState == PROCESS_MESSAGE)
+    {
+        meterFrames[sensor->meter]++;
+        meterClock->spend(meterProcessMs);
+    }
+}
+
+// telegrams received, bytes lost and ring buffer peak of all meters; scheduler or the former loop over the sensors
+void benchMeterMode(const char *name, uint8_t meters, uint32_t frames, uint32_t processMs, bool scheduled, bool last)
+{
+    SmlReplayClock clock(0);
+    meterClock = &clock;
+    meterProcessMs = processMs;
+    Clock *systemClock = halClock();
+    halSetClock(&clock);
+    SmlReplay *replay[SML_METERS_MAX];
+    SmlScheduler scheduler;
+    for (uint8_t i = 0; i < meters; i++)
+    {
+        replay[i] = benchMeterReplay(&clock, i, frames, SML_BENCH_TELEGRAM, sizeof(SML_BENCH_TELEGRAM));
+        meterFrames[i] = 0;
+        scheduler.add(new Sensor(&benchSensorConfig, replay[i], meterFrame));
+    }
+    clock.rewind();
+
+    bool finished = false;
+    while (!finished || scheduler.pending())
+    {
+        if (scheduled)
+        {
+            scheduler.loop();
+        }
+        else
+        {
+            for (uint8_t i = 0; i < meters; i++)
+            {
+                scheduler.sensor(i)->loop();
+            }
+        }
+        clock.step();
+        finished = true;
+        for (uint8_t i = 0; i < meters; i++)
+        {
+            finished = finished && replay[i]->finished();
+        }
+    }
+
+    uint32_t received = 0;
+    uint32_t lost = 0;
+    uint32_t peak = 0;
+    for (uint8_t i = 0; i < meters; i++)
+    {
+        received += meterFrames[i];
+        lost += replay[i]->lostBytes();
+        peak = (scheduler.sensor(i)->stats.ringPeak > peak) ? scheduler.sensor(i)->stats.ringPeak : peak;
+        delete scheduler.sensor(i);
+    }
+    halSetClock(systemClock);
+    BENCH_PRINTF(benchJson ? "{\"mode\":\"%s\",\"process_ms\":%u,\"frames\":%u,\"received\":%u,\"lost_bytes\":%u,"
+                             "\"ring_peak\":%u}%s"
+                           : "# meters %s: process_ms=%u frames=%u received=%u lost_bytes=%u ring_peak=%u%s",
+                 name, (unsigned)processMs, (unsigned)(frames * meters), (unsigned)received, (unsigned)lost,
+                 (unsigned)peak, last ? "" : (benchJson ? "," : "\n"));
+}
+
+void benchMeters(uint8_t meters, uint32_t frames)
+{
+    static const uint32_t processMs[] = {20, 40, 80, 120, 160};
+    BENCH_PRINTF(benchJson ? "{\"meters\":{\"meters\":%u,\"serial_buffer\":%u,\"modes\":["
+                           : "# meters: %u meters, SoftwareSerial buffer %u bytes\n",
+                 (unsigned)meters, (unsigned)BENCH_SERIAL_BUFFER);
+    for (size_t i = 0; i < sizeof(processMs) / sizeof(processMs[0]); i++)
+    {
+        benchMeterMode("scheduler", meters, frames, processMs[i], true, false);
+        benchMeterMode("sensor_loop", meters, frames, processMs[i], false, i + 1 == sizeof(processMs) / sizeof(processMs[0]));
+    }
+    BENCH_PRINTF(benchJson ? "]}}\n" : "\n");
+}
+
+// frame handoff ------------------------------------------------------------------------------
+#define BENCH_POST_MS 100           // one blocking http post of the processing
+
+bool handoffReceive = false;
+uint32_t handoffLongMs = 0;
+uint32_t handoffFrame = 0;
+
+// processing of a telegram: blocking posts, the reception or the input only between the posts
+void handoffFrameCallback(byte * /*buffer*/, size_t /*len*/, Sensor *sensor, State sensorState)
+{
+    if (sensorState != PROCESS_MESSAGE)
+    {
+        return;
+    }
+    uint32_t processMs = (++handoffFrame % 5 == 0) ? handoffLongMs : BENCH_POST_MS;
+    for (uint32_t ms = 0; ms < processMs; ms += BENCH_POST_MS)
+    {
+        meterClock->spend(BENCH_POST_MS);
+        if (handoffReceive)
+        {
+            sensor->receive();
+        }
+        else
+        {
+            sensor->pump();
+        }
+    }
+}
+
+void benchHandoffMode(const char *name, uint32_t frames, uint32_t longMs, bool receive, bool last)
+{
+    SmlReplayClock clock(0);
+    meterClock = &clock;
+    handoffReceive = receive;
+    handoffLongMs = longMs;
+    handoffFrame = 0;
+    Clock *systemClock = halClock();
+    halSetClock(&clock);
+    SmlReplay *replay = benchMeterReplay(&clock, 0, frames, SML_BENCH_TELEGRAM, sizeof(SML_BENCH_TELEGRAM));
+    Sensor *sensor = new Sensor(&benchSensorConfig, replay, handoffFrameCallback);
+    clock.rewind();
+    while (!replay->finished() || sensor->pending())
+    {
+        sensor->loop();
+        clock.step();
+    }
+
+    const SensorStats &stats = sensor->stats;
+    BENCH_PRINTF(benchJson ? "{\"mode\":\"%s\",\"long_ms\":%u,\"frames\":%u,\"received\":%u,\"processed\":%u,"
+                             "\"dropped\":%u,\"errors\":%u,\"lost_bytes\":%u}%s"
+                           : "# handoff %s: long_ms=%u frames=%u received=%u processed=%u dropped=%u errors=%u "
+                             "lost_bytes=%u%s",
+                 name, (unsigned)longMs, (unsigned)frames, (unsigned)stats.framesReceived,
+                 (unsigned)stats.framesProcessed, (unsigned)stats.framesDropped,
+                 (unsigned)(stats.framingErrors + stats.crcErrors), (unsigned)replay->lostBytes(),
+                 last ? "" : (benchJson ? "," : "\n"));
+    delete sensor;
+    halSetClock(systemClock);
+}
+
+void benchHandoff(uint32_t frames)
+{
+    static const uint32_t longMs[] = {1000, 2000, 4000, 5000, 8000};
+    BENCH_PRINTF(benchJson ? "{\"handoff\":{\"frame_buffers\":%u,\"serial_buffer\":%u,\"post_ms\":%u,\"modes\":["
+                           : "# handoff: %u frame buffers, SoftwareSerial buffer %u bytes, posts of %u ms\n",
+                 (unsigned)SENSOR_FRAME_BUFFERS, (unsigned)BENCH_SERIAL_BUFFER, (unsigned)BENCH_POST_MS);
+    for (size_t i = 0; i < sizeof(longMs) / sizeof(longMs[0]); i++)
+    {
+        benchHandoffMode("receive", frames, longMs[i], true, false);
+        benchHandoffMode("pump", frames, longMs[i], false, i + 1 == sizeof(longMs) / sizeof(longMs[0]));
+    }
+    BENCH_PRINTF(benchJson ? "]}}\n" : "\n");
+}
+
+// frame pool ---------------------------------------------------------------------------------
+SmlScheduler *poolScheduler = NULL;
+
+// start sequence, payload without escape sequences, fill bytes, end sequence, number of fill bytes, CRC
+size_t benchSyntheticTelegram(byte *telegram, size_t payload)
+{
+    size_t len = 0;
+    memcpy(telegram, START_SEQUENCE, sizeof(START_SEQUENCE));
+    len += sizeof(START_SEQUENCE);
+    for (size_t i = 0; i < payload; i++)
+    {
+        byte value = (byte)(i * 7 + 1);
+        telegram[len++] = (value == 0x1B) ? 0x1C : value;
+    }
+    uint8_t fill = (4 - payload % 4) % 4;
+    memset(telegram + len, 0, fill);
+    len += fill;
+    memcpy(telegram + len, END_SEQUENCE, sizeof(END_SEQUENCE));
+    len += sizeof(END_SEQUENCE);
+    telegram[len++] = fill;
+    uint16_t crc = smlCrc16(telegram, len);
+    telegram[len++] = (byte)crc;
+    telegram[len++] = (byte)(crc >> 8);
+    return len;
+}
+
+// processing of a telegram: two posts, the reception of all sensors in between
+void poolFrame(byte * /*buffer*/, size_t /*len*/, Sensor * /*sensor*/, State sensorState)
+{
+    if (sensorState == PROCESS_MESSAGE)
+    {
+        for (uint8_t post = 0; post < 2; post++)
+        {
+            meterClock->spend(BENCH_POST_MS);
+            poolScheduler->receive();
+        }
+    }
+}
+
+void benchPool(uint32_t frames)
+{
+    static const size_t payload[] = {284, 436, 1584};       // telegrams of 300, 452 and 1600 bytes
+    const uint8_t meters = sizeof(payload) / sizeof(payload[0]);
+    SmlReplayClock clock(0);
+    meterClock = &clock;
+    Clock *systemClock = halClock();
+    halSetClock(&clock);
+    SmlReplay *replay[meters];
+    SmlScheduler scheduler;
+    poolScheduler = &scheduler;
+    byte *telegram = new byte[BUFFER_SIZE];
+    for (uint8_t i = 0; i < meters; i++)
+    {
+        size_t len = benchSyntheticTelegram(telegram, payload[i]);
+        replay[i] = benchMeterReplay(&clock, i, frames, telegram, len);
+        scheduler.add(new Sensor(&benchSensorConfig, replay[i], poolFrame));
+    }
+    delete[] telegram;
+    clock.rewind();
+
+    bool finished = false;
+    while (!finished || scheduler.pending())
+    {
+        scheduler.loop();
+        clock.step();
+        finished = true;
+        for (uint8_t i = 0; i < meters; i++)
+        {
+            finished = finished && replay[i]->finished();
+        }
+    }
+
+    uint32_t received = 0;
+    uint32_t dropped = 0;
+    uint32_t frameMax[meters];
+    for (uint8_t i = 0; i < meters; i++)
+    {
+        received += scheduler.sensor(i)->stats.framesReceived;
+        dropped += scheduler.sensor(i)->stats.framesDropped;
+        frameMax[i] = scheduler.sensor(i)->stats.frameMax;
+        delete scheduler.sensor(i);
+    }
+    halSetClock(systemClock);
+    uint32_t before = meters * SENSOR_FRAME_BUFFERS * BUFFER_SIZE;
+    uint32_t sensorHeap = sizeof(Sensor);       // new Sensor, formerly with the frame buffers embedded
+    const SmlFramePoolStats &pool = smlFramePool()->getStats();
+    BENCH_PRINTF(benchJson ? "{\"pool\":{\"meters\":%u,\"frame_bytes_before\":%u,\"frame_bytes_after\":%u,\"saved\":%u,"
+                             "\"sensor_heap_before\":%u,\"sensor_heap_after\":%u,\"frames\":%u,\"received\":%u,"
+                             "\"dropped\":%u,\"peak_bytes\":%u,\"peak_fragmentation\":%u,\"allocs\":%u,\"grows\":%u,"
+                             "\"moves\":%u,\"failures\":%u,\"frame_max\":[%u,%u,%u]}}\n"
+                           : "# frame pool: %u meters, frame buffers %u bytes before, %u bytes after, %u bytes saved\n"
+                             "# frame pool: heap per Sensor %u bytes before, %u bytes after\n"
+                             "# frame pool: frames=%u received=%u dropped=%u peak_bytes=%u peak_fragmentation=%u%% "
+                             "allocs=%u grows=%u moves=%u failures=%u frame_max=%u,%u,%u\n\n",
+                 (unsigned)meters, (unsigned)before, (unsigned)SML_FRAME_POOL_SIZE,
+                 (unsigned)(before > SML_FRAME_POOL_SIZE ? before - SML_FRAME_POOL_SIZE : 0),
+                 (unsigned)(sensorHeap + SENSOR_FRAME_BUFFERS * BUFFER_SIZE), (unsigned)sensorHeap,
+                 (unsigned)(frames * meters), (unsigned)received, (unsigned)dropped, (unsigned)pool.peakBytes,
+                 (unsigned)pool.peakFragmentation, (unsigned)pool.allocs, (unsigned)pool.grows, (unsigned)pool.moves,
+                 (unsigned)pool.failures, (unsigned)frameMax[0], (unsigned)frameMax[1], (unsigned)frameMax[2]);
+}
+
+void benchHttpLatency(const char *url, uint32_t posts)
+{
+    BENCH_PRINTF(benchJson ? "{\"http\":{" : "# http latency: %s\n", url);
+    SocketHttpTransport close;
+    close.setKeepAlive(false);
+    close.setResolveOnce(false);
+    benchHttpMode("close", &close, url, posts, false);
+    SocketHttpTransport keepAlive;
+    benchHttpMode("keep_alive", &keepAlive, url, posts, false);
+    SocketTcpConnection connection;
+    AsyncHttpTransport async(&connection);
+    benchHttpMode("async", &async, url, posts, true);
+    BENCH_PRINTF(benchJson ? "}}\n" : "\n");
+}
+#endif
+
+#ifdef ARDUINO
+void setup()
+{
+    Serial.begin(115200);
+    delay(2000);
+    Serial.println();
+
+    benchJson = false;
+    benchSensorRun(new TelegramByteSource(SML_BENCH_FRAMES), benchFrame, benchBegin);
+    benchEnd();
+    const SmlFramePoolStats &pool = smlFramePool()->getStats();
+    BENCH_PRINTF("# heap: free=%u max_block=%u fragmentation=%u%%, sizeof(Sensor)=%u\n"
+                 "# frame pool: %u bytes, peak_bytes=%u peak_fragmentation=%u%%\n\n",
+                 (unsigned)ESP.getFreeHeap(), (unsigned)ESP.getMaxFreeBlockSize(), (unsigned)ESP.getHeapFragmentation(),
+                 (unsigned)sizeof(Sensor), (unsigned)SML_FRAME_POOL_SIZE, (unsigned)pool.peakBytes,
+                 (unsigned)pool.peakFragmentation);
+
+    byte *stream = new byte[sizeof(SML_BENCH_TELEGRAM)];
+    memcpy_P(stream, SML_BENCH_TELEGRAM, sizeof(SML_BENCH_TELEGRAM));
+    benchStream(stream, sizeof(SML_BENCH_TELEGRAM));
+    delete[] stream;
+
+    benchSensorRun(new TelegramByteSource(100), crossCheckFrame, crossCheckBegin);
+    crossCheckEnd();
+
+    benchBacklog(halSegmentStorage(), SML_BENCH_BACKLOG);
+    benchDerive(SML_BENCH_DERIVE);
+
+    stream = new byte[sizeof(SML_BENCH_TELEGRAM)];
+    memcpy_P(stream, SML_BENCH_TELEGRAM, sizeof(SML_BENCH_TELEGRAM));
+    benchValues(stream + 8, sizeof(SML_BENCH_TELEGRAM) - 16, 100);
+    benchLayout(stream + 8, sizeof(SML_BENCH_TELEGRAM) - 16, 1000);
+    delete[] stream;
+    benchArena(NULL, SML_BENCH_FRAMES);
+    benchDecode(NULL, SML_BENCH_FRAMES);
+}
+
+void loop()
+{
+    delay(1000);
+}
+
+#else
+int main(int argc, char **argv)
+{
+    uint32_t frames = SML_BENCH_FRAMES;
+    bool framing = false;
+    bool crossCheck = false;
+    const char *httpUrl = NULL;
+    const char *backlogDir = NULL;
+    bool derive = false;
+    bool values = false;
+    uint8_t meters = 0;
+    bool handoff = false;
+    bool pool = false;
+    bool layout = false;
+    bool arena = false;
+    bool decode = false;
+    int opt;
+    while ((opt = getopt(argc, argv, "f:n:sxdvm:ogcaep:l:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'f':
+            benchJson = !strcmp(optarg, "json");
+            break;
+        case 'n':
+            frames = (uint32_t)atol(optarg);
+            break;
+        case 's':
+            framing = true;
+            break;
+        case 'x':
+            crossCheck = true;
+            break;
+        case 'p':
+            httpUrl = optarg;
+            break;
+        case 'l':
+            backlogDir = optarg;
+            break;
+        case 'd':
+            derive = true;
+            break;
+        case 'v':
+            values = true;
+            break;
+        case 'm':
+            meters = (uint8_t)atoi(optarg);
+            break;
+        case 'o':
+            handoff = true;
+            break;
+        case 'g':
+            pool = true;
+            break;
+        case 'c':
+            layout = true;
+            break;
+        case 'a':
+            arena = true;
+            break;
+        case 'e':
+            decode = true;
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-f csv|json] [-n frames] [-s|-x|-d|-v|-m meters|-o|-g|-c|-a|-e|-p url|-l dir] [capture]\n",
+                    argv[0]);
+            return 1;
+        }
+    }
+    if (httpUrl != NULL)
+    {
+        benchHttpLatency(httpUrl, frames);
+        return 0;
+    }
+    if (backlogDir != NULL)
+    {
+        DirectorySegmentStorage storage(backlogDir);
+        benchBacklog(&storage, frames);
+        return 0;
+    }
+    if (derive)
+    {
+        benchDerive(frames);
+        return 0;
+    }
+    if (values)
+    {
+        benchValues(SML_BENCH_TELEGRAM + 8, sizeof(SML_BENCH_TELEGRAM) - 16, frames);
+        return 0;
+    }
+    if (meters > 0)
+    {
+        if (meters < 2 || meters > SML_METERS_MAX)
+        {
+            fprintf(stderr, "-m: 2 to %d meters\n", SML_METERS_MAX);
+            return 1;
+        }
+        benchMeters(meters, frames);
+        return 0;
+    }
+    if (handoff)
+    {
+        benchHandoff(frames);
+        return 0;
+    }
+    if (pool)
+    {
+        benchPool(frames);
+        return 0;
+    }
+    if (arena)
+    {
+        benchArena((optind < argc) ? argv[optind] : NULL, frames);
+        return 0;
+    }
+    if (decode)
+    {
+        benchDecode((optind < argc) ? argv[optind] : NULL, frames);
+        return 0;
+    }
+    if (layout)
+    {
+        benchLayout(SML_BENCH_TELEGRAM + 8, sizeof(SML_BENCH_TELEGRAM) - 16, frames);
+        return 0;
+    }
+
+    void (*frameCallback)(byte *buffer, size_t len, Sensor *sensor, State sensorState) = crossCheck ? crossCheckFrame : benchFrame;
+    void (*begin)() = crossCheck ? crossCheckBegin : benchBegin;
+    void (*end)() = crossCheck ? crossCheckEnd : benchEnd;
+    if (optind < argc)
+    {
+        SmlReplay *replay = new SmlReplay(0.0);
+        if (!replay->load(argv[optind]))
+        {
+            fprintf(stderr, "%s: no replay data\n", argv[optind]);
+            return 1;
+        }
+        if (framing)
+        {
+            benchStream(replay->data(), replay->size());
+            return 0;
+        }
+        halSetClock(replay);
+        benchSensorRun(replay, frameCallback, begin);
+        end();
+    }
+    else if (framing)
+    {
+        benchStream(SML_BENCH_TELEGRAM, sizeof(SML_BENCH_TELEGRAM));
+    }
+    else
+    {
+        benchSensorRun(new TelegramByteSource(frames), frameCallback, begin);
+        end();
+    }
+    return 0;
+}
+#endif  // ARDUINO
+#endif  // SML_BENCH
@@ -0,0 +1,28 @@
+#ifndef SML_BENCH_DATA_H
+#define SML_BENCH_DATA_H
+
+#include "hal.h"
+
+// Synthetic telegram of an EMH type meter (open response, get list response with
+// 1.8.0 / 2.8.0 / 16.7.0 and some octet strings, close response), used by smlBench.cpp
+// if no capture is given and in the on-device benchmark.
+const uint8_t SML_BENCH_TELEGRAM[] PROGMEM = {
+    0x1B, 0x1B, 0x1B, 0x1B, 0x01, 0x01, 0x01, 0x01, 0x76, 0x04, 0x00, 0x01, 0x01, 0x62, 0x00, 0x62,
+    0x00, 0x72, 0x65, 0x00, 0x00, 0x01, 0x01, 0x76, 0x01, 0x01, 0x04, 0x00, 0x01, 0x02, 0x0B, 0x0A,
+    0x01, 0x45, 0x4D, 0x48, 0x00, 0x00, 0x7F, 0x00, 0x01, 0x01, 0x01, 0x63, 0x65, 0x61, 0x00, 0x76,
+    0x04, 0x00, 0x01, 0x02, 0x62, 0x00, 0x62, 0x00, 0x72, 0x65, 0x00, 0x00, 0x07, 0x01, 0x77, 0x01,
+    0x0B, 0x0A, 0x01, 0x45, 0x4D, 0x48, 0x00, 0x00, 0x7F, 0x00, 0x01, 0x07, 0x01, 0x00, 0x62, 0x0B,
+    0x00, 0xFF, 0x72, 0x62, 0x01, 0x65, 0x00, 0x00, 0x03, 0xE8, 0x76, 0x77, 0x07, 0x81, 0x81, 0xC7,
+    0x82, 0x03, 0xFF, 0x01, 0x01, 0x01, 0x01, 0x04, 0x45, 0x4D, 0x48, 0x01, 0x77, 0x07, 0x01, 0x00,
+    0x00, 0x00, 0x09, 0xFF, 0x01, 0x01, 0x01, 0x01, 0x0B, 0x0A, 0x01, 0x45, 0x4D, 0x48, 0x00, 0x00,
+    0x7F, 0x00, 0x01, 0x01, 0x77, 0x07, 0x01, 0x00, 0x01, 0x08, 0x00, 0xFF, 0x63, 0x01, 0x00, 0x01,
+    0x62, 0x1E, 0x52, 0xFF, 0x69, 0x00, 0x00, 0x00, 0x00, 0x07, 0x5B, 0xCD, 0x15, 0x01, 0x77, 0x07,
+    0x01, 0x00, 0x02, 0x08, 0x00, 0xFF, 0x63, 0x01, 0x00, 0x01, 0x62, 0x1E, 0x52, 0xFF, 0x69, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x2B, 0x01, 0x77, 0x07, 0x01, 0x00, 0x10, 0x07, 0x00, 0xFF,
+    0x01, 0x01, 0x62, 0x1B, 0x52, 0xFF, 0x55, 0x00, 0x00, 0x04, 0xD2, 0x01, 0x77, 0x07, 0x81, 0x81,
+    0xC7, 0xF0, 0x06, 0xFF, 0x01, 0x01, 0x01, 0x01, 0x04, 0x01, 0x02, 0x03, 0x01, 0x01, 0x01, 0x63,
+    0x90, 0x2C, 0x00, 0x76, 0x04, 0x00, 0x01, 0x03, 0x62, 0x00, 0x62, 0x00, 0x72, 0x65, 0x00, 0x00,
+    0x02, 0x01, 0x71, 0x01, 0x63, 0x5D, 0x02, 0x00, 0x1B, 0x1B, 0x1B, 0x1B, 0x1A, 0x00, 0x8A, 0x81,
+};
+
+#endif // SML_BENCH_DATA_H
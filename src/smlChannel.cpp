@@ -0,0 +1,284 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "smlChannel.h"
+#include "smlObis.h"
+
+/* *** smlChannel.cpp configuration of the Volkszaehler channels (OBIS id -> UUID)
+
+2026-10-17 mh
+- first version: channel table instead of the fixed channels energy in/out, power in
+- publish policy: relative deadband ("2%"), max interval (heartbeat), post on a change of the power direction ("dir")
+- aggregation windows: mean, min, max or mean power of an energy counter per window of min interval s
+- "derive": power from the steps of an energy counter (smlDerive.cpp); the last field takes several words
+- "meter2".."meter4": channel of a further reading head (multi-meter, smlScheduler.cpp) in 2 bits of the flags
+
+(C) M. Herbert, 2026.
+Licensed under the GNU General Public License v3.0
+
+*** end change log *** */
+
+/* ***
+# Description smlChannel #
+A channel maps an OBIS id of the meter to a Volkszaehler UUID, e.g. per phase power, voltage, current or frequency.
+SmlHttpConfig holds SML_CHANNELS_MAX channels (config.h), the defaults are SML_CHANNEL_DEFAULTS.
+
+On the configuration page each channel is one line of text:
+```bash
+OBIS id, UUID[, factor[, min interval[, deadband[%][, max interval[, [derive] [dir|mean|min|max|power] [meter1..4]]]]]]
+1-0:16.7.0*255, 0b4e1234-5678-90ab-cdef-0123456789ab             power, each telegram
+1-0:1.8.0*255, 0b4e1234-5678-90ab-cdef-0123456789ac, 0.001, 60   energy in kWh, at most once a minute
+1-0:32.7.0*255, 0b4e1234-5678-90ab-cdef-0123456789ad, 1, 0, 1    voltage L1, only on a change of more than 1 V
+1-0:1.8.0*255, 0b4e1234-5678-90ab-cdef-0123456789ac, 1, 0, 1, 300       energy in Wh: change of more than 1 Wh,
+                                                                         at least every 5 minutes
+1-0:16.7.0*255, 0b4e1234-5678-90ab-cdef-0123456789ab, 1, 0, 2%, 60, dir  power: change of more than 2 %, at least
+                                                                         once a minute, at once on import <-> export
+```
+The policy is evaluated per telegram by SmlHttp::flush() before a tuple is added to the batch of the channel:
+1. the first value, and with "dir" a value whose sign differs from the last posted one, is posted
+2. within min interval after the last post the value is suppressed
+3. after max interval the value is posted (heartbeat) even if unchanged
+4. a value within the deadband around the last posted value is suppressed (deadband with %: relative to it)
+
+Instead of "dir" the last field may name an aggregate: the values are not posted one by one but once per window of
+min interval s (aligned to the clock, e.g. 60: hh:mm:00 to hh:mm:59), with the time stamp of the end of the window:
+```bash
+1-0:16.7.0*255, 0b4e1234-5678-90ab-cdef-0123456789ae, 1, 10, 0, 0, mean   mean power per 10 s
+1-0:16.7.0*255, 0b4e1234-5678-90ab-cdef-0123456789af, 1, 60, 0, 0, max    peak power per minute
+1-0:1.8.0*255, 0b4e1234-5678-90ab-cdef-0123456789b0, 1, 60, 0, 0, power   mean power per minute from the energy in Wh
+```
+mean, min and max are taken over the values of the telegrams of the window; power is the difference of the counter
+per hour (Wh -> W), from the first value of the window to the first value of the next one. The same OBIS id may be
+used by several channels, e.g. the raw power and its peaks. A window is posted with the first telegram after its end;
+the deadband and max interval do not apply.
+
+"derive" posts the power calculated from the steps of an energy counter and the time stamps of the telegrams
+(SmlPowerDerivation, smlDerive.cpp) instead of the counter, for meters that send no power or only with 1 W
+resolution. The derived power passes the other words like a measured one; the words are separated by blanks:
+```bash
+1-0:1.8.0*255, 0b4e1234-5678-90ab-cdef-0123456789b1, 1, 0, 0, 0, derive       power in W from the energy in Wh
+1-0:1.8.0*255, 0b4e1234-5678-90ab-cdef-0123456789b2, 1, 60, 0, 0, derive mean  mean of it per minute
+```
+
+With several reading heads (SENSOR_CONFIGS, smlScheduler.cpp) the word meter1..meter4 selects the meter whose
+telegrams feed the channel, meter1 (the first reading head) is the default and not shown. Each meter has its own
+channels, the same OBIS id of two meters goes to two UUIDs:
+```bash
+1-0:16.7.0*255, 0b4e1234-5678-90ab-cdef-0123456789b3, 1, 0, 2%, 60, dir          power of the first meter
+1-0:16.7.0*255, 0b4e1234-5678-90ab-cdef-0123456789b4, 1, 0, 2%, 60, dir meter2   power of the second meter
+```
+
+The EEPROM holds the binary SmlChannelConfig (56 bytes per channel) instead of the text.
+
+*** end description *** */
+
+static_assert(sizeof(SmlChannelConfig) == 56, "SmlChannelConfig is stored in the EEPROM, 56 bytes");
+
+// next field of a comma separated list without leading and trailing blanks, NULL at the end
+static char *nextField(char **pos)
+{
+    if (*pos == NULL)
+    {
+        return NULL;
+    }
+    char *field = *pos;
+    char *comma = strchr(field, ',');
+    if (comma != NULL)
+    {
+        *comma = '\0';
+        *pos = comma + 1;
+    }
+    else
+    {
+        *pos = NULL;
+    }
+    while (*field == ' ')
+    {
+        field++;
+    }
+    char *end = field + strlen(field);
+    while (end > field && end[-1] == ' ')
+    {
+        *--end = '\0';
+    }
+    return field;
+}
+
+bool smlChannelParse(const char *spec, SmlChannelConfig *channel)
+{
+    char text[SML_CHANNEL_SPEC_LEN];
+    snprintf(text, sizeof(text), "%s", spec);
+    memset(channel, 0, sizeof(*channel));
+    channel->factor = 1;
+
+    char *pos = text;
+    char *field = nextField(&pos);
+    if (field == NULL || *field == '\0')
+    {
+        return true;                    // not used
+    }
+    uint64_t key = smlObisKey(field);
+    if (key == SML_OBIS_INVALID)
+    {
+        return false;
+    }
+
+    field = nextField(&pos);
+    if (field == NULL || *field == '\0' || strlen(field) >= sizeof(channel->uuid))
+    {
+        return false;
+    }
+    snprintf(channel->uuid, sizeof(channel->uuid), "%s", field);
+
+    char *end;
+    if ((field = nextField(&pos)) != NULL && *field != '\0')
+    {
+        channel->factor = strtof(field, &end);
+        if (*end != '\0')
+        {
+            return false;
+        }
+    }
+    if ((field = nextField(&pos)) != NULL && *field != '\0')
+    {
+        long interval = strtol(field, &end, 10);
+        if (*end != '\0' || interval < 0 || interval > 0xFFFF)
+        {
+            return false;
+        }
+        channel->minInterval = (uint16_t)interval;
+    }
+    if ((field = nextField(&pos)) != NULL && *field != '\0')
+    {
+        channel->deadband = strtof(field, &end);
+        if (*end == '%')
+        {
+            channel->flags |= SML_CHANNEL_RELATIVE;
+            end++;
+        }
+        if (*end != '\0' || channel->deadband < 0)
+        {
+            return false;
+        }
+    }
+    if ((field = nextField(&pos)) != NULL && *field != '\0')
+    {
+        long interval = strtol(field, &end, 10);
+        if (*end != '\0' || interval < 0 || interval > 0xFFFF)
+        {
+            return false;
+        }
+        channel->maxInterval = (uint16_t)interval;
+    }
+    if ((field = nextField(&pos)) != NULL && *field != '\0')
+    {
+        static const struct
+        {
+            const char *name;
+            byte flags;
+        } policies[] = {{"dir", SML_CHANNEL_DIRECTION}, {"mean", SML_CHANNEL_MEAN}, {"min", SML_CHANNEL_MIN},
+                        {"max", SML_CHANNEL_MAX}, {"power", SML_CHANNEL_POWER}, {"derive", SML_CHANNEL_DERIVE}};
+        // blank separated words, e.g. "derive dir"
+        char *save;
+        for (char *word = strtok_r(field, " ", &save); word != NULL; word = strtok_r(NULL, " ", &save))
+        {
+            if (!strncmp(word, "meter", 5))
+            {
+                long meter = strtol(word + 5, &end, 10);
+                if (*end != '\0' || meter < 1 || meter > (SML_CHANNEL_METER >> SML_CHANNEL_METER_SHIFT) + 1 ||
+                    (channel->flags & SML_CHANNEL_METER))
+                {
+                    return false;       // no meter of the flags or second meter
+                }
+                channel->flags |= (byte)((meter - 1) << SML_CHANNEL_METER_SHIFT);
+                continue;
+            }
+            size_t i = 0;
+            while (i < sizeof(policies) / sizeof(policies[0]) && strcmp(word, policies[i].name) != 0)
+            {
+                i++;
+            }
+            if (i == sizeof(policies) / sizeof(policies[0]) ||
+                ((policies[i].flags & SML_CHANNEL_AGGREGATE) && (channel->flags & SML_CHANNEL_AGGREGATE)))
+            {
+                return false;           // unknown or second aggregate
+            }
+            channel->flags |= policies[i].flags;
+        }
+        if ((channel->flags & SML_CHANNEL_AGGREGATE) &&
+            (channel->minInterval == 0 || (channel->flags & SML_CHANNEL_DIRECTION)))
+        {
+            return false;               // window of min interval s, no policy of single values
+        }
+        if ((channel->flags & SML_CHANNEL_DERIVE) && (channel->flags & SML_CHANNEL_AGGREGATE) == SML_CHANNEL_POWER)
+        {
+            return false;               // derive already gives the power
+        }
+    }
+    if (nextField(&pos) != NULL)
+    {
+        return false;                   // too many fields
+    }
+
+    for (int i = 5; i >= 0; i--)
+    {
+        channel->obis[i] = (byte)key;
+        key >>= 8;
+    }
+    return true;
+}
+
+void smlChannelFormat(const SmlChannelConfig &channel, char *spec, size_t size)
+{
+    if (!smlChannelUsed(channel))
+    {
+        spec[0] = '\0';
+        return;
+    }
+    const char *aggregate = "";
+    switch (channel.flags & SML_CHANNEL_AGGREGATE)
+    {
+    case SML_CHANNEL_MEAN:
+        aggregate = " mean";
+        break;
+    case SML_CHANNEL_MIN:
+        aggregate = " min";
+        break;
+    case SML_CHANNEL_MAX:
+        aggregate = " max";
+        break;
+    case SML_CHANNEL_POWER:
+        aggregate = " power";
+        break;
+    default:
+        break;
+    }
+    char meter[12] = "";
+    if (smlChannelMeter(channel) > 0)
+    {
+        snprintf(meter, sizeof(meter), " meter%u", smlChannelMeter(channel) + 1);
+    }
+    char policy[40];
+    snprintf(policy, sizeof(policy), "%s%s%s%s", (channel.flags & SML_CHANNEL_DERIVE) ? " derive" : "",
+             (channel.flags & SML_CHANNEL_DIRECTION) ? " dir" : "", aggregate, meter);
+    snprintf(spec, size, "%d-%d:%d.%d.%d*%d, %s, %g, %u, %g%s, %u%s%s",
+             channel.obis[0], channel.obis[1], channel.obis[2], channel.obis[3], channel.obis[4], channel.obis[5],
+             channel.uuid, channel.factor, channel.minInterval, channel.deadband,
+             (channel.flags & SML_CHANNEL_RELATIVE) ? "%" : "", channel.maxInterval, *policy ? "," : "", policy);
+}
+
+bool smlChannelUsed(const SmlChannelConfig &channel)
+{
+    static const byte unused[6] = {0};
+    return memcmp(channel.obis, unused, sizeof(unused)) != 0;
+}
+
+uint32_t smlChannelUuidHash(const char *uuid)
+{
+    uint32_t hash = 2166136261u;
+    for (; *uuid != '\0'; uuid++)
+    {
+        hash = (hash ^ (byte)*uuid) * 16777619u;
+    }
+    return hash;
+}
@@ -0,0 +1,48 @@
+#ifndef SML_CHANNEL_H
+#define SML_CHANNEL_H
+
+#include "hal.h"
+
+#define SML_CHANNEL_UUID_LEN 37         // 36 characters of a UUID
+#define SML_CHANNEL_SPEC_LEN 112        // text form of a channel, see smlChannelParse()
+
+// SmlChannelConfig::flags
+#define SML_CHANNEL_RELATIVE  0x01      // deadband in % of the last posted value
+#define SML_CHANNEL_DIRECTION 0x02      // post at once when the sign of the value changes (power direction)
+#define SML_CHANNEL_AGGREGATE 0x1C      // mask: one value per window of min interval s instead of the last value
+#define SML_CHANNEL_MEAN      0x04
+#define SML_CHANNEL_MIN       0x08
+#define SML_CHANNEL_MAX       0x0C
+#define SML_CHANNEL_POWER     0x10      // mean power of an energy counter: difference per hour
+#define SML_CHANNEL_DERIVE    0x20      // power from the steps of an energy counter instead of the counter
+#define SML_CHANNEL_METER     0xC0      // mask: meter (reading head, SENSOR_CONFIGS) of the channel - 1, up to 4 meters
+#define SML_CHANNEL_METER_SHIFT 6
+
+// one Volkszaehler channel: OBIS id of the meter -> UUID, stored as is in the EEPROM (56 bytes)
+struct SmlChannelConfig
+{
+    float factor;                       // posted value = meter value * factor
+    float deadband;                     // post only if the value changed by more than deadband, 0: each value
+    uint16_t minInterval;               // min. time between posts in s, 0: each telegram
+    uint16_t maxInterval;               // post at least every maxInterval s (heartbeat), 0: no heartbeat
+    byte flags;                         // SML_CHANNEL_RELATIVE, _DIRECTION, _AGGREGATE, _DERIVE, _METER
+    byte obis[6];                       // all 0: channel not used
+    char uuid[SML_CHANNEL_UUID_LEN];
+};
+
+// text form "OBIS id, UUID[, factor[, min interval[, deadband[%][, max interval[, words]]]]]", words: blank
+// separated derive, dir, meter1..meter4 and one of mean|min|max|power, e.g. "1-0:16.7.0*255, 0b4e..., 1, 0, 2%, 300, dir",
+// "1-0:16.7.0*255, 0b4e..., 1, 60, 0, 0, max" or "1-0:1.8.0*255, 0b4e..., 1, 0, 0, 0, derive dir"
+// an empty text clears the channel; false if the text is invalid (the channel is cleared as well)
+bool smlChannelParse(const char *spec, SmlChannelConfig *channel);
+void smlChannelFormat(const SmlChannelConfig &channel, char *spec, size_t size);
+bool smlChannelUsed(const SmlChannelConfig &channel);
+// 32 bit hash (FNV-1a) of the UUID, identifies the channel when the table is changed
+uint32_t smlChannelUuidHash(const char *uuid);
+// index of the meter (Sensor::meter) whose telegrams feed the channel, 0: first reading head
+inline uint8_t smlChannelMeter(const SmlChannelConfig &channel)
+{
+    return (channel.flags & SML_CHANNEL_METER) >> SML_CHANNEL_METER_SHIFT;
+}
+
+#endif // SML_CHANNEL_H
@@ -0,0 +1,26 @@
+#ifndef SML_CRC16_H
+#define SML_CRC16_H
+
+#include "hal.h"
+
+// CRC16/X-25 of SML transport v1 (see smlCrc16.cpp): covers the frame from the start sequence up to and including the
+// number of fill bytes, transmitted low byte first.
+// Incremental use: crc = SML_CRC16_INIT; crc = smlCrc16Update(crc, data, len); ...; smlCrc16Final(crc)
+
+const uint16_t SML_CRC16_INIT = 0xFFFF;
+
+extern const uint16_t smlCrc16Table[256];
+
+inline uint16_t smlCrc16Byte(uint16_t crc, byte value)
+{
+    return (crc >> 8) ^ pgm_read_word(&smlCrc16Table[(crc ^ value) & 0xFF]);
+}
+inline uint16_t smlCrc16Final(uint16_t crc)
+{
+    return crc ^ 0xFFFF;
+}
+
+uint16_t smlCrc16Update(uint16_t crc, const byte *data, size_t len);
+uint16_t smlCrc16(const byte *data, size_t len);
+
+#endif // SML_CRC16_H
@@ -1,9 +1,15 @@
 #include "smlDebug.h"
+#include "smlDecimal.h"
+#include "smlObis.h"
 #include "unit.h"
 /* ***
 # Description smlDebug.cpp #
 smlDebug.cpp implementing debug output of the SML file message structure
 
+2026-10-17 mh
+- DEBUG_DUMP_BUFFER: time stamp line "@<ms>", the dump is a capture for smlReplay
+- DEBUG_SML_FILE: values by smlObisFromList() and smlDecimalFormat() instead of sml_value_to_double() and pow()
+
 2023-01-27 mh
 - rename file from debug to smlDebug due to name collision with framework include
 
@@ -20,6 +26,9 @@ void DEBUG_DUMP_BUFFER(byte *buf, int size)
 {
 #if (defined(SERIAL_DEBUG_VERBOSE) && SERIAL_DEBUG_VERBOSE)
     DEBUG("----DATA----");
+    // arrival time of the first byte (1.042ms per byte at 9600 Baud); allows to replay the dump
+    SERIAL_DEBUG_IMPL.print("@");
+    SERIAL_DEBUG_IMPL.println((int)(millis() - (size * 1042UL) / 1000));
     for (int i = 0; i < size; i++)
     {
         if (buf[i] < 16)
@@ -35,6 +44,9 @@ void DEBUG_DUMP_BUFFER(byte *buf, int size)
     }
     SERIAL_DEBUG_IMPL.println();
     DEBUG("---END OF DATA---");
+#else
+    (void)buf;
+    (void)size;
 #endif
 }
 void DEBUG_SML_FILE(sml_file *file)
@@ -81,16 +93,18 @@ void DEBUG_SML_FILE(sml_file *file)
                 else if (((entry->value->type & SML_TYPE_FIELD) == SML_TYPE_INTEGER) ||
                          ((entry->value->type & SML_TYPE_FIELD) == SML_TYPE_UNSIGNED))
                 {
-                    double value = sml_value_to_double(entry->value);
-                    int scaler = (entry->scaler) ? *entry->scaler : 0;
-                    int prec = -scaler;
-                    if (prec < 0)
-                        prec = 0;
-                    value = value * pow(10, scaler);
-                    printf("%d-%d:%d.%d.%d*%d#%.*f#",
+                    // integer and scaler of the entry, formatted without floating point
+                    SmlObisEntry obisEntry;
+                    char value[32] = "";
+                    if (smlObisFromList(entry, &obisEntry))
+                    {
+                        smlDecimalFormat(value, sizeof(value), obisEntry.value, obisEntry.scaler,
+                                         (obisEntry.scaler < 0) ? -obisEntry.scaler : 0);
+                    }
+                    printf("%d-%d:%d.%d.%d*%d#%s#",
                            entry->obj_name->str[0], entry->obj_name->str[1],
                            entry->obj_name->str[2], entry->obj_name->str[3],
-                           entry->obj_name->str[4], entry->obj_name->str[5], prec, value);
+                           entry->obj_name->str[4], entry->obj_name->str[5], value);
                     const char *unit = NULL;
                     if (entry->unit && // do not crash on null (unit is optional)
                         (unit = dlms_get_unit((unsigned char)*entry->unit)) != NULL)
@@ -102,5 +116,7 @@ void DEBUG_SML_FILE(sml_file *file)
             }
         }
     }
+#else
+    (void)file;
 #endif
 }
\ No newline at end of file
@@ -1,7 +1,7 @@
 #ifndef SML_DEBUG_H
 #define SML_DEBUG_H
 
-#include <Arduino.h>
+#include "hal.h"
 #include <sml/sml_file.h>
 #include <sml/sml_value.h>
 
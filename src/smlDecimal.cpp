@@ -0,0 +1,255 @@
+#include <string.h>
+#include "smlDecimal.h"
+
+/* *** smlDecimal.cpp scaled integer values: scaling, factor, parsing and formatting without floating point
+
+2026-10-17 mh
+- first version: the publish path carries the values of the meter as int64_t with a decimal scaler instead of double
+
+(C) M. Herbert, 2026.
+Licensed under the GNU General Public License v3.0
+
+*** end change log *** */
+
+/* ***
+# Description smlDecimal #
+The meter sends a value as integer with a decimal scaler (SmlObisEntry::value, ::scaler), e.g. 123456789 and -1
+for 12345678.9 Wh. Converting it with value * pow(10, scaler) to double and printing it with "%.2f" costs a libm
+call, software floating point and the floating point printf of the ESP8266 per entry.
+
+SmlHttp keeps the values as int64_t in units of 10^-SML_VALUE_DECIMALS (mW, mWh, mV, ...), i.e. the scaler of the
+meter is applied once with smlDecimalScale() and the values of a channel are compared, aggregated and stored as
+integers. The factor and the deadband of the channel are converted once by init() to mantissa and scaler
+(smlDecimalParse()), smlDecimalMultiply() applies the factor. smlDecimalFormat() prints the HTTP bodies and the dash
+board values from the integer.
+
+With SML_VALUE_DECIMALS 3 the range is +-9.2e15 units (e.g. 9.2e12 kWh), the resolution 0.001, rounded half away
+from zero; a value of the meter with more decimals (scaler < -3) is rounded.
+
+## Usage ##
+```bash
+int64_t value;
+smlDecimalScale(entry.value, entry.scaler, SML_VALUE_DECIMALS, &value);   // 12345678.9 Wh -> 12345678900 mWh
+smlDecimalFormat(text, sizeof(text), value, -SML_VALUE_DECIMALS, 2);       // "12345678.90"
+```
+
+*** end description *** */
+
+static const int64_t POW10[19] = {1LL, 10LL, 100LL, 1000LL, 10000LL, 100000LL, 1000000LL, 10000000LL, 100000000LL,
+                                  1000000000LL, 10000000000LL, 100000000000LL, 1000000000000LL, 10000000000000LL,
+                                  100000000000000LL, 1000000000000000LL, 10000000000000000LL, 100000000000000000LL,
+                                  1000000000000000000LL};
+
+// value / divisor rounded half away from zero
+static int64_t divideRounded(int64_t value, int64_t divisor)
+{
+    uint64_t magnitude = (value < 0) ? 0ULL - (uint64_t)value : (uint64_t)value;
+    uint64_t quotient = (magnitude + (uint64_t)divisor / 2) / (uint64_t)divisor;
+    return (value < 0) ? -(int64_t)quotient : (int64_t)quotient;
+}
+
+bool smlDecimalScale(int64_t mantissa, int8_t scaler, int8_t decimals, int64_t *result)
+{
+    int exponent = scaler + decimals;
+    if (exponent >= 0)
+    {
+        if (exponent > 18 || mantissa > INT64_MAX / POW10[exponent] || mantissa < -INT64_MAX / POW10[exponent])
+        {
+            return false;
+        }
+        *result = mantissa * POW10[exponent];
+    }
+    else
+    {
+        *result = (exponent < -18) ? 0 : divideRounded(mantissa, POW10[-exponent]);
+    }
+    return true;
+}
+
+int64_t smlDecimalMultiply(int64_t value, int64_t factorMantissa, int8_t factorScaler)
+{
+    if (factorMantissa == 1 && factorScaler == 0)
+    {
+        return value;                   // factor 1, the default
+    }
+    int64_t saturated = ((value < 0) != (factorMantissa < 0)) ? -INT64_MAX : INT64_MAX;
+    int64_t magnitude = (factorMantissa < 0) ? -factorMantissa : factorMantissa;
+    int64_t result;
+    if (magnitude != 0 && (value > INT64_MAX / magnitude || value < -INT64_MAX / magnitude))
+    {
+        // scale first, loses the digits below the resolution of the factor
+        if (!smlDecimalScale(value, factorScaler, 0, &result) ||
+            result > INT64_MAX / magnitude || result < -INT64_MAX / magnitude)
+        {
+            return saturated;
+        }
+        return result * factorMantissa;
+    }
+    return smlDecimalScale(value * factorMantissa, factorScaler, 0, &result) ? result : saturated;
+}
+
+bool smlDecimalParse(const char *text, int64_t *mantissa, int8_t *scaler)
+{
+    const char *pos = text;
+    bool negative = (*pos == '-');
+    if (*pos == '-' || *pos == '+')
+    {
+        pos++;
+    }
+    int64_t value = 0;
+    int exponent = 0;
+    uint8_t digits = 0;
+    bool point = false;
+    bool any = false;
+    for (; (*pos >= '0' && *pos <= '9') || (*pos == '.' && !point); pos++)
+    {
+        if (*pos == '.')
+        {
+            point = true;
+            continue;
+        }
+        any = true;
+        if (digits < 18)
+        {
+            value = value * 10 + (*pos - '0');
+            digits += (value > 0) ? 1 : 0;
+            exponent -= point ? 1 : 0;
+        }
+        else if (!point)
+        {
+            exponent++;                 // digits beyond the precision are dropped
+        }
+    }
+    if (!any)
+    {
+        return false;
+    }
+    if (*pos == 'e' || *pos == 'E')
+    {
+        pos++;
+        bool negativeExponent = (*pos == '-');
+        if (*pos == '-' || *pos == '+')
+        {
+            pos++;
+        }
+        if (*pos < '0' || *pos > '9')
+        {
+            return false;
+        }
+        int e = 0;
+        for (; *pos >= '0' && *pos <= '9' && e < 1000; pos++)
+        {
+            e = e * 10 + (*pos - '0');
+        }
+        exponent += negativeExponent ? -e : e;
+    }
+    if (*pos != '\0')
+    {
+        return false;
+    }
+    while (value != 0 && value % 10 == 0)
+    {
+        value /= 10;
+        exponent++;
+    }
+    if (value == 0)
+    {
+        exponent = 0;
+    }
+    if (exponent < -127 || exponent > 127)
+    {
+        return false;
+    }
+    *mantissa = negative ? -value : value;
+    *scaler = (int8_t)exponent;
+    return true;
+}
+
+// decimal digits of value in front of end, 32 bit divisions except for values above 2^32
+static char *formatUnsigned(uint64_t value, char *end)
+{
+    char *pos = end;
+    while (value > 0xFFFFFFFFULL)
+    {
+        uint32_t low = (uint32_t)(value % 1000000000ULL);
+        value /= 1000000000ULL;
+        for (uint8_t i = 0; i < 9; i++)
+        {
+            *--pos = (char)('0' + low % 10);
+            low /= 10;
+        }
+    }
+    uint32_t value32 = (uint32_t)value;
+    do
+    {
+        *--pos = (char)('0' + value32 % 10);
+        value32 /= 10;
+    } while (value32 > 0);
+    return pos;
+}
+
+size_t smlDecimalFormat(char *text, size_t size, int64_t mantissa, int8_t scaler, uint8_t digits)
+{
+    // fraction digits of the mantissa after rounding to digits; zeros appended to the integer (positive scaler)
+    // and to the fraction (fewer decimals than digits)
+    int fraction = -scaler;
+    if (fraction > digits)
+    {
+        mantissa = (fraction - digits > 18) ? 0 : divideRounded(mantissa, POW10[fraction - digits]);
+        fraction = digits;
+    }
+    uint16_t zeros = 0;
+    if (fraction < 0)
+    {
+        zeros = (uint16_t)-fraction;
+        fraction = 0;
+    }
+    uint16_t trailing = digits - fraction;
+
+    char number[24];
+    char *end = number + sizeof(number);
+    uint64_t magnitude = (mantissa < 0) ? 0ULL - (uint64_t)mantissa : (uint64_t)mantissa;
+    char *begin = formatUnsigned(magnitude, end);
+    size_t numberLen = end - begin;
+
+    size_t len = 0;
+    size_t integerLen = (numberLen > (size_t)fraction) ? numberLen - fraction : 0;
+    size_t need = (mantissa < 0) + (integerLen ? integerLen : 1) + zeros + (digits ? 1 + digits : 0);
+    if (need >= size)
+    {
+        if (size > 0)
+        {
+            text[0] = '\0';
+        }
+        return 0;
+    }
+    if (mantissa < 0)
+    {
+        text[len++] = '-';
+    }
+    if (integerLen > 0)
+    {
+        memcpy(text + len, begin, integerLen);
+        len += integerLen;
+        memset(text + len, '0', zeros);
+        len += (magnitude != 0) ? zeros : 0;
+    }
+    else
+    {
+        text[len++] = '0';
+    }
+    if (digits > 0)
+    {
+        text[len++] = '.';
+        for (size_t i = numberLen - integerLen; i < (size_t)fraction; i++)
+        {
+            text[len++] = '0';          // leading zeros of the fraction
+        }
+        memcpy(text + len, begin + integerLen, numberLen - integerLen);
+        len += numberLen - integerLen;
+        memset(text + len, '0', trailing);
+        len += trailing;
+    }
+    text[len] = '\0';
+    return len;
+}
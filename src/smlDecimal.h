@@ -0,0 +1,22 @@
+#ifndef SML_DECIMAL_H
+#define SML_DECIMAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// meter values as int64_t mantissa and decimal scaler (value = mantissa * 10^scaler) as sent by the meter,
+// integer arithmetic and formatting only (see smlDecimal.cpp)
+
+#define SML_VALUE_DECIMALS 3            // values of the publish path: mantissa * 10^-SML_VALUE_DECIMALS
+#define SML_VALUE_NONE INT64_MIN        // no value
+
+// mantissa * 10^(scaler + decimals), rounded half away from zero; false on overflow
+bool smlDecimalScale(int64_t mantissa, int8_t scaler, int8_t decimals, int64_t *result);
+// value * (factorMantissa * 10^factorScaler), rounded; saturated on overflow
+int64_t smlDecimalMultiply(int64_t value, int64_t factorMantissa, int8_t factorScaler);
+// text "-12.345", "1e-3" -> mantissa and scaler (trailing zeros removed), false if invalid
+bool smlDecimalParse(const char *text, int64_t *mantissa, int8_t *scaler);
+// mantissa * 10^scaler with digits fraction digits (rounded) as text; returns the length, no floating point
+size_t smlDecimalFormat(char *text, size_t size, int64_t mantissa, int8_t scaler, uint8_t digits);
+
+#endif // SML_DECIMAL_H
@@ -0,0 +1,24 @@
+#ifndef SML_DERIVE_H
+#define SML_DERIVE_H
+
+#include <stdint.h>
+#include "config.h"
+
+// power of an energy counter from the times of its steps, 64 bit fixed point (see smlDerive.cpp)
+class SmlPowerDerivation
+{
+public:
+    // counter value * 10^scaler Wh received at frameMs (ms, monotonic); true with a new power in mW
+    bool add(int64_t value, int8_t scaler, uint32_t frameMs, int64_t *powerMw);
+    void reset() { _valid = false; }
+
+private:
+    bool _valid = false;
+    int64_t _energy = 0;                // uWh at the last step used for a power
+    uint32_t _energyMs = 0;
+    int64_t _last = 0;                  // uWh of the last telegram
+    int64_t _step = 0;                  // resolution of the counter, uWh
+    int64_t _power = 0;                 // last power, mW
+};
+
+#endif // SML_DERIVE_H
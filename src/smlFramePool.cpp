@@ -0,0 +1,179 @@
+#include <string.h>
+#include "smlFramePool.h"
+
+/* *** smlFramePool.cpp frame buffers of all sensors in one block of RAM
+
+2026-10-17 mh
+- first version: runs of SML_FRAME_BLOCK bytes, first fit, grow in place or by a move, shrink to the telegram
+
+(C) M. Herbert, 2026.
+Licensed under the GNU General Public License v3.0
+
+*** end change log *** */
+
+/* ***
+# Description SmlFramePool #
+Sensor formerly embedded SENSOR_FRAME_BUFFERS buffers of BUFFER_SIZE (3840) bytes each, 7.5 KB per reading head,
+while a meter sends telegrams of a few hundred bytes. The frame buffers of all sensors now come from one static pool
+of SML_FRAME_POOL_SIZE bytes (.bss, no heap), e.g. 4 KB instead of 7.5 KB for one head and 22.5 KB for three.
+
+A frame buffer is a run of blocks of SML_FRAME_BLOCK bytes (first fit). The sensor learns the size of the telegrams
+of its meter and asks for the largest telegram so far plus a quarter at the start sequence (1 KB for the first
+telegram); if a telegram is larger, the buffer is grown during the reception, in place if the following blocks are
+free, otherwise moved to a larger free run. The received telegram keeps only the blocks it needs (shrink()) until
+it is processed, then its blocks are released. If the pool has no run large enough, the telegram waits in the ring
+buffer of the sensor or is dropped (SensorStats::framesDropped), as when all frame buffers of the sensor are busy.
+A telegram never grows beyond BUFFER_SIZE (framing error, as before).
+
+fragmentation() is the share of the free bytes outside of the largest free run, i.e. 0 % if the free bytes are
+one run; SmlFramePoolStats keeps the peak of it and of the bytes used (smlBench -g).
+
+## Usage ##
+```bash
+frame = smlFramePool()->alloc(len, &size);
+smlFramePool()->grow(&frame, &size, 2 * size, used);     // false: no larger run
+smlFramePool()->shrink(frame, &size, used);
+smlFramePool()->release(frame, size);
+```
+
+*** end description *** */
+
+static_assert(SML_FRAME_POOL_SIZE % SML_FRAME_BLOCK == 0, "SML_FRAME_POOL_SIZE: multiple of SML_FRAME_BLOCK");
+
+static inline size_t blocksOf(size_t len)
+{
+    return (len + SML_FRAME_BLOCK - 1) / SML_FRAME_BLOCK;
+}
+
+// first free run of blocks, SML_FRAME_POOL_BLOCKS if there is none
+size_t SmlFramePool::findRun(size_t blocks) const
+{
+    size_t run = 0;
+    for (size_t i = 0; i < SML_FRAME_POOL_BLOCKS; i++)
+    {
+        run = _used[i] ? 0 : run + 1;
+        if (run == blocks)
+        {
+            return i + 1 - blocks;
+        }
+    }
+    return SML_FRAME_POOL_BLOCKS;
+}
+
+void SmlFramePool::mark(size_t first, size_t blocks, uint8_t used)
+{
+    memset(&_used[first], used, blocks);
+    if (used)
+    {
+        _stats.usedBytes += blocks * SML_FRAME_BLOCK;
+        if (_stats.usedBytes > _stats.peakBytes)
+        {
+            _stats.peakBytes = _stats.usedBytes;
+        }
+        uint8_t percent = fragmentation();
+        if (percent > _stats.peakFragmentation)
+        {
+            _stats.peakFragmentation = percent;
+        }
+    }
+    else
+    {
+        _stats.usedBytes -= blocks * SML_FRAME_BLOCK;
+    }
+}
+
+byte *SmlFramePool::alloc(size_t len, size_t *size)
+{
+    size_t blocks = blocksOf(len);
+    size_t first = (blocks > 0) ? findRun(blocks) : SML_FRAME_POOL_BLOCKS;
+    if (first == SML_FRAME_POOL_BLOCKS)
+    {
+        return NULL;
+    }
+    mark(first, blocks, 1);
+    _stats.allocs++;
+    *size = blocks * SML_FRAME_BLOCK;
+    return &_pool[first * SML_FRAME_BLOCK];
+}
+
+bool SmlFramePool::grow(byte **frame, size_t *size, size_t len, size_t used)
+{
+    size_t first = (*frame - _pool) / SML_FRAME_BLOCK;
+    size_t blocks = *size / SML_FRAME_BLOCK;
+    size_t need = blocksOf(len);
+    if (need <= blocks)
+    {
+        return true;
+    }
+    // in place: the following blocks are free
+    size_t end = first + blocks;
+    while (end < first + need && end < SML_FRAME_POOL_BLOCKS && !_used[end])
+    {
+        end++;
+    }
+    if (end == first + need)
+    {
+        mark(first + blocks, need - blocks, 1);
+        *size = need * SML_FRAME_BLOCK;
+        _stats.grows++;
+        return true;
+    }
+    // moved: the own run counts as free, so the new run may overlap it
+    mark(first, blocks, 0);
+    size_t moved = findRun(need);
+    if (moved == SML_FRAME_POOL_BLOCKS)
+    {
+        mark(first, blocks, 1);
+        _stats.failures++;
+        return false;
+    }
+    memmove(&_pool[moved * SML_FRAME_BLOCK], *frame, used);
+    mark(moved, need, 1);
+    *frame = &_pool[moved * SML_FRAME_BLOCK];
+    *size = need * SML_FRAME_BLOCK;
+    _stats.moves++;
+    return true;
+}
+
+void SmlFramePool::shrink(byte *frame, size_t *size, size_t len)
+{
+    size_t blocks = *size / SML_FRAME_BLOCK;
+    size_t keep = blocksOf(len);
+    if (keep < blocks)
+    {
+        mark((frame - _pool) / SML_FRAME_BLOCK + keep, blocks - keep, 0);
+        *size = keep * SML_FRAME_BLOCK;
+    }
+}
+
+void SmlFramePool::release(byte *frame, size_t size)
+{
+    if (frame != NULL && size > 0)
+    {
+        mark((frame - _pool) / SML_FRAME_BLOCK, size / SML_FRAME_BLOCK, 0);
+    }
+}
+
+size_t SmlFramePool::largestFree() const
+{
+    size_t largest = 0;
+    size_t run = 0;
+    for (size_t i = 0; i < SML_FRAME_POOL_BLOCKS; i++)
+    {
+        run = _used[i] ? 0 : run + 1;
+        largest = (run > largest) ? run : largest;
+    }
+    return largest * SML_FRAME_BLOCK;
+}
+
+uint8_t SmlFramePool::fragmentation() const
+{
+    size_t free = SML_FRAME_POOL_SIZE - _stats.usedBytes;
+    return (free > 0) ? (uint8_t)(100 - largestFree() * 100 / free) : 0;
+}
+
+SmlFramePool *smlFramePool()
+{
+    static SmlFramePool pool;
+    return &pool;
+}
@@ -0,0 +1,51 @@
+#ifndef SML_FRAME_POOL_H
+#define SML_FRAME_POOL_H
+
+#include "hal.h"
+
+#ifndef SML_FRAME_POOL_SIZE
+#define SML_FRAME_POOL_SIZE 4096        // frame buffers of all sensors, bytes; at least BUFFER_SIZE (Sensor.h)
+#endif
+#define SML_FRAME_BLOCK 64              // allocation unit of the pool, bytes
+#define SML_FRAME_POOL_BLOCKS (SML_FRAME_POOL_SIZE / SML_FRAME_BLOCK)
+
+struct SmlFramePoolStats
+{
+    uint32_t allocs;                // frame buffers handed out
+    uint32_t grows;                 // frame buffers grown in place
+    uint32_t moves;                 // frame buffers grown by a copy to a larger free run
+    uint32_t failures;              // frame buffers not grown: no free run large enough
+    uint32_t usedBytes;             // in use now
+    uint32_t peakBytes;             // most bytes in use
+    uint8_t peakFragmentation;      // most fragmentation(), percent
+};
+
+// frame buffers of all sensors in one static block, allocated in runs of SML_FRAME_BLOCK bytes (see smlFramePool.cpp)
+class SmlFramePool
+{
+public:
+    // free run of at least len bytes, NULL if there is none; *size: bytes granted (multiple of SML_FRAME_BLOCK)
+    byte *alloc(size_t len, size_t *size);
+    // at least len bytes: in place or moved with the first used bytes; false: the frame is unchanged
+    bool grow(byte **frame, size_t *size, size_t len, size_t used);
+    // keep the first len bytes, the rest of the run is free
+    void shrink(byte *frame, size_t *size, size_t len);
+    void release(byte *frame, size_t size);
+    size_t largestFree() const;
+    // share of the free bytes not in the largest free run, percent
+    uint8_t fragmentation() const;
+    const SmlFramePoolStats &getStats() { return _stats; }
+
+private:
+    size_t findRun(size_t blocks) const;
+    void mark(size_t first, size_t blocks, uint8_t used);
+
+    alignas(4) byte _pool[SML_FRAME_POOL_SIZE];
+    uint8_t _used[SML_FRAME_POOL_BLOCKS] = {};
+    SmlFramePoolStats _stats = {};
+};
+
+// pool shared by all sensors
+SmlFramePool *smlFramePool();
+
+#endif // SML_FRAME_POOL_H
@@ -0,0 +1,251 @@
+#include <stdio.h>
+#include <string.h>
+#include "smlHistory.h"
+
+/* *** smlHistory.cpp ring buffer of the last telegrams in RAM, range query in chunks (JSON or binary)
+
+2026-10-17 mh
+- first version: structure of arrays with time deltas and scaled integer values, Reader for chunked responses
+- values of SmlHttp as scaled integers (smlDecimal.cpp), no floating point
+
+(C) M. Herbert, 2026.
+Licensed under the GNU General Public License v3.0
+
+*** end change log *** */
+
+/* ***
+# Description SmlHistory #
+SmlHttp adds the values of the first SML_HISTORY_CHANNELS channels at the end of each telegram (at most one sample
+per SML_HISTORY_INTERVAL ms), i.e. before min interval and deadband of the channel. The web server answers
+/history?from=<ms>&to=<ms>&format=json|bin (or last=<s>) from the ring without a request to the Volkszaehler database.
+
+## Memory ##
+A sample takes 2 + 4 * SML_HISTORY_CHANNELS bytes (8.4 KB for 600 samples of 3 channels), kept as structure of arrays:
+- time stamp as ms since the previous sample (uint16_t); the time stamp of the oldest sample is kept separately.
+  A gap of more than 65.5 s is filled with samples without values, a larger gap than the ring covers or a time
+  stamp before the newest one (e.g. NTP time after the start) clears the ring.
+- value * 10^SML_HISTORY_DECIMALS as int32_t, SML_HISTORY_NO_VALUE if the telegram had no value of the channel.
+
+## Response ##
+Reader produces the response in chunks as requested by the web server (AsyncWebServer::beginChunkedResponse),
+so neither the samples nor the response are copied. Samples added after the request are not sent; if the ring
+overwrites samples not yet sent, the response ends early.
+JSON, values as decimal numbers:
+```bash
+{"decimals":1,"channels":["<uuid>",...],"samples":[
+[1666801000123,12345678.9,null,230.5],
+...]}
+```
+binary (little endian): header "SMLH", version 1, channels, decimals, 0, uint64_t ms of the first sample,
+then per sample uint16_t ms since the previous sample (0 for the first) and int32_t per channel.
+
+## Usage ##
+```bash
+SmlHistory history;
+history.add(ms, values);
+SmlHistory::Reader reader(history, fromMs, toMs, SmlHistory::FORMAT_JSON);
+while ((n = reader.read(buffer, sizeof(buffer))) > 0) ...
+```
+
+*** end description *** */
+
+static const uint16_t DT_MAX = 0xFFFF;
+
+void SmlHistory::clear()
+{
+    _head = 0;
+    _count = 0;
+}
+
+void SmlHistory::add(uint64_t ms, const int64_t *values)
+{
+    if (_count > 0 && (ms < _lastMs || ms - _lastMs > (uint64_t)SML_HISTORY_SAMPLES * DT_MAX))
+    {
+        clear();                                // clock set or gap longer than the ring
+    }
+#if SML_HISTORY_INTERVAL > 0
+    if (_count > 0 && ms - _lastMs < SML_HISTORY_INTERVAL)
+    {
+        return;
+    }
+#endif
+    int32_t scaled[SML_HISTORY_CHANNELS];
+    for (uint8_t i = 0; i < SML_HISTORY_CHANNELS; i++)
+    {
+        int64_t value;
+        scaled[i] = (values[i] == SML_VALUE_NONE ||
+                     !smlDecimalScale(values[i], -SML_VALUE_DECIMALS, SML_HISTORY_DECIMALS, &value) ||
+                     value <= INT32_MIN || value > INT32_MAX) ? SML_HISTORY_NO_VALUE : (int32_t)value;
+    }
+    if (_count == 0)
+    {
+        _firstMs = ms;
+        _lastMs = ms;
+    }
+    while (ms - _lastMs > DT_MAX)
+    {
+        int32_t gap[SML_HISTORY_CHANNELS];
+        for (uint8_t i = 0; i < SML_HISTORY_CHANNELS; i++)
+        {
+            gap[i] = SML_HISTORY_NO_VALUE;
+        }
+        push(DT_MAX, gap);
+    }
+    push((uint16_t)(ms - _lastMs), scaled);
+}
+
+void SmlHistory::push(uint16_t dtMs, const int32_t *values)
+{
+    if (_count == SML_HISTORY_SAMPLES)
+    {
+        // overwrite the oldest sample
+        _head = (_head + 1) % SML_HISTORY_SAMPLES;
+        _count--;
+        _firstMs += _dtMs[_head];
+    }
+    uint16_t i = (_head + _count) % SML_HISTORY_SAMPLES;
+    _dtMs[i] = (_count > 0) ? dtMs : 0;
+    for (uint8_t channel = 0; channel < SML_HISTORY_CHANNELS; channel++)
+    {
+        _value[channel][i] = values[channel];
+    }
+    _count++;
+    _sequence++;
+    _lastMs += _dtMs[i];
+}
+
+SmlHistory::Reader::Reader(SmlHistory &history, uint64_t fromMs, uint64_t toMs, Format format)
+    : _history(history), _format(format), _toMs(toMs), _end(history._sequence)
+{
+    // first sample of the range
+    _next = history.oldest();
+    _nextMs = history._firstMs;
+    while (_next < _end && _nextMs < fromMs)
+    {
+        if (++_next < _end)
+        {
+            _nextMs += history._dtMs[history.index(_next)];
+        }
+    }
+}
+
+size_t SmlHistory::Reader::read(uint8_t *buffer, size_t maxLen)
+{
+    size_t len = 0;
+    while (len < maxLen)
+    {
+        if (_linePos == _lineLen && !nextLine())
+        {
+            break;
+        }
+        size_t n = (_lineLen - _linePos < maxLen - len) ? _lineLen - _linePos : maxLen - len;
+        memcpy(buffer + len, _line + _linePos, n);
+        _linePos += n;
+        len += n;
+    }
+    return len;
+}
+
+// next part of the response into _line, false at the end
+bool SmlHistory::Reader::nextLine()
+{
+    _linePos = 0;
+    _lineLen = 0;
+    if (_part == SAMPLES && (_next < _history.oldest() || _next >= _end || _nextMs > _toMs))
+    {
+        _part = FOOTER;                         // end of the range or overwritten by the ring
+    }
+    switch (_part)
+    {
+    case HEADER:
+        if (_format == FORMAT_BINARY)
+        {
+            memcpy(_line, "SMLH", 4);
+            _line[4] = 1;
+            _line[5] = SML_HISTORY_CHANNELS;
+            _line[6] = SML_HISTORY_DECIMALS;
+            _line[7] = 0;
+            for (uint8_t i = 0; i < 8; i++)
+            {
+                _line[8 + i] = (char)(_nextMs >> (8 * i));
+            }
+            _lineLen = 16;
+        }
+        else
+        {
+            _lineLen = snprintf(_line, sizeof(_line), "{\"decimals\":%d,\"channels\":[", SML_HISTORY_DECIMALS);
+        }
+        _part = (_format == FORMAT_JSON) ? CHANNELS : SAMPLES;
+        return true;
+    case CHANNELS:
+        // UUID: 36 characters
+        _lineLen = snprintf(_line, sizeof(_line), "%s\"%.36s\"%s", _channel ? "," : "",
+                            _history._name[_channel] ? _history._name[_channel] : "",
+                            (_channel + 1 == SML_HISTORY_CHANNELS) ? "],\"samples\":[" : "");
+        if (++_channel == SML_HISTORY_CHANNELS)
+        {
+            _part = SAMPLES;
+        }
+        return true;
+    case SAMPLES:
+        _lineLen = formatSample(_history.index(_next));
+        _first = false;
+        if (++_next < _end && _next >= _history.oldest())
+        {
+            _nextMs += _history._dtMs[_history.index(_next)];
+        }
+        return true;
+    case FOOTER:
+        if (_format == FORMAT_JSON)
+        {
+            _lineLen = snprintf(_line, sizeof(_line), "]}\n");
+        }
+        _part = DONE;
+        return _lineLen > 0;
+    default:
+        return false;
+    }
+}
+
+// one sample in the format of the response
+size_t SmlHistory::Reader::formatSample(uint32_t index)
+{
+    if (_format == FORMAT_BINARY)
+    {
+        uint16_t dtMs = _first ? 0 : _history._dtMs[index];
+        size_t len = 0;
+        _line[len++] = (char)dtMs;
+        _line[len++] = (char)(dtMs >> 8);
+        for (uint8_t channel = 0; channel < SML_HISTORY_CHANNELS; channel++)
+        {
+            uint32_t value = (uint32_t)_history._value[channel][index];
+            for (uint8_t i = 0; i < 4; i++)
+            {
+                _line[len++] = (char)(value >> (8 * i));
+            }
+        }
+        return len;
+    }
+
+    // integer and fraction of the scaled value, no floating point formatting
+    // ms as s and ms, printf of the ESP8266 may not support long long
+    int len = (_nextMs >= 1000)
+              ? snprintf(_line, sizeof(_line), "%s\n[%lu%03u", _first ? "" : ",", (unsigned long)(_nextMs / 1000),
+                         (unsigned)(_nextMs % 1000))
+              : snprintf(_line, sizeof(_line), "%s\n[%u", _first ? "" : ",", (unsigned)_nextMs);
+    for (uint8_t channel = 0; channel < SML_HISTORY_CHANNELS; channel++)
+    {
+        int32_t value = _history._value[channel][index];
+        if (value == SML_HISTORY_NO_VALUE)
+        {
+            len += snprintf(_line + len, sizeof(_line) - len, ",null");
+        }
+        else
+        {
+            _line[len++] = ',';
+            len += smlDecimalFormat(_line + len, sizeof(_line) - len, value, -SML_HISTORY_DECIMALS, SML_HISTORY_DECIMALS);
+        }
+    }
+    len += snprintf(_line + len, sizeof(_line) - len, "]");
+    return len;
+}
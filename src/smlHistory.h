@@ -0,0 +1,78 @@
+#ifndef SML_HISTORY_H
+#define SML_HISTORY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "config.h"
+#include "smlDecimal.h"
+
+#define SML_HISTORY_NO_VALUE INT32_MIN      // no value of the channel in the telegram or gap
+
+// ring buffer of the values of the last SML_HISTORY_SAMPLES telegrams in RAM (see smlHistory.cpp)
+class SmlHistory
+{
+public:
+    enum Format
+    {
+        FORMAT_JSON,
+        FORMAT_BINARY
+    };
+
+    // samples fromMs <= ms <= toMs in chunks; samples added later are not part of the response
+    class Reader
+    {
+    public:
+        Reader(SmlHistory &history, uint64_t fromMs, uint64_t toMs, Format format);
+        size_t read(uint8_t *buffer, size_t maxLen);    // 0: end of the response
+
+    private:
+        enum Part
+        {
+            HEADER,
+            CHANNELS,                       // JSON: one name per line
+            SAMPLES,
+            FOOTER,
+            DONE
+        };
+        bool nextLine();
+        size_t formatSample(uint32_t index);
+
+        SmlHistory &_history;
+        Format _format;
+        Part _part = HEADER;
+        uint64_t _toMs;
+        uint32_t _end;                      // sequence after the last sample of the response
+        uint32_t _next;                     // sequence of the next sample
+        uint64_t _nextMs;                   // its time stamp
+        bool _first = true;
+        uint8_t _channel = 0;
+        char _line[80 + SML_HISTORY_CHANNELS * 16];
+        size_t _lineLen = 0;
+        size_t _linePos = 0;
+    };
+
+    void setChannel(uint8_t channel, const char *name) { _name[channel] = name; }
+    // SML_HISTORY_CHANNELS values in 10^-SML_VALUE_DECIMALS, SML_VALUE_NONE: no value
+    void add(uint64_t ms, const int64_t *values);
+    void clear();
+    uint16_t count() { return _count; }
+    uint64_t firstMs() { return _firstMs; }
+    uint64_t lastMs() { return _lastMs; }
+
+private:
+    void push(uint16_t dtMs, const int32_t *values);
+    uint32_t oldest() { return _sequence - _count; }
+    uint16_t index(uint32_t sequence) { return (_head + (sequence - oldest())) % SML_HISTORY_SAMPLES; }
+
+    // structure of arrays: the time deltas and the values of a channel are contiguous
+    uint16_t _dtMs[SML_HISTORY_SAMPLES];    // ms since the previous sample
+    int32_t _value[SML_HISTORY_CHANNELS][SML_HISTORY_SAMPLES];
+    uint16_t _head = 0;                     // oldest sample
+    uint16_t _count = 0;
+    uint32_t _sequence = 0;                 // samples added so far, sequence of the next sample
+    uint64_t _firstMs = 0;                  // time stamp of the oldest sample
+    uint64_t _lastMs = 0;                   // time stamp of the newest sample
+    const char *_name[SML_HISTORY_CHANNELS] = {};
+};
+
+#endif // SML_HISTORY_H
@@ -1,13 +1,42 @@
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
-#include <ESP8266HTTPClient.h>
 #include "config.h"
 #include "smlHttp.h"
 #include "smlDebug.h"
+#include "smlProfile.h"
 
 /* *** smlHttp.cpp
 
 transfer data to and from a web server
 
+2026-10-17 mh
+- http transfer via HttpTransport of hal.h (HTTPClient moved to halArduino.cpp), added setTransport()
+- system time via halClock()
+- char buffers instead of String for url, body and time stamp; allows the host (native) build
+- publish(): Sensor::pump() after each post, the serial input is buffered while http blocks
+- publishEntry(): evaluation of one list entry (SmlObisEntry) of the libsml tree or of SmlObisReader
+- one local time stamp per message
+- OBIS routing by 48 bit keys instead of sprintf + strcmp; debugEntry() only with SERIAL_DEBUG
+- channel table (SmlHttpConfig::channel, smlChannel.h), values posted by flush() at the end of the telegram
+- url built once by setServerName()/setMiddlewareName(); persistent connection of the transport
+- batches of tuples per channel posted to data/<uuid>.json (sendBatch(), sendBatches(), getBatchStats())
+- init() keeps the tuples not posted yet of the channels whose UUID is still in the table
+- loop() and busy() for the asynchronous transport (smlAsyncHttp.cpp, VZ_HTTP_ASYNC)
+- setBacklog(): batches the server does not take are stored in flash (smlBacklog.cpp)
+- requestDone(): failed batches of the asynchronous transport to the backlog, backlog consumed on the response
+- the backlog is bound to the UUIDs of the channels (SmlBacklog::bind())
+- setHistory(): the values of each telegram are added to the history in RAM (smlHistory.cpp)
+- publishPolicy(): relative deadband, max interval (heartbeat), change of direction (getPublishStats())
+- aggregate(): mean, min, max or mean power per window; an OBIS id may be routed to several channels
+- channels with "derive": power from the steps of the energy counter (smlDerive.cpp)
+- values as scaled integers (smlDecimal.cpp) from the entry to the http body, no double per entry
+- time stamp of a telegram in ms from its start sequence (Sensor::frameEpochMs(), smlTime.cpp)
+- several meters: channels, time stamp and counters per meter (getMeterStats()), setScheduler()
+- Sensor::receive() / SmlScheduler::receive() between the posts instead of pump()
+- layout cache per meter (smlLayout.cpp): publishCached() and learnLayout()
+- publishDecoded(): the entries decoded by the sensor during the reception (smlStream.cpp)
+
 2023-02-27 mh
 - split up input for server url
 - not transmission, if uuid = VZ_UUID_NO_SEND
@@ -52,9 +81,18 @@ The http implementation follows the example in https://RandomNerdTutorials.com/e
 myHttp.init(SmlHttpConfig &config)              // initialize class with server name and channel UUIDs
 myHttp.postHttp(vzUUID, s_timeStamp, value);    // post value to Volkszaehler
 myHttp.publish(sensor, file);                   // evaluate and filter SML file messages and call postHttp()
+myHttp.publish(sensor, message, len);           // the same directly on the message bytes (zero-copy, SmlObisReader)
+myHttp.publishDecoded(sensor, message);         // entries decoded during the reception, false: parse the message
+myHttp.publishCached(sensor, message, len);     // by the learned layout of the meter, false: parse completely
+myHttp.sendBatches(sensor);                     // post the collected tuples of all channels now
+myHttp.loop();                                  // in loop(): send the queued requests (asynchronous transport)
+myHttp.setBacklog(&backlog);                    // store-and-forward of the batches the server did not take
+myHttp.setHistory(&history);                    // values of the last telegrams in RAM (/history)
+myHttp.setScheduler(&scheduler);                // several reading heads: reception of all of them while http blocks
 myHttp.testHttp();                              // create test output and call postHttp()
-myHttp.getTimeStamp();                          // returns TimeStamp string
-myHttp.getValue(UuidValueName _select);             // returns selected Obis value of an SML message, valid only with publish()
+myHttp.getTimeStamp(meter);                     // returns TimeStamp string of the last tuple of the meter
+myHttp.getValue(UuidValueName _select);         // returns the value of the test channel
+myHttp.getObisValue(smlObisKey(OBIS_ID_POWER_IN), meter); // returns the value of a channel, valid only with publish()
 ```
 Server name and Volkszaehler channel UUIDs are provided via struct SmlHttpConfig.
 
@@ -66,12 +104,63 @@ For transfer to volkszaehler, the http transfer should look like this:
 // http://volks-raspi/middleware.php/data.json?uuid=ae53c580-5549-11ed-84a0-cfe6bdf4d646&operation=add&ts=1666801000000&value=22
 ```
 
-Implementation is done using class HTTPClient.
+Implementation is done using the HttpTransport of hal.h (class HTTPClient on the ESP8266).
+The transport keeps one HTTP/1.1 connection to the server open (VZ_HTTP_KEEP_ALIVE) and resolves the server name
+only once (VZ_HTTP_RESOLVE_ONCE, the Host header keeps the name), a lost connection is set up again by the next
+post.
+With VZ_HTTP_ASYNC the transport is AsyncHttpTransport (smlAsyncHttp.cpp): a post only queues the request
+(HTTP_QUEUED) and loop() sends it, i.e. the application loop and the sensor input go on during the round trip.
+A full queue (HTTP_QUEUE_FULL) is back pressure, not a server error: the batch stays in the channel.
+After each post postTuples() calls Sensor::receive() (SmlScheduler::receive() with several reading heads), so the
+next telegram is framed into a spare frame buffer while a telegram is published.
 
 publish():  
 The publish() method evaluates the SML messages of the SML file structure extracting Obis name of channels and the data.  
-The timestamp is created locally based on the system time.  
-Sensor is only used to extract configuration data (name of meter, numeric flag).
+The entries are either taken from the libsml tree (sml_file_parse()) or read in place by SmlObisReader (smlObis.cpp);
+both end up in publishEntry() as SmlObisEntry.  
+A meter repeats the structure of its telegram, so publish() of the message bytes records the offsets of the entries
+routed to a channel of the meter (SmlObisLayout, smlLayout.cpp, one per meter) and evaluates the next telegrams of
+the same structure by these offsets (publishCached()): one number per channel instead of the walk over all entries.
+A telegram of another structure is parsed completely and its layout learned. With libsml smlProcessFrame() calls
+publishCached() first and learnLayout() after a complete parse. Not with SERIAL_DEBUG (debugEntry() of all entries).  
+Before both, publishDecoded() takes the entries the sensor decoded while the telegram was received (SmlObisStream,
+smlStream.cpp), i.e. the processing of a telegram starts with its entries already parsed; they are used only if the
+CRC of the telegram committed them.  
+publishEntry() compares the 48 bit OBIS key of the entry with the keys of the channels in use (SmlHttpConfig::channel,
+converted once by init()) and stores the value in the channel, a later entry of the same telegram overwrites it.
+At the end of the telegram flush() posts the values of the channels that pass the publish policy of the channel
+(publishPolicy(): min interval, absolute or relative deadband, max interval as heartbeat, change of direction, see
+smlChannel.cpp), i.e. the parsing of a telegram is not interrupted by http and each channel is posted at most once
+per telegram, independent of the number of channels in the table. getPublishStats() counts the sent and the
+suppressed values.  
+A channel with an aggregate (mean, min, max, power) adds the values to a window of min interval s instead and posts
+one tuple per window (aggregate()), so peaks are kept while one value per window is uploaded.  
+A channel with "derive" gets the power calculated from the steps of its energy counter (SmlPowerDerivation,
+smlDerive.cpp) with the time of the start sequence of the telegram (Sensor::frameMs()) instead of the counter.  
+The tuples (timestamp, value) of a channel are collected in a batch of up to VZ_BATCH_TUPLES tuples. At the end of a
+telegram a batch that is full or whose first tuple is older than VZ_BATCH_MAX_AGE is posted by sendBatch()
+in one request with the multi-value JSON body of the middleware:
+```bash
+POST http://volks-raspi/middleware.php/data/ae53c580-5549-11ed-84a0-cfe6bdf4d646.json
+[[1666801000000,22.00],[1666801002000,23.00],[1666801004000,21.00]]
+```
+If the server cannot be reached (or answers 5xx) the batch is kept and posted with the next telegram,
+a full batch then drops its oldest tuple (SmlBatchStats::dropped).  
+With a backlog (setBacklog(), VZ_BACKLOG) the tuples of such a batch are written to flash instead (SmlBacklog).
+As long as the server answers, flush() posts up to VZ_BACKLOG_DRAIN requests of the backlog per telegram, each with
+the oldest tuples of one channel. With the asynchronous transport the result of a request comes later by
+requestDone() (HttpListener): sendBatch() keeps the tuples of a queued batch with the id of its request, they go to
+the backlog if the server did not take them after VZ_HTTP_ATTEMPTS tries; a full batch goes to the backlog too.
+One backlog request at a time is posted when the queue is empty; its records are consumed only when the server
+answered it, and loop() posts the next one.  
+The timestamp (ms) of all values of a telegram is the time Sensor found its start sequence (Sensor::frameEpochMs(),
+monotonic millis64() corrected to the system/NTP time by SmlTimeBase, smlTime.cpp).  
+Sensor provides configuration data (name of meter, numeric flag) and the time stamps of the telegram.  
+With several reading heads (SmlScheduler, smlScheduler.cpp) each channel belongs to one meter (Sensor::meter, word
+meter<n> of the channel): publishEntry() routes an entry only to the channels of the meter of the telegram and
+flush() evaluates only those, so the telegrams of the meters may follow each other in any order. The batches of the
+channels are the queues of the meters, one meter with a server error does not hold back the tuples of the others;
+the requests of all meters share the transport. Time stamp of the last post and SmlMeterStats are kept per meter.
 
 *** end description *** */
 
@@ -86,13 +175,21 @@ Sensor is only used to extract configuration data (name of meter, numeric flag).
   (see in Tools > Boards > Boards Manager > ESP8266)
 */
 
-String baseTopic="";      // was used as root for MQTT
-WiFiClient _client;
-HTTPClient http;
+const char *baseTopic="";      // was used as root for MQTT
 // const char* _serverName="http://volks-raspi/middleware.php/data.json";
 
+SmlHttpConfig::SmlHttpConfig()
+{
+  static const char *defaults[] = SML_CHANNEL_DEFAULTS;
+  for (uint16_t i = 0; i < SML_CHANNELS_MAX; i++)
+  {
+    smlChannelParse((i < sizeof(defaults) / sizeof(defaults[0])) ? defaults[i] : "", &channel[i]);
+  }
+}
+
 SmlHttp::SmlHttp()
 {
+  _transport = halHttpTransport();      // options are set by init(), the transport may not be constructed yet
   uint16_t i;
   for (i=0;i<N_UUID_VALUE;i++)
   {
@@ -101,10 +198,12 @@ SmlHttp::SmlHttp()
 }
 
 void SmlHttp::init(SmlHttpConfig &config) {
-  _serverName = String(config.vzServer);
-  _middlewareName = String(config.vzMiddleware);
-  DEBUG_TRACE(VERBOSE_LEVEL_HTTP,"vzServer: %s",_serverName.c_str());
-  DEBUG_TRACE(VERBOSE_LEVEL_HTTP,"vzMiddleware: %s",_middlewareName.c_str());
+  _config = &config;
+  setTransport(_transport);
+  setServerName(config.vzServer);
+  setMiddlewareName(config.vzMiddleware);
+  DEBUG_TRACE(VERBOSE_LEVEL_HTTP,"vzServer: %s",_serverName);
+  DEBUG_TRACE(VERBOSE_LEVEL_HTTP,"vzMiddleware: %s",_middlewareName);
 
   uint16_t i;
   for (i=0;i<N_UUID_VALUE;i++)
@@ -113,70 +212,208 @@ void SmlHttp::init(SmlHttpConfig &config) {
     DEBUG_TRACE(VERBOSE_LEVEL_HTTP,"uuid[%d] = %s",i,_uuid[i]);
   }
 
+  // the tuples not posted yet go to the channel of the same UUID in the new table; the channels of the previous
+  // table not placed yet are kept in _channel[_channels..previous)
+  uint8_t previous = _channels;
+  _channels = 0;
+  for (i=0;i<SML_CHANNELS_MAX;i++)
+  {
+    const SmlChannelConfig &channelConfig = config.channel[i];
+    if (!smlChannelUsed(channelConfig) || !strcmp(channelConfig.uuid, VZ_UUID_NO_SEND))
+    {
+      continue;
+    }
+    uint32_t uuidHash = smlChannelUuidHash(channelConfig.uuid);
+    uint8_t n = _channels++;
+    uint8_t j = n;
+    while (j < previous && _channel[j].uuidHash != uuidHash)
+    {
+      j++;
+    }
+    bool carried = (j < previous);
+    if (carried)
+    {
+      swapChannels(n, j);
+    }
+    else if (n < previous && previous < SML_CHANNELS_MAX)
+    {
+      swapChannels(n, previous++);      // may be the channel of a later UUID
+    }
+    else if (n < previous)
+    {
+      dropTuples(_channel[n]);
+    }
+    Channel &channel = _channel[n];
+    channel.uuidHash = uuidHash;
+    channel.key = smlObisKey(channelConfig.obis);
+    channel.id = i;
+    channel.meter = smlChannelMeter(channelConfig);
+    channel.config = &channelConfig;
+    // factor and deadband as scaled integers, the float of the EEPROM is converted once
+    char text[24];
+    int64_t mantissa;
+    int8_t scaler;
+    snprintf(text, sizeof(text), "%.7g", channelConfig.factor);
+    if (!smlDecimalParse(text, &channel.factor, &channel.factorScaler))
+    {
+      channel.factor = 1;
+      channel.factorScaler = 0;
+    }
+    snprintf(text, sizeof(text), "%.7g", channelConfig.deadband);
+    if (!smlDecimalParse(text, &mantissa, &scaler) || !smlDecimalScale(mantissa, scaler, SML_VALUE_DECIMALS, &channel.deadband))
+    {
+      channel.deadband = INT64_MAX;
+    }
+    channel.value = 0;
+    channel.pending = false;
+    channel.valid = false;
+    if (!carried)
+    {
+      channel.tuples = 0;
+    }
+    channel.count = 0;
+    channel.derive.reset();
+    DEBUG_TRACE(VERBOSE_LEVEL_HTTP,"channel[%d] = %d-%d:%d.%d.%d*%d -> %s",i,channelConfig.obis[0],channelConfig.obis[1],
+                channelConfig.obis[2],channelConfig.obis[3],channelConfig.obis[4],channelConfig.obis[5],channelConfig.uuid);
+  }
+  for (i=_channels;i<previous;i++)
+  {
+    dropTuples(_channel[i]);            // UUID not in the table any more
+  }
+  for (i=0;i<SML_METERS_MAX;i++)
+  {
+    _meter[i].layout.reset();           // the routed entries depend on the channels
+  }
+  setBacklog(_backlog);
+  setHistory(_history);
+
 };
-void SmlHttp::setServerName(String serverName) {
-  _serverName = serverName;
+
+void SmlHttp::swapChannels(uint8_t a, uint8_t b)
+{
+  Channel channel = _channel[a];
+  _channel[a] = _channel[b];
+  _channel[b] = channel;
+}
+
+void SmlHttp::dropTuples(Channel &channel)
+{
+  _batchStats.dropped += channel.tuples;
+  _meter[channel.meter].stats.dropped += channel.tuples;
+  channel.tuples = 0;
+}
+void SmlHttp::setTransport(HttpTransport *transport)
+{
+  _transport = transport;
+  _transport->setKeepAlive(VZ_HTTP_KEEP_ALIVE);
+  _transport->setResolveOnce(VZ_HTTP_RESOLVE_ONCE);
+  _transport->setListener(this);
 };
 
-void SmlHttp::setMiddlewareName(String middlewareName)
+void SmlHttp::loop()
 {
-  _middlewareName = middlewareName;
+  _transport->loop();
+  if (_drainNext)
+  {
+    _drainNext = false;
+    drainBacklog(NULL);
+  }
+}
+
+void SmlHttp::setServerName(const char *serverName) {
+  snprintf(_serverName, sizeof(_serverName), "%s", serverName);
+  setUrl();
 };
 
-int SmlHttp::postHttp(String vzUUID, String timeStamp, double value)
+void SmlHttp::setMiddlewareName(const char *middlewareName)
 {
-    //For transfer to volkszaehler, the http transfer should look like this:
-    // http://volks-raspi/middleware.php/data.json?uuid=ae53c580-1234-5678-90ab-cdefghijklmn&operation=add&ts=1666801000000&value=22
+  snprintf(_middlewareName, sizeof(_middlewareName), "%s", middlewareName);
+  setUrl();
+};
 
-  if(!strcmp(vzUUID.c_str(),VZ_UUID_NO_SEND))
+void SmlHttp::setBacklog(SmlBacklog *backlog)
+{
+  _backlog = backlog;
+  for (uint8_t i = 0; i < _channels && _backlog != NULL; i++)
   {
-    return -99;
+    _backlog->bind(_channel[i].id, _channel[i].uuidHash);   // records of a previous UUID are not posted to this one
   }
-  String vzUrl = "http://";
-  vzUrl += _serverName + "/" + _middlewareName;
-  vzUrl += "/" + String(VZ_DATA_JSON);
+}
 
-  if(!http.begin(_client, vzUrl))
+void SmlHttp::setHistory(SmlHistory *history)
+{
+  _history = history;
+  _historyMeters = 0;
+  for (uint8_t i = 0; i < SML_HISTORY_CHANNELS && _history != NULL; i++)
   {
-    DEBUG_TRACE(VERBOSE_LEVEL_HTTP,"No connection to %s",_serverName.c_str());
-    return 404;
-  };
+    _history->setChannel(i, (i < _channels) ? _channel[i].config->uuid : "");
+    _historyMeters |= (i < _channels) ? 1 << _channel[i].meter : 0;
+  }
+}
 
-  //http.setAuthorization("REPLACE_WITH_SERVER_USERNAME", "REPLACE_WITH_SERVER_PASSWORD");
+void SmlHttp::setScheduler(SmlScheduler *scheduler)
+{
+  _scheduler = scheduler;
+}
 
-  this->_TimeStamp = timeStamp + "000";    // store internally in ms
+void SmlHttp::setUrl()
+{
+  snprintf(_url, sizeof(_url), "http://%s/%s/%s", _serverName, _middlewareName, VZ_DATA_JSON);
+  snprintf(_batchUrl, sizeof(_batchUrl), "http://%s/%s/data/", _serverName, _middlewareName);
+}
 
-  // HTTP request with a content type: x-www-form-urlencoded
-  http.addHeader("Content-Type", "application/x-www-form-urlencoded");
+int SmlHttp::postHttp(const char *vzUUID, const char *timeStamp, double value)
+{
+    //For transfer to volkszaehler, the http transfer should look like this:
+    // http://volks-raspi/middleware.php/data.json?uuid=ae53c580-1234-5678-90ab-cdefghijklmn&operation=add&ts=1666801000000&value=22
+
+  if(!strcmp(vzUUID,VZ_UUID_NO_SEND))
+  {
+    return -99;
+  }
+  snprintf(_meter[0].timeStamp, sizeof(_meter[0].timeStamp), "%s000", timeStamp);    // store internally in ms
 
   //construct the message body
   //example for data to be sent: uuid=ae53c580-1234-5678-90ab-cdefghijklmn&operation=add&ts=1666801000000&value=22
+  char httpRequestData[sizeOfUUID + 80];
+  snprintf(httpRequestData, sizeof(httpRequestData), "uuid=%s&ts=%s000&value=%.2f",   // convert seconds to milli seconds
+           vzUUID, timeStamp, value);
 
-   String httpRequestData = "uuid=" + vzUUID;
-   String httpOperation = "&operation=add";
-   
-   String s_timestamp = "&ts=";
-   s_timestamp += timeStamp;
-   s_timestamp += "000";              // convert seconds to milli seconds
-   
-   String s_value = "&value="; 
-   s_value += String(value);
-   
-   httpRequestData = httpRequestData + s_timestamp + s_value;
-
-  DEBUG_TRACE(VERBOSE_LEVEL_HTTP,"Post message: %s",httpRequestData.c_str());
+  DEBUG_TRACE(VERBOSE_LEVEL_HTTP,"Post message: %s",httpRequestData);
 
-  int httpResponseCode = http.POST(httpRequestData);
+  // HTTP request with a content type: x-www-form-urlencoded
+  int httpResponseCode = _transport->post(_url, "application/x-www-form-urlencoded", httpRequestData);
+  if(httpResponseCode < 0)
+  {
+    DEBUG_TRACE(VERBOSE_LEVEL_HTTP,"No connection to %s",_serverName);
+  }
 
   DEBUG_TRACE(VERBOSE_LEVEL_HTTP,"HTTP Response code: %d",httpResponseCode);
-      
-  // Free resources
-  http.end();
   return httpResponseCode;
 };
 
+// time stamp of the local system time in sec
+void SmlHttp::localTimeStamp(char *timeStamp, size_t size)
+{
+  // Note: my meter does not send time, therefore we use local time
+  struct timeval tv;                      // defined in time.h
+  halClock()->getTimeOfDay(&tv);          // use local time; note that usec also contains ms --> divide by 1000 to get ms
+  snprintf(timeStamp, size, "%ld", (long)tv.tv_sec);    // timestamp with resolution of 1 sec
+}
+
+// epoch ms of the start sequence of the telegram; without a sensor (or before its first telegram) the time now
+uint64_t SmlHttp::frameTime(Sensor *sensor)
+{
+    if (sensor != NULL && sensor->frameEpochMs() != 0)
+    {
+      return sensor->frameEpochMs();
+    }
+    return smlTimeBase()->epochMs(millis64());
+}
+
 void SmlHttp::publish(Sensor *sensor, sml_file *file)
 {
+    uint64_t timeMs = frameTime(sensor);
 
     for (int i = 0; i < file->messages_len; i++)
     {
@@ -188,114 +425,637 @@ void SmlHttp::publish(Sensor *sensor, sml_file *file)
         body = (sml_get_list_response *)message->message_body->data;
         for (entry = body->val_list; entry != NULL; entry = entry->next)
         {
-          if (!entry->value)
+          SmlObisEntry obisEntry;
+          if (!smlObisFromList(entry, &obisEntry))
           { // do not crash on null value
             continue;
           }
+          this->publishEntry(sensor, obisEntry);
+        }
+      }
+    }
+    this->flush(sensor, timeMs);
+}
 
-          char obisIdentifier[32];
-          char buffer[255];
-          String s_timestamp;
-          String _vzUUID;
-
-          sprintf(obisIdentifier, "%d-%d:%d.%d.%d*%d",              // adapted to VZ, original was: "%d-%d:%d.%d.%d/%d"
-                  entry->obj_name->str[0], entry->obj_name->str[1],
-                  entry->obj_name->str[2], entry->obj_name->str[3],
-                  entry->obj_name->str[4], entry->obj_name->str[5]);
-
-          // construction of MQTT path - currently used only for DEBUG
-          String entryTopic = baseTopic + "sensor/" + (sensor->config->name) + "/obis/" + obisIdentifier + "/";
-
-          // check for time stamp or use local time
-          // Note: my meter does not send time, therefore we use local time
-#if 0
-          struct timeval tv;      // defined in time.h
-          if (entry->val_time) { /* use time from meter */
-            tv.tv_sec = *entry->val_time->data.timestamp;
-            tv.tv_usec = 0;
-            DEBUG("Use meter time %ldsec %ldus",tv.tv_sec,tv.tv_usec);
-          } else {
-            gettimeofday(&tv, NULL); /* use local time */
-            DEBUG("Use local time %ldsec %ldus",tv.tv_sec,tv.tv_usec);
-          }
+void SmlHttp::publish(Sensor *sensor, const byte *message, size_t len)
+{
+    if (publishDecoded(sensor, message) || publishCached(sensor, message, len))
+    {
+      return;
+    }
+    uint64_t timeMs = frameTime(sensor);
+
+    // complete parse, the layout of the meter is learned on the way
+    SmlObisLayout *layout = _layoutCache ? &_meter[sensor ? sensor->meter : 0].layout : NULL;
+    if (layout)
+    {
+      layout->begin(len);
+    }
+    SmlObisReader reader(message, len);
+    SmlObisEntry entry;
+    while (true)
+    {
+      {
+        SML_PROFILE_SCOPE(PROFILE_PARSE);
+        if (!reader.next(&entry))
+        {
+          break;
+        }
+      }
+      SML_PROFILE_SCOPE(PROFILE_PUBLISH);
+      bool routed = this->publishEntry(sensor, entry);
+      if (layout)
+      {
+        layout->add(message, reader, entry, routed);
+      }
+    }
+    if (layout)
+    {
+      layout->end(!reader.error());
+    }
+    if (reader.error())
+    {
+      DEBUG("SML message could not be parsed completely.");
+    }
+    SML_PROFILE_SCOPE(PROFILE_PUBLISH);
+    this->flush(sensor, timeMs);
+}
+
+bool SmlHttp::publishDecoded(Sensor *sensor, const byte *message)
+{
+    const SmlObisStream *entries = sensor ? sensor->frameEntries() : NULL;
+    if (entries == NULL || !entries->committed())
+    {
+      return false;
+    }
+    uint64_t timeMs = frameTime(sensor);
+    SML_PROFILE_SCOPE(PROFILE_PUBLISH);
+    for (uint8_t i = 0; i < entries->count(); i++)
+    {
+      SmlObisEntry entry;
+      entries->entry(message, i, &entry);
+      this->publishEntry(sensor, entry);
+    }
+    this->flush(sensor, timeMs);
+    return true;
+}
+
+bool SmlHttp::publishCached(Sensor *sensor, const byte *message, size_t len)
+{
+    if (!_layoutCache)
+    {
+      return false;
+    }
+    SmlObisLayout &layout = _meter[sensor ? sensor->meter : 0].layout;
+    {
+      SML_PROFILE_SCOPE(PROFILE_PARSE);
+      if (!layout.match(message, len))
+      {
+        return false;
+      }
+    }
+    uint64_t timeMs = frameTime(sensor);
+    SML_PROFILE_SCOPE(PROFILE_PUBLISH);
+    for (uint8_t i = 0; i < layout.count(); i++)
+    {
+      SmlObisEntry entry;
+      layout.entry(message, i, &entry);
+      this->publishEntry(sensor, entry);
+    }
+    this->flush(sensor, timeMs);
+    return true;
+}
+
+void SmlHttp::learnLayout(Sensor *sensor, const byte *message, size_t len)
+{
+    if (!_layoutCache)
+    {
+      return;
+    }
+    uint8_t meter = sensor ? sensor->meter : 0;
+    SmlObisLayout &layout = _meter[meter].layout;
+    SML_PROFILE_SCOPE(PROFILE_PARSE);
+    layout.begin(len);
+    SmlObisReader reader(message, len);
+    SmlObisEntry entry;
+    while (reader.next(&entry))
+    {
+      bool numeric = (entry.type == SML_TYPE_INTEGER) || (entry.type == SML_TYPE_UNSIGNED);
+      layout.add(message, reader, entry, numeric && routed(smlObisKey(entry.obis), meter));
+    }
+    layout.end(!reader.error());
+}
+
+bool SmlHttp::routed(uint64_t key, uint8_t meter)
+{
+    for (uint8_t i = 0; i < _channels; i++)
+    {
+      if (_channel[i].key == key && _channel[i].meter == meter)
+      {
+        return true;
+      }
+    }
+    return false;
+}
+
+// the OBIS ids of config.h are used for the dash board and as default channels
+static_assert(smlObisKey(OBIS_ID_ENERGY_IN) != SML_OBIS_INVALID, "invalid OBIS_ID_ENERGY_IN in config.h");
+static_assert(smlObisKey(OBIS_ID_ENERGY_OUT) != SML_OBIS_INVALID, "invalid OBIS_ID_ENERGY_OUT in config.h");
+static_assert(smlObisKey(OBIS_ID_POWER_IN) != SML_OBIS_INVALID, "invalid OBIS_ID_POWER_IN in config.h");
+
+bool SmlHttp::publishEntry(Sensor *sensor, const SmlObisEntry &entry)
+{
+#if (SERIAL_DEBUG)
+    debugEntry(sensor, entry);
 #endif
-          struct timeval tv;                      // defined in time.h
-          gettimeofday(&tv, NULL);                // use local time; note that usec also contains ms --> divide by 1000 to get ms
-          s_timestamp = String(tv.tv_sec);        // timestamp with resolution of 1 sec
 
-          if (((entry->value->type & SML_TYPE_FIELD) == SML_TYPE_INTEGER) ||
-              ((entry->value->type & SML_TYPE_FIELD) == SML_TYPE_UNSIGNED))
-          {
-            double value = sml_value_to_double(entry->value);
-            int scaler = (entry->scaler) ? *entry->scaler : 0;
-            int prec = -scaler;
-            if (prec < 0)
-              prec = 0;
-            value = value * pow(10, scaler);
-            sprintf(buffer, "%.*f", prec, value);
-            DEBUG("%s: %s",entryTopic.c_str(), buffer);   // buffer contains the value as string in float format
-
-//            publish(entryTopic + "value", buffer);   /* old, for MQTT */
-
-            // we publish only numeric data, other parts below are kept for future use
-            // we are interested only in specific data
-
-            if( 0 == strcmp(obisIdentifier,OBIS_ID_ENERGY_IN))
-            {
-              _vzUUID = String(_uuid[vzENERGY_IN]);
-              this->postHttp(_vzUUID, s_timestamp, value);
-              // this->_TimeStamp = s_timestamp; done in postHttp()
-              this->_value[vzENERGY_IN] = value;
-            }
-            else if( 0 == strcmp(obisIdentifier,OBIS_ID_ENERGY_OUT))
-            {
-              _vzUUID = String(_uuid[vzENERGY_OUT]);
-              this->postHttp(_vzUUID, s_timestamp, value);
-              // this->_TimeStamp = s_timestamp;  done in postHttp()
-              this->_value[vzENERGY_OUT] = value;
-            }
-            else if( 0 == strcmp(obisIdentifier,OBIS_ID_POWER_IN))
-            {
-              _vzUUID = String(_uuid[vzPOWER_IN]);
-              this->postHttp(_vzUUID, s_timestamp, value);
-              // this->_TimeStamp = s_timestamp;  // done in postHttp()
-              this->_value[vzPOWER_IN] = value;
-            }
-            else
-            {
-              /* do nothing */
-            }
-          }
-          else if (!sensor->config->numeric_only)
+    // we publish only numeric data of the configured channels
+    if ((entry.type != SML_TYPE_INTEGER) && (entry.type != SML_TYPE_UNSIGNED))
+    {
+      return false;
+    }
+    uint64_t key = smlObisKey(entry.obis);
+    uint8_t meter = sensor ? sensor->meter : 0;
+    bool routed = false;
+    for (uint8_t i = 0; i < _channels; i++)
+    {
+      Channel &channel = _channel[i];
+      if (channel.key == key && channel.meter == meter)
+      {
+        routed = true;
+        // posted by flush() at the end of the telegram; the same OBIS id may feed several channels
+        if (channel.config->flags & SML_CHANNEL_DERIVE)
+        {
+          // power from the steps of the counter at the time of the telegram, in mW = 10^-SML_VALUE_DECIMALS W
+          if (channel.derive.add(entry.value, entry.scaler, sensor ? sensor->frameMs() : halClock()->millis(), &channel.value))
           {
-            if (entry->value->type == SML_TYPE_OCTET_STRING)
-            {
-              char *value;
-              sml_value_to_strhex(entry->value, &value, true);
-//             publish(entryTopic + "value", value);
-              DEBUG("%s: %s",entryTopic.c_str(), value);
-
-              free(value);
-            }
-            else if (entry->value->type == SML_TYPE_BOOLEAN)
-            {
-//              publish(entryTopic + "value", entry->value->data.boolean ? "true" : "false");
-              DEBUG("%s: %s",entryTopic.c_str(), entry->value->data.boolean ? "true" : "false");
-            }
+            channel.pending = true;
           }
+          continue;
         }
+        // scaled integer, no floating point (smlDecimal.cpp)
+        channel.pending = smlDecimalScale(entry.value, entry.scaler, SML_VALUE_DECIMALS, &channel.value);
       }
     }
+    return routed;
 }
 
-String SmlHttp::getTimeStamp()
+// add the values of the telegram to the batches of the channels, post the batches that are full or old enough
+void SmlHttp::flush(Sensor *sensor, uint64_t timeMs)
 {
-  return _TimeStamp;
+    uint32_t now = halClock()->millis();
+    uint8_t meter = sensor ? sensor->meter : 0;
+    SmlMeterStats &stats = _meter[meter].stats;
+    stats.telegrams++;
+    if (_history != NULL && (_historyMeters & (1 << meter)))
+    {
+      addHistory(meter, timeMs);
+    }
+    for (uint8_t i = 0; i < _channels; i++)
+    {
+      Channel &channel = _channel[i];
+      if (!channel.pending || channel.meter != meter)
+      {
+        continue;
+      }
+      channel.pending = false;
+      int64_t value = smlDecimalMultiply(channel.value, channel.factor, channel.factorScaler);
+      uint64_t tupleTs = timeMs;
+      if (channel.config->flags & SML_CHANNEL_AGGREGATE)
+      {
+        Tuple tuple;
+        if (!aggregate(channel, value, timeMs, sensor ? sensor->frameMs() : now, &tuple))
+        {
+          continue;
+        }
+        tupleTs = tuple.ts;
+        value = tuple.value;
+      }
+      else if (!publishPolicy(channel, value, now))
+      {
+        continue;
+      }
+      if (channel.tuples == VZ_BATCH_TUPLES && _backlog != NULL)
+      {
+        storeTuples(channel, channel.batch, channel.tuples);    // the server did not take the batch so far
+        channel.tuples = 0;
+      }
+      else if (channel.tuples == VZ_BATCH_TUPLES)
+      {
+        // the server did not take the batch so far
+        memmove(&channel.batch[0], &channel.batch[1], (VZ_BATCH_TUPLES - 1) * sizeof(Tuple));
+        channel.tuples--;
+        _batchStats.dropped++;
+        stats.dropped++;
+      }
+      if (channel.tuples == 0)
+      {
+        channel.batchMs = now;
+      }
+      channel.batch[channel.tuples].ts = tupleTs;
+      channel.batch[channel.tuples].value = value;
+      channel.tuples++;
+      _batchStats.tuples++;
+      stats.tuples++;
+      channel.posted = value;
+      channel.postedMs = now;
+      channel.valid = true;
+    }
+
+    for (uint8_t i = 0; i < _channels; i++)
+    {
+      Channel &channel = _channel[i];
+      if (channel.tuples == VZ_BATCH_TUPLES ||
+          (channel.tuples > 0 && (now - channel.batchMs) >= VZ_BATCH_MAX_AGE * 1000UL))
+      {
+        sendBatch(sensor, channel);
+      }
+    }
+    if (_backlog != NULL)
+    {
+      drainBacklog(sensor);
+    }
+}
+
+// true if the value of the telegram is posted (see smlChannel.cpp), before any http work
+bool SmlHttp::publishPolicy(Channel &channel, int64_t value, uint32_t now)
+{
+    const SmlChannelConfig &config = *channel.config;
+    if (!channel.valid)
+    {
+      _publishStats.sent++;
+      return true;
+    }
+    if ((config.flags & SML_CHANNEL_DIRECTION) && (value < 0) != (channel.posted < 0))
+    {
+      _publishStats.directions++;
+      _publishStats.sent++;
+      return true;
+    }
+    uint32_t elapsed = now - channel.postedMs;
+    if (elapsed < config.minInterval * 1000UL)
+    {
+      _publishStats.suppressedInterval++;
+      return false;
+    }
+    // relative: |posted| * deadband / 100 %, deadband in 10^-3 %, without an overflow of the product
+    uint64_t posted = (channel.posted < 0) ? 0ULL - (uint64_t)channel.posted : (uint64_t)channel.posted;
+    uint64_t deadband = (config.flags & SML_CHANNEL_RELATIVE)
+                        ? posted / 100000 * channel.deadband + posted % 100000 * channel.deadband / 100000
+                        : (uint64_t)channel.deadband;
+    uint64_t change = (value < channel.posted) ? (uint64_t)channel.posted - (uint64_t)value
+                                               : (uint64_t)value - (uint64_t)channel.posted;
+    if (channel.deadband > 0 && change <= deadband)
+    {
+      if (config.maxInterval == 0 || elapsed < config.maxInterval * 1000UL)
+      {
+        _publishStats.suppressedDeadband++;
+        return false;
+      }
+      _publishStats.heartbeats++;
+    }
+    _publishStats.sent++;
+    return true;
+}
+
+// adds the value to the window of the channel; true with the aggregate of the previous window if ts starts a new one;
+// frameMs: millis() at the start of the telegram, the time base of the mean power
+bool SmlHttp::aggregate(Channel &channel, int64_t value, uint64_t timeMs, uint32_t frameMs, Tuple *tuple)
+{
+    const SmlChannelConfig &config = *channel.config;
+    uint32_t ts = (uint32_t)(timeMs / 1000);
+    uint32_t window = ts - ts % config.minInterval;
+    bool closed = false;
+    _publishStats.aggregated++;
+    if (channel.count > 0 && window != channel.window)
+    {
+      tuple->ts = (uint64_t)(channel.window + config.minInterval) * 1000;    // end of the window
+      switch (config.flags & SML_CHANNEL_AGGREGATE)
+      {
+      case SML_CHANNEL_MIN:
+        tuple->value = channel.min;
+        break;
+      case SML_CHANNEL_MAX:
+        tuple->value = channel.max;
+        break;
+      case SML_CHANNEL_POWER:
+        // up to the first value of this window, so consecutive windows cover the whole counter
+        tuple->value = (frameMs != channel.energyMs) ? (value - channel.energy) * 3600000 / (int64_t)(frameMs - channel.energyMs) : 0;
+        break;
+      default:
+        // rounded half away from zero
+        tuple->value = channel.energy + (channel.sum + ((channel.sum < 0) ? -(int64_t)channel.count : (int64_t)channel.count) / 2) /
+                       (int64_t)channel.count;
+        break;
+      }
+      channel.count = 0;
+      _publishStats.sent++;
+      closed = true;
+    }
+    if (channel.count == 0)
+    {
+      channel.window = window;
+      channel.sum = 0;
+      channel.min = value;
+      channel.max = value;
+      channel.energy = value;
+      channel.energyMs = frameMs;
+    }
+    channel.sum += value - channel.energy;
+    channel.min = (value < channel.min) ? value : channel.min;
+    channel.max = (value > channel.max) ? value : channel.max;
+    channel.count++;
+    return closed;
+}
+
+// values of the telegram (before min interval and deadband) to the history
+void SmlHttp::addHistory(uint8_t meter, uint64_t timeMs)
+{
+    int64_t values[SML_HISTORY_CHANNELS];
+    for (uint8_t i = 0; i < SML_HISTORY_CHANNELS; i++)
+    {
+      values[i] = (i < _channels && _channel[i].pending && _channel[i].meter == meter)
+                  ? smlDecimalMultiply(_channel[i].value, _channel[i].factor, _channel[i].factorScaler) : SML_VALUE_NONE;
+    }
+    _history->add(timeMs, values);
+}
+
+void SmlHttp::sendBatches(Sensor *sensor)
+{
+    for (uint8_t i = 0; i < _channels; i++)
+    {
+      if (_channel[i].tuples > 0)
+      {
+        sendBatch(sensor, _channel[i]);
+      }
+    }
+}
+
+// post the tuples of a channel in one request: [[ts,value],...] to data/<uuid>.json; false if the batch is kept
+bool SmlHttp::sendBatch(Sensor *sensor, Channel &channel)
+{
+    uint8_t n;
+    // with a backlog the tuples of the request are kept in a free slot until requestDone()
+    Request *request = NULL;
+    for (uint8_t i = 0; i < VZ_HTTP_QUEUE && _backlog != NULL && request == NULL; i++)
+    {
+      request = (_request[i].count == 0) ? &_request[i] : NULL;
+    }
+    if (request != NULL)
+    {
+      request->uuidHash = channel.uuidHash;
+    }
+    int httpResponseCode = postTuples(sensor, channel.config->uuid, channel.batch, channel.tuples, &n, request);
+    if (request != NULL && httpResponseCode != HTTP_QUEUED)
+    {
+      request->count = 0;               // not queued: no requestDone()
+    }
+    if (httpResponseCode == HTTP_QUEUE_FULL)
+    {
+      return false;                     // queue of the asynchronous transport full: posted with the next telegram
+    }
+    if (httpResponseCode < 0 || httpResponseCode >= 500)
+    {
+      DEBUG_TRACE(VERBOSE_LEVEL_HTTP,"No connection to %s",_serverName);
+      _online = false;
+      if (_backlog != NULL)
+      {
+        storeTuples(channel, channel.batch, channel.tuples);    // posted when the server answers again
+        channel.tuples = 0;
+      }
+      return false;                     // keep the batch for the next telegram
+    }
+    // posted (or rejected by the server, e.g. unknown UUID: not posted again); queued: requestDone() tells
+    _online = _online || httpResponseCode != HTTP_QUEUED;
+    _batchStats.batches++;
+    _meter[channel.meter].stats.batches++;
+    snprintf(_meter[channel.meter].timeStamp, sizeof(_meter[channel.meter].timeStamp), "%lu%03u", (unsigned long)(channel.batch[n - 1].ts / 1000),
+             (unsigned)(channel.batch[n - 1].ts % 1000));
+    channel.tuples -= n;
+    memmove(&channel.batch[0], &channel.batch[n], channel.tuples * sizeof(Tuple));
+    channel.batchMs = halClock()->millis();
+    return true;
+}
+
+// posted from the backlog when the server answers again
+void SmlHttp::storeTuples(Channel &channel, const Tuple *tuples, uint8_t count)
+{
+    for (uint8_t i = 0; i < count; i++)
+    {
+      _backlog->add(channel.id, (uint32_t)(tuples[i].ts / 1000), (uint16_t)(tuples[i].ts % 1000), tuples[i].value);
+    }
+}
+
+// one request with up to count tuples, *posted: number of tuples in the request; returns the http response code.
+// request: id and tuples of the request are stored before the post, requestDone() may be called by it already
+int SmlHttp::postTuples(Sensor *sensor, const char *uuid, const Tuple *tuples, uint8_t count, uint8_t *posted,
+                        Request *request)
+{
+    char url[sizeof(_batchUrl) + SML_CHANNEL_UUID_LEN + 8];
+    snprintf(url, sizeof(url), "%s%s.json", _batchUrl, uuid);
+
+    char body[VZ_HTTP_BODY_MAX];
+    size_t len = 0;
+    uint8_t n = 0;
+    body[len++] = '[';
+    while (n < count)
+    {
+      // ms (as s and ms, printf of the ESP8266 may not support long long); at most 38 characters per tuple,
+      // the value with 2 decimals by the integer formatter
+      char value[24];
+      smlDecimalFormat(value, sizeof(value), tuples[n].value, -SML_VALUE_DECIMALS, 2);
+      int tupleLen = snprintf(&body[len], sizeof(body) - len, "%s[%lu%03u,%s]", n ? "," : "",
+                              (unsigned long)(tuples[n].ts / 1000), (unsigned)(tuples[n].ts % 1000), value);
+      if (tupleLen < 0 || len + tupleLen + 2 > sizeof(body))
+      {
+        break;                          // the rest is posted by the next request
+      }
+      len += tupleLen;
+      n++;
+    }
+    body[len++] = ']';
+    body[len] = '\0';
+    *posted = n;
+    if (request != NULL)
+    {
+      request->id = _transport->stats.posts + 1;
+      request->count = n;
+      memcpy(request->tuples, tuples, n * sizeof(Tuple));
+    }
+
+    DEBUG_TRACE(VERBOSE_LEVEL_HTTP,"Post batch: %s %s",url,body);
+    int httpResponseCode = _transport->post(url, "application/json", body);
+    if (_scheduler != NULL)
+    {
+      _scheduler->receive();            // keep the reception of all reading heads going while http blocks
+    }
+    else if (sensor != NULL)
+    {
+      sensor->receive();                // keep the reception going while http blocks
+    }
+    DEBUG_TRACE(VERBOSE_LEVEL_HTTP,"HTTP Response code: %d",httpResponseCode);
+    return httpResponseCode;
+}
+
+// post the backlog while the server answers, one channel per request, at most VZ_BACKLOG_DRAIN requests
+void SmlHttp::drainBacklog(Sensor *sensor)
+{
+    // the server answered the last request; asynchronous transport: one backlog request at a time, when the queue
+    // is empty
+    if (!_online || _drainRecords > 0 || _transport->busy())
+    {
+      return;
+    }
+    for (uint8_t request = 0; request < VZ_BACKLOG_DRAIN; request++)
+    {
+      SmlBacklogRecord records[VZ_BATCH_TUPLES];
+      size_t n = _backlog->peek(records, VZ_BATCH_TUPLES);
+      if (n == 0)
+      {
+        return;
+      }
+      Tuple tuples[VZ_BATCH_TUPLES];
+      uint8_t count = 0;
+      while (count < n && records[count].channel == records[0].channel)
+      {
+        tuples[count].ts = (uint64_t)records[count].sec * 1000 + records[count].ms;
+        tuples[count].value = records[count].value;
+        count++;
+      }
+      const SmlChannelConfig *config = (records[0].channel < SML_CHANNELS_MAX) ? &_config->channel[records[0].channel] : NULL;
+      if (config == NULL || !smlChannelUsed(*config) || !strcmp(config->uuid, VZ_UUID_NO_SEND))
+      {
+        _backlog->consume(count, false);                // channel removed from the table
+        continue;
+      }
+      uint8_t posted;
+      // requestDone() may be called by the post already
+      _drainId = _transport->stats.posts + 1;
+      _drainRecords = count;
+      _drainConsumed = _backlog->consumed();
+      int httpResponseCode = postTuples(sensor, config->uuid, tuples, count, &posted);
+      if (httpResponseCode == HTTP_QUEUED)
+      {
+        return;                         // consumed by requestDone() when the server took them
+      }
+      _drainRecords = 0;
+      if (httpResponseCode == HTTP_QUEUE_FULL)
+      {
+        return;
+      }
+      if (httpResponseCode < 0 || httpResponseCode >= 500)
+      {
+        _online = false;
+        return;
+      }
+      _backlog->consume(posted);
+    }
+}
+
+// result of a request of the asynchronous transport
+void SmlHttp::requestDone(uint32_t id, int code)
+{
+    bool failed = (code < 0 || code >= 500);
+    _online = !failed;
+    if (_drainRecords > 0 && id == _drainId)
+    {
+      // the records are still the oldest ones unless the backlog rotated meanwhile
+      if (!failed && _backlog->consumed() == _drainConsumed)
+      {
+        _backlog->consume(_drainRecords);
+        _drainNext = true;
+      }
+      _drainRecords = 0;
+      return;
+    }
+    for (uint8_t i = 0; i < VZ_HTTP_QUEUE; i++)
+    {
+      Request &request = _request[i];
+      if (request.count == 0 || request.id != id)
+      {
+        continue;
+      }
+      // batch of a channel: the tuples go to the backlog, bound to the channel of the same UUID
+      Channel *channel = NULL;
+      for (uint8_t j = 0; j < _channels && channel == NULL; j++)
+      {
+        channel = (_channel[j].uuidHash == request.uuidHash) ? &_channel[j] : NULL;
+      }
+      if (failed && channel != NULL && _backlog != NULL)
+      {
+        storeTuples(*channel, request.tuples, request.count);
+      }
+      else if (failed)
+      {
+        _batchStats.dropped += request.count;   // UUID not in the table any more
+      }
+      request.count = 0;
+      return;
+    }
+}
+
+#if (SERIAL_DEBUG)
+// OBIS id, MQTT path and value of a list entry as text, debug output only
+void SmlHttp::debugEntry(Sensor *sensor, const SmlObisEntry &entry)
+{
+    char obisIdentifier[32];
+    char buffer[255];
+
+    sprintf(obisIdentifier, "%d-%d:%d.%d.%d*%d",              // adapted to VZ, original was: "%d-%d:%d.%d.%d/%d"
+            entry.obis[0], entry.obis[1], entry.obis[2], entry.obis[3], entry.obis[4], entry.obis[5]);
+
+    // construction of MQTT path - currently used only for DEBUG
+    char entryTopic[96];
+    snprintf(entryTopic, sizeof(entryTopic), "%ssensor/%s/obis/%s/", baseTopic, sensor->config->name, obisIdentifier);
+
+    if ((entry.type == SML_TYPE_INTEGER) || (entry.type == SML_TYPE_UNSIGNED))
+    {
+      smlDecimalFormat(buffer, sizeof(buffer), entry.value, entry.scaler, (entry.scaler < 0) ? -entry.scaler : 0);
+      DEBUG("%s: %s",entryTopic, buffer);   // buffer contains the value as string in float format
+//      publish(entryTopic + "value", buffer);   /* old, for MQTT */
+    }
+    else if (!sensor->config->numeric_only)
+    {
+      if (entry.type == SML_TYPE_OCTET_STRING)
+      {
+        // hex string of (the beginning of) the octet string, no malloc
+        size_t n = (entry.strLen < (sizeof(buffer) - 1) / 2) ? entry.strLen : (sizeof(buffer) - 1) / 2;
+        for (size_t i = 0; i < n; i++)
+        {
+          snprintf(&buffer[2 * i], 3, "%02X", entry.str[i]);
+        }
+        buffer[2 * n] = '\0';
+//        publish(entryTopic + "value", buffer);
+        DEBUG("%s: %s",entryTopic, buffer);
+      }
+      else if (entry.type == SML_TYPE_BOOLEAN)
+      {
+//        publish(entryTopic + "value", entry.value ? "true" : "false");
+        DEBUG("%s: %s",entryTopic, entry.value ? "true" : "false");
+      }
+    }
+}
+#endif
+
+const char *SmlHttp::getTimeStamp(uint8_t meter)
+{
+  return _meter[meter].timeStamp;
 }
 double SmlHttp::getValue(UuidValueName _select)
 {
   return _value[_select];
 }
+int64_t SmlHttp::getObisValue(uint64_t obisKey, uint8_t meter)
+{
+  for (uint8_t i = 0; i < _channels; i++)
+  {
+    if (_channel[i].key == obisKey && _channel[i].meter == meter)
+    {
+      return _channel[i].value;
+    }
+  }
+  return 0;
+}
 void SmlHttp::testHttp()
 //
 // 2023-01-26 mh
@@ -307,12 +1067,10 @@ void SmlHttp::testHttp()
   if((currentTime-lastSendTime) > MY_TEST_SEND_UPDATE)
   {
     lastSendTime = currentTime;
-    String _vzUUID = String(_uuid[vzTEST]);
-      struct timeval tv;                      // defined in time.h
-      gettimeofday(&tv, NULL);                // use local time; note that usec also contains ms --> divide by 1000 to get ms
-      String s_timestamp = String(tv.tv_sec);        // timestamp with resolution of 1 sec
+      char s_timestamp[24];
+      localTimeStamp(s_timestamp, sizeof(s_timestamp));
 
-    this->postHttp(_vzUUID, s_timestamp, double(currentTime/1000.));
+    this->postHttp(_uuid[vzTEST], s_timestamp, double(currentTime/1000.));
     // this->_TimeStamp = s_timestamp;  // done in postHttp()
     this->_value[vzTEST] = double(currentTime/1000.);
   }
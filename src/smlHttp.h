@@ -1,18 +1,26 @@
 #ifndef SML_HTTP_H
 #define SML_HTTP_H
 #include <sml/sml_file.h>
-#include <Sensor.h>
+#include "config.h"
+#include "hal.h"
+#include "Sensor.h"
+#include "smlBacklog.h"
+#include "smlChannel.h"
+#include "smlDecimal.h"
+#include "smlDerive.h"
+#include "smlHistory.h"
+#include "smlLayout.h"
+#include "smlObis.h"
+#include "smlScheduler.h"
+#include "smlTime.h"
 
 #ifndef DEBUG_TRACE
     #define DEBUG_TRACE(trace, format, ...) if(trace) {printf(format, ##__VA_ARGS__); fflush(stdout); Serial.println();}
 #endif
 
-#define N_UUID_VALUE 5          // adapt if enum is changed.
-enum UuidValueName
+#define N_UUID_VALUE 2          // adapt if enum is changed.
+enum UuidValueName              // channels without OBIS id; meter channels: SmlHttpConfig::channel
 {
-    vzENERGY_IN,
-    vzENERGY_OUT,
-    vzPOWER_IN,
     vzTEST,
     vzSML_HEART_BEAT
 };
@@ -22,27 +30,177 @@ struct SmlHttpConfig
 {
   char vzServer[64] = VZ_SERVER;
   char vzMiddleware[64] = VZ_MIDDLEWARE;
-  char uuidValue[N_UUID_VALUE][sizeOfUUID] = {"0","1","2","3","4",};
+  char uuidValue[N_UUID_VALUE][sizeOfUUID] = {VZ_UUID_TEST, VZ_UUID_SML_HEART_BEAT};
+  SmlChannelConfig channel[SML_CHANNELS_MAX];
+  SmlHttpConfig();              // channels of SML_CHANNEL_DEFAULTS
 };
 
-class SmlHttp
+// tuples of the channels posted in batches, see SmlHttp::flush()
+struct SmlBatchStats
+{
+    uint32_t tuples;                // queued tuples
+    uint32_t batches;               // requests posted to data/<uuid>.json (or queued by an asynchronous transport)
+    uint32_t dropped;               // tuples dropped from a full batch the server did not take
+};
+
+// publish policy of the channels (min/max interval, deadband, direction), see SmlHttp::flush()
+struct SmlPublishStats
+{
+    uint32_t sent;                  // values added to a batch
+    uint32_t suppressedInterval;    // within min interval
+    uint32_t suppressedDeadband;    // within the deadband
+    uint32_t heartbeats;            // sent after max interval although within the deadband
+    uint32_t directions;            // sent at once on a change of the sign
+    uint32_t aggregated;            // values added to an aggregation window (posted once per window)
+};
+
+// telegrams and tuples of one meter (Sensor::meter) with its channels (word meter<n>, smlChannel.cpp)
+struct SmlMeterStats
+{
+    uint32_t telegrams;             // telegrams evaluated
+    uint32_t tuples;                // tuples queued for the channels of the meter
+    uint32_t batches;               // requests posted for the channels of the meter
+    uint32_t dropped;               // tuples dropped from a full batch
+};
+
+class SmlHttp : public HttpListener
 {
 public:
     SmlHttp();
+    // server and channel table of config, the tuples not posted yet stay with the channel of the same UUID;
+    // not during a publish (e.g. from a web server callback): call it from loop() between the telegrams
     void init(SmlHttpConfig &config);
-    void setServerName(String serverName);
-    void setMiddlewareName(String middlewareName);
+    void setTransport(HttpTransport *transport);
+    void setBacklog(SmlBacklog *backlog);   // NULL: a batch the server did not take stays in RAM
+    void setHistory(SmlHistory *history);   // the first SML_HISTORY_CHANNELS channels of each telegram
+    void setScheduler(SmlScheduler *scheduler); // reception of all sensors between posts, NULL: of the sensor
+    void setServerName(const char *serverName);
+    void setMiddlewareName(const char *middlewareName);
     void testHttp();
-    int postHttp(String vzUUID, String timeStamp, double value);
+    int postHttp(const char *vzUUID, const char *timeStamp, double value);
     void publish(Sensor *sensor, sml_file *file);
-    String getTimeStamp();
+    void publish(Sensor *sensor, const byte *message, size_t len);
+    // the entries decoded by the sensor during the reception (smlStream.cpp), false: none committed, parse the message
+    bool publishDecoded(Sensor *sensor, const byte *message);
+    // by the layout learned for the meter of the sensor (smlLayout.cpp), false: structure unknown, parse completely
+    bool publishCached(Sensor *sensor, const byte *message, size_t len);
+    void learnLayout(Sensor *sensor, const byte *message, size_t len);     // after publish() of the libsml file
+    bool publishEntry(Sensor *sensor, const SmlObisEntry &entry);     // true: routed to a channel
+    void setLayoutCache(bool on) { _layoutCache = on; }
+    void sendBatches(Sensor *sensor);   // post the tuples of all channels now, e.g. at the end of a replay
+    void loop();                        // asynchronous transport: send the queued requests, go on with the backlog
+    bool busy() { return _transport->busy(); }
+    const char *getTimeStamp(uint8_t meter = 0);    // ms of the last tuple posted for the meter
     double getValue(UuidValueName select);
+    // last meter value of the channel of the OBIS key and meter in 10^-SML_VALUE_DECIMALS, e.g. smlObisKey(OBIS_ID_POWER_IN)
+    int64_t getObisValue(uint64_t obisKey, uint8_t meter = 0);
+    const HttpStats &getHttpStats() { return _transport->stats; }
+    const SmlBatchStats &getBatchStats() { return _batchStats; }
+    const SmlPublishStats &getPublishStats() { return _publishStats; }
+    const SmlMeterStats &getMeterStats(uint8_t meter) { return _meter[meter].stats; }
+    const SmlLayoutStats &getLayoutStats(uint8_t meter) { return _meter[meter].layout.getStats(); }
+    // asynchronous transport: a batch the server did not take goes to the backlog, backlog records are consumed
+    void requestDone(uint32_t id, int code) override;
 
 private:
-    String _TimeStamp="0";          // ms
-    String _serverName="";
-    String _middlewareName="";
+    char _serverName[64] = "";
+    char _middlewareName[64] = "";
+    char _url[160] = "";            // http://server/middleware/data.json
+    char _batchUrl[160] = "";       // http://server/middleware/data/, + <uuid>.json
     char* _uuid[N_UUID_VALUE];
     double _value[N_UUID_VALUE];
+    HttpTransport *_transport;
+    SmlBatchStats _batchStats = {};
+    SmlPublishStats _publishStats = {};
+    SmlHttpConfig *_config = NULL;
+    SmlBacklog *_backlog = NULL;
+    SmlHistory *_history = NULL;
+    uint8_t _historyMeters = 0;     // bit per meter with a channel in the history
+    SmlScheduler *_scheduler = NULL;
+    bool _online = true;            // the last request was answered by the server
+    // backlog request of the asynchronous transport waiting for its response (requestDone())
+    uint32_t _drainId = 0;          // HttpStats::posts of the request
+    uint8_t _drainRecords = 0;      // records of the request, 0: none waiting
+    uint32_t _drainConsumed = 0;    // SmlBacklog::consumed() when the request was posted
+    bool _drainNext = false;        // request confirmed, loop() posts the next one
+#if (SERIAL_DEBUG)
+    bool _layoutCache = false;      // debugEntry() of all entries of each telegram
+#else
+    bool _layoutCache = SML_LAYOUT_CACHE;
+#endif
+
+    struct Meter
+    {
+        char timeStamp[24] = "0";   // ms
+        SmlMeterStats stats = {};
+        SmlObisLayout layout;       // of the telegrams of the meter
+    };
+    Meter _meter[SML_METERS_MAX];
+
+    struct Tuple
+    {
+        uint64_t ts;                // epoch ms
+        int64_t value;              // 10^-SML_VALUE_DECIMALS
+    };
+    // channels in use: OBIS key, configuration and the value of the current telegram
+    struct Channel
+    {
+        uint64_t key;
+        const SmlChannelConfig *config;
+        uint32_t uuidHash;          // smlChannelUuidHash() of the UUID when init() set up the channel
+        uint8_t id;                 // index of SmlHttpConfig::channel
+        uint8_t meter;              // Sensor::meter of the telegrams of the channel
+        // values in 10^-SML_VALUE_DECIMALS (see smlDecimal.cpp)
+        int64_t factor;             // SmlChannelConfig::factor as factor * 10^factorScaler
+        int8_t factorScaler;
+        int64_t deadband;           // SmlChannelConfig::deadband, with SML_CHANNEL_RELATIVE in 10^-3 %
+        int64_t value;              // meter value of the current telegram
+        int64_t posted;             // last posted value (value * factor)
+        uint32_t postedMs;
+        bool pending;               // value of the current telegram not posted yet
+        bool valid;                 // posted at least once
+        uint8_t tuples;             // tuples of batch not posted yet
+        uint32_t batchMs;           // time of the first tuple of batch
+        Tuple batch[VZ_BATCH_TUPLES];
+        // aggregation window (SML_CHANNEL_AGGREGATE): O(1) per channel
+        uint32_t window;            // start of the window, s
+        uint32_t count;             // values in the window
+        int64_t sum;                // of value - energy, no overflow with large counters
+        int64_t min;
+        int64_t max;
+        int64_t energy;             // first value of the window, counter at its start (SML_CHANNEL_POWER)
+        uint32_t energyMs;          // Sensor::frameMs() of the first value
+        SmlPowerDerivation derive;  // SML_CHANNEL_DERIVE
+    };
+    Channel _channel[SML_CHANNELS_MAX];
+    uint8_t _channels = 0;
+    // batch queued by the asynchronous transport: its tuples go to the backlog if requestDone() reports a failure
+    struct Request
+    {
+        uint32_t id;                // HttpStats::posts of the request
+        uint32_t uuidHash;          // of the channel of the batch
+        uint8_t count;              // tuples, 0: free
+        Tuple tuples[VZ_BATCH_TUPLES];
+    };
+    Request _request[VZ_HTTP_QUEUE] = {};
+
+    void localTimeStamp(char *timeStamp, size_t size);
+    void setUrl();
+    void swapChannels(uint8_t a, uint8_t b);
+    void dropTuples(Channel &channel);
+    uint64_t frameTime(Sensor *sensor);
+    void flush(Sensor *sensor, uint64_t timeMs);
+    bool routed(uint64_t key, uint8_t meter);
+    bool sendBatch(Sensor *sensor, Channel &channel);
+    int postTuples(Sensor *sensor, const char *uuid, const Tuple *tuples, uint8_t count, uint8_t *posted,
+                   Request *request = NULL);
+    void drainBacklog(Sensor *sensor);
+    void storeTuples(Channel &channel, const Tuple *tuples, uint8_t count);
+    void addHistory(uint8_t meter, uint64_t timeMs);
+    bool publishPolicy(Channel &channel, int64_t value, uint32_t now);
+    bool aggregate(Channel &channel, int64_t value, uint64_t timeMs, uint32_t frameMs, Tuple *tuple);
+#if (SERIAL_DEBUG)
+    void debugEntry(Sensor *sensor, const SmlObisEntry &entry);
+#endif
 };
 #endif // SML_HTTP_H
\ No newline at end of file
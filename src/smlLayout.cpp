@@ -0,0 +1,148 @@
+#include <string.h>
+#include "smlCrc16.h"
+#include "smlLayout.h"
+
+/* *** smlLayout.cpp values of repeated telegrams by the offsets learned from a complete parse
+
+2026-10-17 mh
+- first version: offsets, unit, scaler and type of the routed entries, fingerprint of the structure of the telegram
+
+(C) M. Herbert, 2026.
+Licensed under the GNU General Public License v3.0
+
+*** end change log *** */
+
+/* ***
+# Description SmlObisLayout #
+A meter sends the same telegram every 1 to 4 s, only the bytes of a few values, the transaction ids, the time and
+the CRCs change. SmlHttp keeps one layout per meter: the complete parse of a telegram (SmlObisReader) records the
+offset of the entries routed to a channel of the meter, and the following telegrams are evaluated by these offsets,
+i.e. one number per channel is read instead of walking all messages and entries.
+
+## Fingerprint ##
+A telegram is evaluated by the layout if
+- it has the length of the learned telegram,
+- the objNames of all entries with a value are at the learned offsets (CRC16 of these objNames) and
+- unit, scaler and the type-length of the value of each routed entry are unchanged, i.e. the type and the number
+  of bytes of the value.
+
+Otherwise it is parsed completely and its layout is learned instead (SmlLayoutStats::misses), e.g. when a meter
+sends another telegram or a value needs one more byte. A telegram is not cached if it has more than
+SML_LAYOUT_NAMES entries with a value or more than SML_LAYOUT_ENTRIES routed entries, or it was not parsed without
+error; it is parsed completely each time then.
+The layout holds offsets, not pointers: the frame buffers are taken from SmlFramePool and differ between telegrams.
+
+## Usage ##
+```bash
+layout.begin(len);                              // complete parse
+while (reader.next(&entry)) { layout.add(message, reader, entry, routed); }
+layout.end(!reader.error());
+if (layout.match(message, len)) { for (i = 0; i < layout.count(); i++) { layout.entry(message, i, &entry); } }
+```
+
+*** end description *** */
+
+static_assert(SML_LAYOUT_NAMES <= 255 && SML_LAYOUT_ENTRIES <= 255, "SML_LAYOUT_NAMES, SML_LAYOUT_ENTRIES: 8 bit counts");
+
+void SmlObisLayout::reset()
+{
+    _len = 0;
+    _learnLen = 0;
+    _names = 0;
+    _count = 0;
+}
+
+void SmlObisLayout::begin(size_t len)
+{
+    reset();
+    _learnLen = (len <= 0xFFFF) ? (uint16_t)len : 0;
+    _nameCrc = SML_CRC16_INIT;
+}
+
+void SmlObisLayout::add(const byte *message, const SmlObisReader &reader, const SmlObisEntry &entry, bool routed)
+{
+    if (_learnLen == 0)
+    {
+        return;
+    }
+    // objName: octet string with one type-length byte
+    const byte *name = reader.nameAt();
+    if (_names == SML_LAYOUT_NAMES || (name[0] & 0xF0) != 0)
+    {
+        _learnLen = 0;
+        return;
+    }
+    _name[_names++] = name - message;
+    _nameCrc = smlCrc16Update(_nameCrc, name, name[0] & 0x0F);
+    if (!routed)
+    {
+        return;
+    }
+    // number of 1..8 bytes with one type-length byte
+    const byte *value = reader.valueAt();
+    size_t keyLen = value - reader.unitAt() + 1;
+    if (_count == SML_LAYOUT_ENTRIES || keyLen > SML_LAYOUT_KEY || (value[0] & 0x80) ||
+        (entry.type != SML_TYPE_INTEGER && entry.type != SML_TYPE_UNSIGNED))
+    {
+        _learnLen = 0;
+        return;
+    }
+    Slot &slot = _slot[_count++];
+    slot.unitAt = reader.unitAt() - message;
+    slot.keyLen = keyLen;
+    memcpy(slot.key, reader.unitAt(), keyLen);
+    memcpy(slot.obis, entry.obis, sizeof(slot.obis));
+    slot.unit = entry.unit;
+    slot.scaler = entry.scaler;
+    slot.type = entry.type;
+}
+
+void SmlObisLayout::end(bool complete)
+{
+    if (complete && _learnLen > 0)
+    {
+        _len = _learnLen;
+        _stats.learned++;
+    }
+    _learnLen = 0;
+}
+
+bool SmlObisLayout::match(const byte *message, size_t len)
+{
+    bool same = (_len > 0 && len == _len);
+    for (uint8_t i = 0; same && i < _count; i++)
+    {
+        same = !memcmp(message + _slot[i].unitAt, _slot[i].key, _slot[i].keyLen);
+    }
+    uint16_t crc = SML_CRC16_INIT;
+    for (uint8_t i = 0; same && i < _names; i++)
+    {
+        const byte *name = message + _name[i];
+        size_t nameLen = name[0] & 0x0F;
+        same = ((name[0] & 0xF0) == 0 && _name[i] + nameLen <= len);
+        crc = same ? smlCrc16Update(crc, name, nameLen) : crc;
+    }
+    same = same && (crc == _nameCrc);
+    if (same)
+    {
+        _stats.hits++;
+    }
+    else
+    {
+        _stats.misses++;
+    }
+    return same;
+}
+
+void SmlObisLayout::entry(const byte *message, uint8_t i, SmlObisEntry *entry) const
+{
+    const Slot &slot = _slot[i];
+    const byte *value = message + slot.unitAt + slot.keyLen - 1;
+    memcpy(entry->obis, slot.obis, sizeof(entry->obis));
+    entry->unit = slot.unit;
+    entry->scaler = slot.scaler;
+    entry->type = slot.type;
+    entry->value = smlObisNumber(value + 1, (value[0] & 0x0F) - 1, slot.type);
+    entry->str = NULL;
+    entry->strLen = 0;
+}
@@ -0,0 +1,58 @@
+#ifndef SML_LAYOUT_H
+#define SML_LAYOUT_H
+
+#include "hal.h"
+#include "smlObis.h"
+
+#ifndef SML_LAYOUT_ENTRIES
+#define SML_LAYOUT_ENTRIES 8            // entries of a meter routed to channels, 20 bytes each
+#endif
+#ifndef SML_LAYOUT_NAMES
+#define SML_LAYOUT_NAMES 24             // entries with a value per telegram, 2 bytes each
+#endif
+#define SML_LAYOUT_KEY 8                // bytes of unit, scaler and type-length of the value of an entry
+
+struct SmlLayoutStats
+{
+    uint32_t hits;                  // telegrams evaluated by the learned offsets
+    uint32_t misses;                // telegrams with another structure than the learned one: parsed completely
+    uint32_t learned;               // layouts learned from a complete parse
+};
+
+// offsets of the routed values of the telegrams of one meter, learned from a complete parse (see smlLayout.cpp)
+class SmlObisLayout
+{
+public:
+    void reset();
+    // learning from the complete parse of a message: begin(), add() for each entry of SmlObisReader::next(), end()
+    void begin(size_t len);
+    void add(const byte *message, const SmlObisReader &reader, const SmlObisEntry &entry, bool routed);
+    void end(bool complete);
+    // the message has the structure of the learned one, i.e. entry() returns its routed values
+    bool match(const byte *message, size_t len);
+    uint8_t count() const { return _count; }
+    void entry(const byte *message, uint8_t i, SmlObisEntry *entry) const;
+    const SmlLayoutStats &getStats() const { return _stats; }
+
+private:
+    struct Slot
+    {
+        uint16_t unitAt;            // unit, scaler and type-length of the value: key, then the value bytes
+        uint8_t keyLen;
+        byte key[SML_LAYOUT_KEY];
+        byte obis[6];
+        uint8_t unit;
+        int8_t scaler;
+        uint8_t type;
+    };
+    Slot _slot[SML_LAYOUT_ENTRIES];
+    uint16_t _name[SML_LAYOUT_NAMES];   // objName of the entries with a value
+    uint16_t _nameCrc = 0;          // CRC16 of these objNames
+    uint16_t _len = 0;              // of the learned message, 0: none
+    uint16_t _learnLen = 0;         // 0: the message being learned cannot be cached
+    uint8_t _names = 0;
+    uint8_t _count = 0;
+    SmlLayoutStats _stats = {};
+};
+
+#endif // SML_LAYOUT_H
@@ -0,0 +1,386 @@
+#include <string.h>
+#include "smlObis.h"
+
+/* *** smlObis.cpp zero-copy extraction of OBIS values from SML messages
+
+2026-10-17 mh
+- first version: TLV walker over the GetListResponse value lists, no malloc; adapter for the libsml list
+- positions of the last entry (nameAt(), unitAt(), valueAt()) and smlObisNumber() for the layout cache (smlLayout.cpp)
+- walk resumed on more bytes of the message (SmlObisWalk, incomplete()) for the push decoder (smlStream.cpp)
+
+(C) M. Herbert, 2026.
+Licensed under the GNU General Public License v3.0
+
+*** end change log *** */
+
+/* ***
+# Description SmlObisReader #
+sml_file_parse() of libsml builds a tree of all messages (about 10 mallocs per list entry),
+publish() evaluates only a few list entries of it and sml_file_free() releases the tree again.
+SmlObisReader walks the message bytes in place and returns the entries of the value lists one by one,
+without any allocation; octet string values point into the message buffer.
+
+## SML encoding ##
+Each element starts with a type-length field (TL):
+```bash
+bit 7     another TL byte follows (its low nibble extends the length)
+bit 6..4  type: 000 octet string, 100 boolean, 101 integer, 110 unsigned, 111 list
+bit 3..0  length: number of bytes including the TL bytes, for lists the number of elements
+```
+01 is an octet string without data, i.e. an optional element that is not sent; 00 ends a message.
+
+Structure (only GetListResponse messages are evaluated, all other elements are skipped):
+```bash
+SML_Message         list(6): transactionId, groupNo, abortOnError, messageBody, crc16, endOfSmlMsg
+messageBody         list(2): tag (0x0701 GetListResponse), body
+GetListResponse     list(7): clientId, serverId, listName, actSensorTime, valList, listSignature, actGatewayTime
+valList             list(n) of SML_ListEntry
+SML_ListEntry       list(7): objName, status, valTime, unit, scaler, value, valueSignature
+```
+Entries without value are skipped as in SmlHttp::publish(). Numbers of 1..8 bytes are read as int64.
+
+## Usage ##
+```bash
+SmlObisReader reader(buffer + 8, len - 16);     // message without start and end sequence, as sml_file_parse()
+SmlObisEntry entry;
+while (reader.next(&entry)) { ... }
+```
+A message that is still being received is walked in steps: the walk of the last complete entry (walk()) is resumed
+on the longer message (SmlObisReader(data, len, walk)); an error with incomplete() only needs more bytes, at least up
+to needed().
+
+*** end description *** */
+
+const uint32_t SML_TAG_GET_LIST_RESPONSE = 0x00000701;
+
+SmlObisReader::SmlObisReader(const byte *data, size_t len) : _pos(data), _end(data + len) {}
+
+SmlObisReader::SmlObisReader(const byte *data, size_t len, const SmlObisWalk &walk)
+    : _pos(data + walk.offset), _end(data + len), _entries(walk.entries), _skip(walk.skip) {}
+
+bool SmlObisReader::fail()
+{
+    _error = true;
+    _entries = 0;
+    _skip = 0;
+    return false;
+}
+
+// the element continues after the end of the data, up to needed
+bool SmlObisReader::failShort(const byte *needed)
+{
+    _incomplete = true;
+    _needed = needed;
+    return fail();
+}
+
+// type and length of the next element; len: number of elements of a list, otherwise number of data bytes
+bool SmlObisReader::readTypeLength(uint8_t *type, size_t *len)
+{
+    if (_pos >= _end)
+    {
+        return failShort(_end + 1);
+    }
+    byte tl = *_pos;
+    size_t tlLen = 1;
+    size_t length = tl & 0x0F;
+    *type = tl & 0x70;
+    while (tl & 0x80)
+    {
+        if (tlLen >= 4)
+        {
+            return fail();
+        }
+        if (_pos + tlLen >= _end)
+        {
+            return failShort(_pos + tlLen + 1);
+        }
+        tl = _pos[tlLen++];
+        length = (length << 4) | (tl & 0x0F);
+    }
+    _pos += tlLen;
+    if (*type != SML_TYPE_LIST)
+    {
+        length = (length > tlLen) ? length - tlLen : 0;         // 00 (end of message) has no TL length
+        if (length > (size_t)(_end - _pos))
+        {
+            return failShort(_pos + length);
+        }
+    }
+    *len = length;
+    return true;
+}
+
+bool SmlObisReader::readList(size_t *len)
+{
+    uint8_t type;
+    if (!readTypeLength(&type, len))
+    {
+        return false;
+    }
+    return (type == SML_TYPE_LIST) ? true : fail();
+}
+
+// skip elements including the elements of lists
+bool SmlObisReader::skip(size_t elements)
+{
+    while (elements > 0)
+    {
+        uint8_t type;
+        size_t len;
+        if (!readTypeLength(&type, &len))
+        {
+            return false;
+        }
+        elements--;
+        if (type == SML_TYPE_LIST)
+        {
+            elements += len;
+        }
+        else
+        {
+            _pos += len;
+        }
+    }
+    return true;
+}
+
+// optional integer or unsigned
+bool SmlObisReader::readNumber(uint8_t *type, int64_t *value, bool *present)
+{
+    size_t len;
+    if (!readTypeLength(type, &len))
+    {
+        return false;
+    }
+    *present = false;
+    *value = 0;
+    if (*type == SML_TYPE_OCTET_STRING && len == 0)
+    {
+        return true;                        // not sent
+    }
+    if ((*type != SML_TYPE_INTEGER && *type != SML_TYPE_UNSIGNED) || len == 0 || len > 8)
+    {
+        return fail();
+    }
+    *value = smlObisNumber(_pos, len, *type);
+    _pos += len;
+    *present = true;
+    return true;
+}
+
+int64_t smlObisNumber(const byte *data, size_t len, uint8_t type)
+{
+    uint64_t number = 0;
+    for (size_t i = 0; i < len; i++)
+    {
+        number = (number << 8) | data[i];
+    }
+    if (type == SML_TYPE_INTEGER && len < 8 && (data[0] & 0x80))
+    {
+        number |= ~0ULL << (8 * len);       // sign extension
+    }
+    return (int64_t)number;
+}
+
+bool SmlObisReader::readEntry(SmlObisEntry *entry, bool *present)
+{
+    size_t len;
+    uint8_t type;
+    int64_t number;
+    bool numberPresent;
+
+    *present = false;
+    if (!readList(&len))
+    {
+        return false;
+    }
+    if (len != 7)
+    {
+        return skip(len);
+    }
+
+    // objName
+    _nameAt = _pos;
+    if (!readTypeLength(&type, &len) || type != SML_TYPE_OCTET_STRING)
+    {
+        return fail();
+    }
+    memset(entry->obis, 0, sizeof(entry->obis));
+    memcpy(entry->obis, _pos, (len < sizeof(entry->obis)) ? len : sizeof(entry->obis));
+    _pos += len;
+
+    // status, valTime
+    if (!skip(2))
+    {
+        return false;
+    }
+
+    // unit, scaler
+    _unitAt = _pos;
+    if (!readNumber(&type, &number, &numberPresent))
+    {
+        return false;
+    }
+    entry->unit = numberPresent ? (uint8_t)number : 0;
+    if (!readNumber(&type, &number, &numberPresent))
+    {
+        return false;
+    }
+    entry->scaler = numberPresent ? (int8_t)number : 0;
+
+    // value
+    const byte *value = _pos;
+    _valueAt = value;
+    if (!readTypeLength(&type, &len))
+    {
+        return false;
+    }
+    entry->type = type;
+    entry->value = 0;
+    entry->str = NULL;
+    entry->strLen = 0;
+    switch (type)
+    {
+    case SML_TYPE_OCTET_STRING:
+        entry->str = _pos;
+        entry->strLen = len;
+        *present = (len > 0);
+        _pos += len;
+        break;
+    case SML_TYPE_BOOLEAN:
+        entry->value = (len > 0 && _pos[0] != 0) ? 1 : 0;
+        *present = true;
+        _pos += len;
+        break;
+    case SML_TYPE_INTEGER:
+    case SML_TYPE_UNSIGNED:
+        _pos = value;
+        if (!readNumber(&type, &entry->value, present))
+        {
+            return false;
+        }
+        break;
+    default:
+        if (!skip(len))                         // list: not a value of a list entry
+        {
+            return false;
+        }
+        break;
+    }
+
+    // valueSignature
+    return skip(1);
+}
+
+bool SmlObisReader::next(SmlObisEntry *entry)
+{
+    while (!_error)
+    {
+        if (_entries > 0)
+        {
+            _entries--;
+            bool present;
+            if (readEntry(entry, &present) && present)
+            {
+                return true;
+            }
+            continue;
+        }
+        if (_skip > 0)
+        {
+            size_t elements = _skip;
+            _skip = 0;
+            if (!skip(elements))
+            {
+                return false;
+            }
+            continue;
+        }
+
+        // next message; 00 between the messages: end of message or fill bytes before the end sequence
+        while (_pos < _end && *_pos == 0x00)
+        {
+            _pos++;
+        }
+        if (_pos >= _end)
+        {
+            return false;
+        }
+        size_t len;
+        uint8_t type;
+        int64_t tag;
+        bool present;
+        if (!readList(&len) || len != 6 || !skip(3) || !readList(&len) || len != 2 ||
+            !readNumber(&type, &tag, &present))
+        {
+            return fail();
+        }
+        if (tag == SML_TAG_GET_LIST_RESPONSE)
+        {
+            if (!readList(&len) || len != 7 || !skip(4) || !readList(&_entries))
+            {
+                return fail();
+            }
+            _skip = 2 + 2;                      // listSignature, actGatewayTime; crc16, endOfSmlMsg
+        }
+        else
+        {
+            _skip = 1 + 2;                      // body; crc16, endOfSmlMsg
+        }
+    }
+    return false;
+}
+
+// adapter for the tree of libsml ---------------------------------------------------------------
+bool smlObisFromList(const sml_list *list, SmlObisEntry *entry)
+{
+    sml_value *value = list->value;
+    if (value == NULL)
+    {
+        return false;
+    }
+    memset(entry->obis, 0, sizeof(entry->obis));
+    if (list->obj_name != NULL)
+    {
+        memcpy(entry->obis, list->obj_name->str,
+               ((size_t)list->obj_name->len < sizeof(entry->obis)) ? list->obj_name->len : sizeof(entry->obis));
+    }
+    entry->unit = (list->unit) ? *list->unit : 0;
+    entry->scaler = (list->scaler) ? *list->scaler : 0;
+    entry->type = value->type & SML_TYPE_FIELD;
+    entry->value = 0;
+    entry->str = NULL;
+    entry->strLen = 0;
+    switch (entry->type)
+    {
+    case SML_TYPE_OCTET_STRING:
+        entry->str = value->data.bytes->str;
+        entry->strLen = value->data.bytes->len;
+        break;
+    case SML_TYPE_BOOLEAN:
+        entry->value = (value->data.boolean && *value->data.boolean) ? 1 : 0;
+        break;
+    case SML_TYPE_INTEGER:
+        switch (value->type & SML_LENGTH_FIELD)
+        {
+        case SML_TYPE_NUMBER_8:  entry->value = *value->data.int8;  break;
+        case SML_TYPE_NUMBER_16: entry->value = *value->data.int16; break;
+        case SML_TYPE_NUMBER_32: entry->value = *value->data.int32; break;
+        default:                 entry->value = *value->data.int64; break;
+        }
+        break;
+    case SML_TYPE_UNSIGNED:
+        switch (value->type & SML_LENGTH_FIELD)
+        {
+        case SML_TYPE_NUMBER_8:  entry->value = *value->data.uint8;  break;
+        case SML_TYPE_NUMBER_16: entry->value = *value->data.uint16; break;
+        case SML_TYPE_NUMBER_32: entry->value = *value->data.uint32; break;
+        default:                 entry->value = (int64_t)*value->data.uint64; break;
+        }
+        break;
+    default:
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,120 @@
+#ifndef SML_OBIS_H
+#define SML_OBIS_H
+
+#include <sml/sml_list.h>
+#include "hal.h"
+
+// one entry of the value list of an SML GetListResponse
+struct SmlObisEntry
+{
+    byte obis[6];               // object name, e.g. 1-0:1.8.0*255 = 01 00 01 08 00 FF
+    uint8_t unit;               // DLMS unit code, 0 if not sent
+    int8_t scaler;              // value * 10^scaler, 0 if not sent
+    uint8_t type;               // SML_TYPE_INTEGER, SML_TYPE_UNSIGNED, SML_TYPE_BOOLEAN or SML_TYPE_OCTET_STRING
+    int64_t value;              // integer, unsigned and boolean
+    const byte *str;            // octet string, points into the message
+    size_t strLen;
+};
+
+// position of a walk as offset into the message, to resume it on more bytes of the message (smlStream.cpp)
+struct SmlObisWalk
+{
+    size_t offset;
+    size_t entries;
+    size_t skip;
+};
+
+// Zero-copy walker over the TLV encoded messages of an SML file (see smlObis.cpp),
+// e.g. SmlObisReader reader(buffer + 8, len - 16); while (reader.next(&entry)) {...}
+class SmlObisReader
+{
+public:
+    SmlObisReader(const byte *data, size_t len);
+    // resume a walk over the first len bytes of a message that is still being received
+    SmlObisReader(const byte *data, size_t len, const SmlObisWalk &walk);
+    // next list entry with a value, false at the end of the file or on error
+    bool next(SmlObisEntry *entry);
+    bool error() { return _error; }
+    // the error is the end of the data within an element, i.e. more bytes of the message may complete it;
+    // needed(): the data must reach at least this position to complete it
+    bool incomplete() const { return _incomplete; }
+    const byte *needed() const { return _needed; }
+    SmlObisWalk walk(const byte *data) const { return {(size_t)(_pos - data), _entries, _skip}; }
+    // positions of the entry returned by next() in the message: objName, unit, value (for SmlObisLayout)
+    const byte *nameAt() const { return _nameAt; }
+    const byte *unitAt() const { return _unitAt; }
+    const byte *valueAt() const { return _valueAt; }
+
+private:
+    bool readTypeLength(uint8_t *type, size_t *len);
+    bool readList(size_t *len);
+    bool readNumber(uint8_t *type, int64_t *value, bool *present);
+    bool skip(size_t elements);
+    bool readEntry(SmlObisEntry *entry, bool *present);
+    bool fail();
+    bool failShort(const byte *needed);
+
+    const byte *_pos;
+    const byte *_end;
+    size_t _entries = 0;            // entries left in the current value list
+    size_t _skip = 0;               // elements of the message after the value list
+    bool _error = false;
+    bool _incomplete = false;
+    const byte *_needed = NULL;
+    const byte *_nameAt = NULL;
+    const byte *_unitAt = NULL;
+    const byte *_valueAt = NULL;
+};
+
+// integer (sign extended) or unsigned of len (1..8) data bytes, as in the messages
+int64_t smlObisNumber(const byte *data, size_t len, uint8_t type);
+
+// OBIS id as 48 bit key: A-B:C.D.E*F -> 0xAABBCCDDEEFF ----------------------------------------
+const uint64_t SML_OBIS_INVALID = ~0ULL;
+
+// parse an OBIS id string, e.g. smlObisKey("1-0:1.8.0*255"), at compile time; SML_OBIS_INVALID if not 6 numbers 0..255
+constexpr uint64_t smlObisKey(const char *id)
+{
+    uint64_t key = 0;
+    uint32_t number = 0;
+    int fields = 0;
+    bool digit = false;
+    for (;; id++)
+    {
+        if (*id >= '0' && *id <= '9')
+        {
+            number = number * 10 + (*id - '0');
+            if (number > 255)
+            {
+                return SML_OBIS_INVALID;
+            }
+            digit = true;
+        }
+        else
+        {
+            if (digit)
+            {
+                key = (key << 8) | number;
+                fields++;
+                number = 0;
+                digit = false;
+            }
+            if (*id == '\0')
+            {
+                break;
+            }
+        }
+    }
+    return (fields == 6) ? key : SML_OBIS_INVALID;
+}
+// key of the object name of a list entry
+inline uint64_t smlObisKey(const byte *obis)
+{
+    return ((uint64_t)obis[0] << 40) | ((uint64_t)obis[1] << 32) | ((uint32_t)obis[2] << 24) |
+           ((uint32_t)obis[3] << 16) | ((uint32_t)obis[4] << 8) | obis[5];
+}
+
+// the same entry from the list of libsml (sml_file_parse()), false if the entry has no value
+bool smlObisFromList(const sml_list *list, SmlObisEntry *entry);
+
+#endif // SML_OBIS_H
@@ -0,0 +1,100 @@
+#include <sml/sml_file.h>
+#include "config.h"
+#include "smlArena.h"
+#include "smlDecimal.h"
+#include "smlDebug.h"
+#include "smlPipeline.h"
+#include "smlProfile.h"
+
+/* *** smlPipeline.cpp processing of a received SML message: parse -> publish -> dash board
+
+2026-10-17 mh
+- first version, moved from process_message() in main.cpp to share it with the host (native) build
+- profiling of parse, publish and free (SML_PROFILE)
+- SML_ZERO_COPY_PARSER: evaluation by SmlObisReader on the message bytes instead of sml_file_parse()
+- dash board values of the channels of OBIS_ID_* (config.h), as scaled integers (smlDecimal.cpp)
+- values and time stamp of the meter of the sensor (several reading heads)
+- layout cache (smlLayout.cpp): telegrams of a known structure are evaluated by the learned offsets
+- tree of sml_file_parse() in the parse arena (smlFileParse(), SML_PARSE_ARENA) instead of the heap
+- entries decoded during the reception (smlStream.cpp) are published without a parse
+
+(C) M. Herbert, 2026.
+Licensed under the GNU General Public License v3.0
+
+*** end change log *** */
+
+void smlProcessFrame(byte *buffer, size_t len, Sensor *sensor, SmlHttp &http, DashSink *dash)
+{
+#ifdef SML_ZERO_COPY_PARSER
+    if (VERBOSE_LEVEL_MeterProtocol)
+    {
+        sml_file *file = smlFileParse(buffer + 8, len - 16);
+        DEBUG_SML_FILE(file);     // output of received messages
+        smlFileFree(file);
+    }
+    // evaluate the message in place, without start and end sequence (parse and publish are profiled per entry);
+    // by the entries decoded during the reception or the learned layout if the structure is known
+    http.publish(sensor, buffer + 8, len - 16);
+#else
+    // decoded during the reception or known structure: the values without a parse
+    if (VERBOSE_LEVEL_MeterProtocol ||
+        !(http.publishDecoded(sensor, buffer + 8) || http.publishCached(sensor, buffer + 8, len - 16)))
+    {
+        // Parse, without start and end sequence
+        sml_file *file;
+        {
+            SML_PROFILE_SCOPE(PROFILE_PARSE);
+            file = smlFileParse(buffer + 8, len - 16);      // in the parse arena with SML_PARSE_ARENA
+        }
+
+        if (VERBOSE_LEVEL_MeterProtocol)
+        {
+            DEBUG_SML_FILE(file);     // output of received messages
+        }
+        {
+            SML_PROFILE_SCOPE(PROFILE_PUBLISH);
+            http.publish(sensor, file);
+        }
+
+        // free the malloc'd memory (nothing to do if the tree is in the parse arena)
+        {
+            SML_PROFILE_SCOPE(PROFILE_FREE);
+            smlFileFree(file);
+        }
+        http.learnLayout(sensor, buffer + 8, len - 16);
+    }
+#endif
+
+    // update dashboard
+    uint8_t meter = sensor ? sensor->meter : 0;
+    const char *s_timeStamp = http.getTimeStamp(meter);
+    int64_t powerIn = http.getObisValue(smlObisKey(OBIS_ID_POWER_IN), meter);
+    int64_t energyIn = http.getObisValue(smlObisKey(OBIS_ID_ENERGY_IN), meter);
+    int64_t energyOut = http.getObisValue(smlObisKey(OBIS_ID_ENERGY_OUT), meter);
+
+    dash->status("data published");
+    dash->values(meter, s_timeStamp, powerIn, energyIn, energyOut);
+
+    if (VERBOSE_LEVEL_MeterData)
+    {
+        Serial.print("meter");
+        Serial.print(meter + 1);
+        Serial.print(" ts=");
+        Serial.print(s_timeStamp);
+        Serial.print("ms, ");
+        char value[24];
+        Serial.print("P=");
+        smlDecimalFormat(value, sizeof(value), powerIn, -SML_VALUE_DECIMALS, 2);
+        Serial.print(value);
+        Serial.print("W, ");
+        Serial.print("E_in=");
+        smlDecimalFormat(value, sizeof(value), energyIn, -SML_VALUE_DECIMALS, 2);
+        Serial.print(value);
+        Serial.print("Wh, ");
+        Serial.print("E_out=");
+        smlDecimalFormat(value, sizeof(value), energyOut, -SML_VALUE_DECIMALS, 2);
+        Serial.print(value);
+        Serial.println("Wh");
+        Serial.flush();
+    }
+}
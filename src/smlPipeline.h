@@ -0,0 +1,11 @@
+#ifndef SML_PIPELINE_H
+#define SML_PIPELINE_H
+
+#include "hal.h"
+#include "Sensor.h"
+#include "smlHttp.h"
+
+// parse a received SML message, publish it to the data base and update the dash board
+void smlProcessFrame(byte *buffer, size_t len, Sensor *sensor, SmlHttp &http, DashSink *dash);
+
+#endif // SML_PIPELINE_H
@@ -0,0 +1,34 @@
+#include <time.h>
+#include "smlProfile.h"
+
+/* *** smlProfile.cpp per stage timing of the SML frame path
+
+2026-10-17 mh
+- first version
+
+(C) M. Herbert, 2026.
+Licensed under the GNU General Public License v3.0
+
+*** end change log *** */
+
+SmlProfileStat smlProfile[PROFILE_N_STAGES];
+const char *smlProfileStageName[PROFILE_N_STAGES] = {"start_search", "end_search", "parse", "publish", "free"};
+
+void smlProfileReset()
+{
+    for (int i = 0; i < PROFILE_N_STAGES; i++)
+    {
+        smlProfile[i].ticks = 0;
+        smlProfile[i].calls = 0;
+        smlProfile[i].mallocs = 0;
+    }
+}
+
+#ifndef ARDUINO
+uint32_t smlProfileTicks()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec);
+}
+#endif
@@ -0,0 +1,63 @@
+#ifndef SML_PROFILE_H
+#define SML_PROFILE_H
+
+#include "hal.h"
+
+// Per stage timing of the SML frame path, compiled in with -DSML_PROFILE only (see smlBench.cpp).
+// Ticks are cpu cycles on the ESP8266 and ns on the host, see SML_PROFILE_TICKS_PER_US.
+
+enum SmlProfileStage
+{
+    PROFILE_START_SEARCH,       // Sensor::wait_for_start_sequence()
+    PROFILE_END_SEARCH,         // Sensor::read_message()
+    PROFILE_PARSE,              // sml_file_parse()
+    PROFILE_PUBLISH,            // SmlHttp::publish()
+    PROFILE_FREE,               // sml_file_free()
+    PROFILE_N_STAGES
+};
+
+struct SmlProfileStat
+{
+    uint32_t ticks;
+    uint32_t calls;
+    uint32_t mallocs;
+};
+
+extern SmlProfileStat smlProfile[PROFILE_N_STAGES];
+extern const char *smlProfileStageName[PROFILE_N_STAGES];
+
+void smlProfileReset();
+
+#ifdef ARDUINO
+    #define SML_PROFILE_TICKS_PER_US (F_CPU / 1000000UL)
+    inline uint32_t smlProfileTicks() { return ESP.getCycleCount(); }
+#else
+    #define SML_PROFILE_TICKS_PER_US 1000UL
+    uint32_t smlProfileTicks();
+#endif
+
+#ifdef SML_PROFILE
+    #include "smlAlloc.h"
+
+    class SmlProfileScope
+    {
+    public:
+        SmlProfileScope(SmlProfileStage stage) : _stage(stage), _mallocs(smlAllocStats.mallocs), _start(smlProfileTicks()) {}
+        ~SmlProfileScope()
+        {
+            smlProfile[_stage].ticks += smlProfileTicks() - _start;
+            smlProfile[_stage].calls++;
+            smlProfile[_stage].mallocs += smlAllocStats.mallocs - _mallocs;
+        }
+
+    private:
+        SmlProfileStage _stage;
+        uint32_t _mallocs;
+        uint32_t _start;
+    };
+    #define SML_PROFILE_SCOPE(stage) SmlProfileScope _profileScope(stage)
+#else
+    #define SML_PROFILE_SCOPE(stage)
+#endif
+
+#endif // SML_PROFILE_H
@@ -0,0 +1,381 @@
+#ifndef ARDUINO
+#include <algorithm>
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "halNative.h"
+#include "smlReplay.h"
+
+/* *** smlReplay.cpp replay of recorded meter streams on the host
+
+2026-10-17 mh
+- first version: capture format with chunk time stamps, real time / Nx / as fast as possible replay
+- bulk readBytes()
+- getTimeOfDay() of a capture without epoch runs on the capture time from the host time of the first call
+- SmlReplayClock: one virtual time for several replays (several meters), spend(), setCapacity(), append()
+
+(C) M. Herbert, 2026.
+Licensed under the GNU General Public License v3.0
+
+*** end change log *** */
+
+/* ***
+# Description SmlReplay #
+SmlReplay is the ByteSource (hal.h) of a Sensor: Sensor::pump() reads the recorded byte stream of a meter by
+available() / readBytes(). It provides the matching (virtual) time base for millis() as well.
+
+## Capture format ##
+Text file, whitespace separated tokens:
+```bash
+# SMLReaderVZ capture           comment line
+# epoch 1676800000000           optional: system time in ms at capture start
+@0 1B 1B 1B 1B 01 01 01 01      @<ms>: arrival time of the following byte relative to capture start
+76 05 00 ...                    bytes without time stamp follow the previous byte at 9600 Baud
+@1523.5 1B 1B 1B 1B ...         time stamps may precede any byte (per chunk or per byte)
+```
+The hex dump of DEBUG_DUMP_BUFFER (including its "----DATA----" lines) is a valid capture.
+Files containing non-text bytes are taken as raw binary captures, timed at 9600 Baud.
+
+## Usage ##
+```bash
+SmlReplay *replay = new SmlReplay(speed);   // 1.0 = real time, 10 = 10x, 0 = as fast as possible
+replay->load("meter.cap");
+halSetClock(replay);                        // millis() runs on the capture time
+Sensor sensor(config, replay, process_message);
+while (!replay->finished()) sensor.loop();
+```
+
+## Several meters ##
+Replays of several meters share one SmlReplayClock. As fast as possible, a replay without input reports the time of
+its next byte (waitFor()) and the loop over the sensors calls step() of the clock: the time jumps to the earliest
+of these bytes, i.e. the streams arrive interleaved as on the device. spend(ms) advances the time by the processing
+time the device would need (e.g. a blocking http post), the input of the other meters piles up meanwhile; with
+setCapacity() input beyond the SoftwareSerial buffer of the device is lost (overflow(), lostBytes()).
+```bash
+SmlReplayClock clock(0);
+halSetClock(&clock);
+scheduler.add(new Sensor(&config[i], new SmlReplay(&clock), process_message));   // load() each replay
+while (...) { scheduler.loop(); clock.step(); }
+```
+
+*** end description *** */
+
+// clock ---------------------------------------------------------------------------------------
+void SmlReplayClock::rewind()
+{
+    _virtualUs = 0;
+    _wakeUs = UINT64_MAX;
+    _hostStartUs = hostMicros();
+}
+
+uint64_t SmlReplayClock::nowUs()
+{
+    if (_speed <= 0)
+    {
+        return _virtualUs;
+    }
+    return (uint64_t)((hostMicros() - _hostStartUs) * _speed);
+}
+
+void SmlReplayClock::waitFor(uint64_t us)
+{
+    if (us < _wakeUs)
+    {
+        _wakeUs = us;
+    }
+}
+
+void SmlReplayClock::step()
+{
+    if (_wakeUs != UINT64_MAX && _wakeUs > _virtualUs)
+    {
+        _virtualUs = _wakeUs;
+    }
+    _wakeUs = UINT64_MAX;
+}
+
+void SmlReplayClock::spend(uint32_t ms)
+{
+    if (_speed <= 0)
+    {
+        _virtualUs += ms * 1000ULL;
+    }
+    else
+    {
+        usleep((useconds_t)(ms * 1000. / _speed));
+    }
+}
+
+uint32_t SmlReplayClock::millis()
+{
+    return (uint32_t)(nowUs() / 1000);
+}
+
+void SmlReplayClock::getTimeOfDay(struct timeval *tv)
+{
+    if (_epochStartMs == 0)
+    {
+        // capture without epoch: the host time of the first call, then the capture time (also when not in real time)
+        struct timeval host;
+        gettimeofday(&host, NULL);
+        _epochStartMs = (uint64_t)host.tv_sec * 1000ULL + host.tv_usec / 1000 - nowUs() / 1000;
+    }
+    uint64_t epochUs = _epochStartMs * 1000ULL + nowUs();
+    tv->tv_sec = (time_t)(epochUs / 1000000ULL);
+    tv->tv_usec = (suseconds_t)(epochUs % 1000000ULL);
+}
+
+// replay --------------------------------------------------------------------------------------
+SmlReplay::SmlReplay(double speed) : _ownClock(speed), _clock(&_ownClock) {}
+
+SmlReplay::SmlReplay(SmlReplayClock *clock) : _clock(clock) {}
+
+bool SmlReplay::load(const char *fileName)
+{
+    FILE *file = fopen(fileName, "rb");
+    if (file == NULL)
+    {
+        return false;
+    }
+    bool result = load(file);
+    fclose(file);
+    return result;
+}
+
+bool SmlReplay::load(FILE *file)
+{
+    std::vector<char> content;
+    char chunk[4096];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), file)) > 0)
+    {
+        content.insert(content.end(), chunk, chunk + n);
+    }
+
+    _data.clear();
+    _time.clear();
+    uint64_t epochMs = 0;
+    bool binary = false;
+    for (char c : content)
+    {
+        if (!isprint((unsigned char)c) && !isspace((unsigned char)c))
+        {
+            binary = true;
+            break;
+        }
+    }
+    if (binary)
+    {
+        uint64_t t = 0;
+        for (char c : content)
+        {
+            _data.push_back((uint8_t)c);
+            _time.push_back(t);
+            t += SML_REPLAY_BYTE_US;
+        }
+    }
+    else if (!parseText(content.data(), content.size(), &epochMs))
+    {
+        return false;
+    }
+    if (_clock == &_ownClock || epochMs != 0)
+    {
+        _clock->setEpoch(epochMs);      // a shared clock: the epoch of a capture that has one
+    }
+    rewind();
+    return !_data.empty();
+}
+
+void SmlReplay::append(uint64_t timeUs, const byte *data, size_t len)
+{
+    uint64_t t = (!_time.empty() && _time.back() + SML_REPLAY_BYTE_US > timeUs) ? _time.back() + SML_REPLAY_BYTE_US : timeUs;
+    for (size_t i = 0; i < len; i++)
+    {
+        _data.push_back(data[i]);
+        _time.push_back(t);
+        t += SML_REPLAY_BYTE_US;
+    }
+}
+
+bool SmlReplay::parseText(const char *text, size_t len, uint64_t *epochMs)
+{
+    uint64_t next = 0;              // arrival time of the next byte
+    size_t i = 0;
+    while (i < len)
+    {
+        // skip comment lines and the frame lines of DEBUG_DUMP_BUFFER
+        if (text[i] == '#' || text[i] == '-')
+        {
+            size_t eol = i;
+            while (eol < len && text[eol] != '\n')
+            {
+                eol++;
+            }
+            unsigned long long epoch;
+            if (sscanf(text + i, "# epoch %llu", &epoch) == 1)
+            {
+                *epochMs = epoch;
+            }
+            i = eol;
+            continue;
+        }
+        if (isspace((unsigned char)text[i]))
+        {
+            i++;
+            continue;
+        }
+
+        // token up to the next white space
+        char token[32];
+        size_t tokenLen = 0;
+        while (i < len && !isspace((unsigned char)text[i]))
+        {
+            if (tokenLen < sizeof(token) - 1)
+            {
+                token[tokenLen++] = text[i];
+            }
+            i++;
+        }
+        token[tokenLen] = '\0';
+
+        char *end;
+        if (token[0] == '@')
+        {
+            double t_ms = strtod(token + 1, &end);
+            if (*end != '\0' || t_ms < 0)
+            {
+                fprintf(stderr, "capture: invalid time stamp '%s'\n", token);
+                return false;
+            }
+            uint64_t t = (uint64_t)(t_ms * 1000.);
+            if (_time.empty() || t >= _time.back())
+            {
+                next = t;
+            }
+            continue;
+        }
+        unsigned long value = strtoul(token, &end, 16);
+        if (*end != '\0' || value > 0xFF)
+        {
+            fprintf(stderr, "capture: invalid byte '%s'\n", token);
+            return false;
+        }
+        _data.push_back((uint8_t)value);
+        _time.push_back(next);
+        next += SML_REPLAY_BYTE_US;
+    }
+    return true;
+}
+
+void SmlReplay::rewind()
+{
+    _pos = 0;
+    _overflow = false;
+    _lostBytes = 0;
+    if (_clock == &_ownClock)
+    {
+        _clock->rewind();               // a shared clock is rewound by its owner
+    }
+}
+
+// time of the clock; received input beyond the capacity of the byte source is dropped
+uint64_t SmlReplay::now()
+{
+    uint64_t now = _clock->nowUs();
+    if (_capacity > 0 && _pos < _data.size())
+    {
+        size_t received = std::upper_bound(_time.begin() + _pos, _time.end(), now) - _time.begin();
+        if (received - _pos > _capacity)
+        {
+            _lostBytes += received - _pos - _capacity;
+            _pos = received - _capacity;
+            _overflow = true;
+        }
+    }
+    return now;
+}
+
+int SmlReplay::available()
+{
+    if (_pos >= _data.size())
+    {
+        return 0;
+    }
+    uint64_t now = this->now();
+    if (_time[_pos] > now)
+    {
+        if (_clock->speed() <= 0)
+        {
+            // fast mode: nothing is received "now", the next call sees the time of the next byte.
+            // So the sensor can run into READ_TIMEOUT before the byte arrives, as on the device.
+            _clock->waitFor(_time[_pos]);
+            if (_clock == &_ownClock)
+            {
+                _clock->step();
+            }
+        }
+        return 0;
+    }
+    size_t count = 1;
+    while (_pos + count < _data.size() && _time[_pos + count] <= now && count < 0x7FFF)
+    {
+        count++;
+    }
+    return (int)count;
+}
+
+int SmlReplay::read()
+{
+    if (_pos >= _data.size() || _time[_pos] > now())
+    {
+        return -1;
+    }
+    return _data[_pos++];
+}
+
+size_t SmlReplay::readBytes(byte *buffer, size_t len)
+{
+    uint64_t now = this->now();
+    size_t count = 0;
+    while (count < len && _pos < _data.size() && _time[_pos] <= now)
+    {
+        buffer[count++] = _data[_pos++];
+    }
+    return count;
+}
+
+bool SmlReplay::overflow()
+{
+    now();
+    bool lost = _overflow;
+    _overflow = false;
+    return lost;
+}
+
+uint32_t SmlReplay::millis()
+{
+    return _clock->millis();
+}
+
+void SmlReplay::getTimeOfDay(struct timeval *tv)
+{
+    _clock->getTimeOfDay(tv);
+}
+
+bool SmlReplay::finished()
+{
+    return _pos >= _data.size();
+}
+
+void smlCaptureWrite(FILE *file, uint32_t t_ms, const byte *data, size_t len)
+{
+    fprintf(file, "@%u", (unsigned)t_ms);
+    for (size_t i = 0; i < len; i++)
+    {
+        fprintf(file, (i % 16 == 15) ? " %02X\n" : " %02X", data[i]);
+    }
+    fputc('\n', file);
+}
+
+#endif  // ARDUINO
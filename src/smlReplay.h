@@ -0,0 +1,91 @@
+#ifndef SML_REPLAY_H
+#define SML_REPLAY_H
+#ifndef ARDUINO
+
+#include <stdio.h>
+#include <vector>
+#include "hal.h"
+
+// duration of one byte at 9600 Baud, 8N1 = 10 bit
+const uint32_t SML_REPLAY_BYTE_US = 1042;
+
+// Virtual time of one or several replays (several meters at the same time).
+// speed: 1.0 = real time, N = N times faster, 0 = as fast as possible: the time jumps to the next byte a replay
+// waits for, with several replays to the earliest one (step()).
+class SmlReplayClock : public Clock
+{
+public:
+    SmlReplayClock(double speed = 0) : _speed(speed) {}
+    void rewind();
+    uint64_t nowUs();
+    double speed() { return _speed; }
+    void waitFor(uint64_t us);                      // fast mode: a replay has no input before this time
+    void step();                                    // fast mode: time of the earliest waitFor() since the last step
+    void spend(uint32_t ms);                        // the host is busy for ms of device time, e.g. a modelled post
+    void setEpoch(uint64_t ms) { _epochStartMs = ms; }
+
+    // Clock
+    uint32_t millis() override;
+    void getTimeOfDay(struct timeval *tv) override;
+
+private:
+    double _speed;
+    uint64_t _hostStartUs = 0;
+    uint64_t _virtualUs = 0;            // current time in fast mode
+    uint64_t _wakeUs = UINT64_MAX;      // earliest waitFor()
+    uint64_t _epochStartMs = 0;         // system time at capture start, 0 until the first getTimeOfDay() if unknown
+};
+
+// Replay of a recorded meter stream as byte source and time base of a Sensor.
+// speed: 1.0 = real time (9600 Baud), N = N times faster, 0 = as fast as possible.
+// The clock is virtual: time gaps of the capture are reproduced in all modes, i.e. READ_TIMEOUT
+// behaves as on the device. Several replays may share one SmlReplayClock, e.g. one per meter.
+class SmlReplay : public ByteSource, public Clock
+{
+public:
+    SmlReplay(double speed = 0);
+    SmlReplay(SmlReplayClock *clock);               // shared clock, the owner calls step() in fast mode
+    bool load(const char *fileName);                // capture or raw binary file
+    bool load(FILE *file);
+    void append(uint64_t timeUs, const byte *data, size_t len);     // bytes at 9600 Baud from timeUs, e.g. synthetic
+    void rewind();
+    // bytes the byte source of the device keeps (SoftwareSerial buffer), older input is lost and reported by
+    // overflow(); 0: unlimited
+    void setCapacity(size_t bytes) { _capacity = bytes; }
+    uint32_t lostBytes() { return _lostBytes; }
+
+    // ByteSource
+    int available() override;
+    int read() override;
+    size_t readBytes(byte *buffer, size_t len) override;
+    bool overflow() override;
+
+    // Clock
+    uint32_t millis() override;
+    void getTimeOfDay(struct timeval *tv) override;
+
+    bool finished();
+    size_t size() { return _data.size(); }
+    const uint8_t *data() { return _data.data(); }
+    size_t position() { return _pos; }
+    uint64_t durationUs() { return _time.empty() ? 0 : _time.back(); }
+
+private:
+    uint64_t now();
+    bool parseText(const char *text, size_t len, uint64_t *epochMs);
+
+    std::vector<uint8_t> _data;
+    std::vector<uint64_t> _time;        // arrival time of each byte in us relative to capture start
+    size_t _pos = 0;
+    SmlReplayClock _ownClock;
+    SmlReplayClock *_clock;
+    size_t _capacity = 0;
+    bool _overflow = false;
+    uint32_t _lostBytes = 0;
+};
+
+// write one received chunk in capture format: "@<t_ms> <hex bytes>"
+void smlCaptureWrite(FILE *file, uint32_t t_ms, const byte *data, size_t len);
+
+#endif  // ARDUINO
+#endif  // SML_REPLAY_H
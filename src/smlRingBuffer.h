@@ -0,0 +1,72 @@
+#ifndef SML_RING_BUFFER_H
+#define SML_RING_BUFFER_H
+
+#include <atomic>
+#include "hal.h"
+
+/* ***
+# SmlRingBuffer #
+Lock-free single producer / single consumer ring buffer of N bytes (N power of 2).
+The producer may run in an interrupt or callback context, the consumer in loop().
+Head and tail are free running counters, so a full buffer needs no extra flag.
+
+Producer:  n = reserve(&ptr); ... write up to n bytes to ptr ...; commit(written);
+Consumer:  n = peek(&ptr);    ... use up to n bytes at ptr ...;    consume(used);
+Both work on contiguous blocks, i.e. a wrap around needs a second call.
+*** */
+
+template <size_t N>
+class SmlRingBuffer
+{
+    static_assert(N > 0 && (N & (N - 1)) == 0, "SmlRingBuffer size must be a power of 2");
+
+public:
+    // consumer side ---------------------------------------------------------------------------
+    size_t available() const
+    {
+        return _head.load(std::memory_order_acquire) - _tail.load(std::memory_order_relaxed);
+    }
+    // contiguous block of received bytes
+    size_t peek(const byte **data) const
+    {
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        size_t count = _head.load(std::memory_order_acquire) - tail;
+        size_t index = tail & (N - 1);
+        *data = &_buffer[index];
+        return (count < N - index) ? count : N - index;
+    }
+    void consume(size_t len)
+    {
+        _tail.store(_tail.load(std::memory_order_relaxed) + len, std::memory_order_release);
+    }
+    void clear()
+    {
+        _tail.store(_head.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+    // producer side ---------------------------------------------------------------------------
+    size_t space() const
+    {
+        return N - (_head.load(std::memory_order_relaxed) - _tail.load(std::memory_order_acquire));
+    }
+    // contiguous block of free space
+    size_t reserve(byte **data)
+    {
+        size_t head = _head.load(std::memory_order_relaxed);
+        size_t free = N - (head - _tail.load(std::memory_order_acquire));
+        size_t index = head & (N - 1);
+        *data = &_buffer[index];
+        return (free < N - index) ? free : N - index;
+    }
+    void commit(size_t len)
+    {
+        _head.store(_head.load(std::memory_order_relaxed) + len, std::memory_order_release);
+    }
+
+private:
+    byte _buffer[N];
+    std::atomic<size_t> _head{0};
+    std::atomic<size_t> _tail{0};
+};
+
+#endif // SML_RING_BUFFER_H
@@ -0,0 +1,222 @@
+#include <string.h>
+#include "smlCrc16.h"
+#include "smlScanner.h"
+#if defined(__SSE2__)
+    #include <emmintrin.h>
+#endif
+
+/* *** smlScanner.cpp framing of the SML byte stream (start sequence, escaped data, end sequence)
+
+2026-10-17 mh
+- first version: word at a time search (SWAR, SSE2 on the host) instead of the byte-wise search of Sensor.cpp
+- incremental CRC16 of the received frame
+- settled(): the part of the frame that is message data for sure, for the push decoder (smlStream.cpp)
+
+(C) M. Herbert, 2026.
+Licensed under the GNU General Public License v3.0
+
+*** end change log *** */
+
+/* ***
+# Description SmlScanner #
+SML transport v1 frames a message with escape sequences, an escape sequence is 1B 1B 1B 1B followed by a word:
+```bash
+1B 1B 1B 1B  01 01 01 01        start sequence
+1B 1B 1B 1B  1B 1B 1B 1B        escaped data: the message contains 1B 1B 1B 1B
+1B 1B 1B 1B  1A nn cc cc        end sequence, nn fill bytes before the escape, cc cc CRC16
+```
+Within the message the escape sequences start at a multiple of 4 bytes from the start sequence
+(the sender adds 0..3 fill bytes before the end sequence).
+
+## Implementation ##
+findStart() runs a small automaton over the input (1B 1B 1B 1B 1B 01 01 01 01 is found as well).
+While no part of the start sequence is matched, blocks without any 1B byte are skipped:
+16 bytes per SSE2 compare on the host, 4 bytes per SWAR test ((x - 0x01010101) & ~x & 0x80808080) otherwise.
+
+readMessage() copies the message to the frame buffer. Words without escape are copied as a block after a
+word compare (4 words per SSE2 compare on the host); only escape words and the word after them are handled
+byte-wise. Escaped data is written once, a start sequence within the message restarts the frame,
+any other escape sequence is an error.
+The frame keeps the start and the end sequence, i.e. the parser finds the message at frame + 8 as before.
+
+The CRC16 (smlCrc16.h) covers the transmitted bytes, i.e. escaped data twice. It is updated with each block and
+byte written to the frame (before an escape is removed), crc() holds the value up to the 1A of the end sequence.
+
+## Usage ##
+```bash
+SmlScanner scanner;
+result = scanner.findStart(data, len, &consumed);                       // SML_SCAN_START or SML_SCAN_MORE
+result = scanner.readMessage(data, len, &consumed, frame, &position, sizeof(frame));
+```
+consumed tells how many input bytes were used, the rest belongs to the next call.
+
+*** end description *** */
+
+static const uint32_t SML_START_WORD = 0x01010101;
+
+static inline uint32_t loadWord(const byte *data)
+{
+    uint32_t word;
+    memcpy(&word, data, sizeof(word));
+    return word;
+}
+
+// number of leading bytes without 0x1B, checked in blocks (i.e. a block containing 1B ends the count)
+static size_t skipNoEscapeByte(const byte *data, size_t len)
+{
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128i escape = _mm_set1_epi8(0x1B);
+    while (i + 16 <= len &&
+           _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(data + i)), escape)) == 0)
+    {
+        i += 16;
+    }
+#endif
+    while (i + 4 <= len)
+    {
+        uint32_t x = loadWord(data + i) ^ SML_ESCAPE_WORD;
+        if ((x - 0x01010101UL) & ~x & 0x80808080UL)
+        {
+            break;                  // there is a 1B byte in this word
+        }
+        i += 4;
+    }
+    return i;
+}
+
+// number of leading bytes up to the first escape word, a multiple of 4
+static size_t noEscapeWords(const byte *data, size_t len)
+{
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128i escape = _mm_set1_epi32(SML_ESCAPE_WORD);
+    while (i + 16 <= len)
+    {
+        int mask = _mm_movemask_epi8(_mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *)(data + i)), escape));
+        if (mask != 0)
+        {
+            return i + (__builtin_ctz(mask) & ~3);
+        }
+        i += 16;
+    }
+#endif
+    while (i + 4 <= len && loadWord(data + i) != SML_ESCAPE_WORD)
+    {
+        i += 4;
+    }
+    return i;
+}
+
+void SmlScanner::reset()
+{
+    _match = 0;
+    _escape = false;
+}
+
+SmlScanResult SmlScanner::findStart(const byte *data, size_t len, size_t *consumed)
+{
+    size_t i = 0;
+    while (i < len)
+    {
+        if (_match == 0)
+        {
+            i += skipNoEscapeByte(data + i, len - i);
+            if (i == len)
+            {
+                break;
+            }
+        }
+        byte value = data[i++];
+        if (value == START_SEQUENCE[_match])
+        {
+            if (++_match == SML_START_LEN)
+            {
+                reset();
+                _crc = smlCrc16Update(SML_CRC16_INIT, START_SEQUENCE, SML_START_LEN);
+                *consumed = i;
+                return SML_SCAN_START;
+            }
+        }
+        else if (value == 0x1B)
+        {
+            _match = (_match == 4) ? 4 : 1;     // a fifth 1B: still 4 matched; 1B within the 01s: 1 matched
+        }
+        else
+        {
+            _match = 0;
+        }
+    }
+    *consumed = len;
+    return SML_SCAN_MORE;
+}
+
+SmlScanResult SmlScanner::readMessage(const byte *data, size_t len, size_t *consumed, byte *frame, size_t *position, size_t frameSize)
+{
+    SmlScanResult result = SML_SCAN_MORE;
+    size_t pos = *position;
+    size_t i = 0;
+    while (i < len)
+    {
+        // the frame buffer must be able to hold the trailer after the current byte
+        if (pos + SML_TRAILER_LEN + 1 > frameSize)
+        {
+            result = SML_SCAN_OVERFLOW;
+            break;
+        }
+        if (!_escape && (pos & 3) == 0)
+        {
+            size_t limit = frameSize - SML_TRAILER_LEN - pos;
+            size_t n = noEscapeWords(data + i, (len - i < limit) ? len - i : limit);
+            memcpy(frame + pos, data + i, n);
+            _crc = smlCrc16Update(_crc, data + i, n);
+            pos += n;
+            i += n;
+            if (i == len || pos + SML_TRAILER_LEN + 1 > frameSize)
+            {
+                continue;
+            }
+        }
+
+        _crc = smlCrc16Byte(_crc, data[i]);
+        frame[pos++] = data[i++];
+        if (_escape)
+        {
+            if ((pos & 3) == 1 && frame[pos - 1] == END_SEQUENCE[4])
+            {
+                _escape = false;
+                result = SML_SCAN_END;
+                break;
+            }
+            if ((pos & 3) == 0)
+            {
+                _escape = false;
+                uint32_t word = loadWord(frame + pos - 4);
+                if (word == SML_ESCAPE_WORD)
+                {
+                    pos -= 4;                   // escaped data: 1B 1B 1B 1B once
+                    _escapes++;
+                }
+                else if (word == SML_START_WORD)
+                {
+                    pos = SML_START_LEN;        // start sequence within the message: restart the frame
+                    memcpy(frame, START_SEQUENCE, SML_START_LEN);
+                    _crc = smlCrc16Update(SML_CRC16_INIT, START_SEQUENCE, SML_START_LEN);
+                    _restarts++;
+                }
+                else
+                {
+                    result = SML_SCAN_ERROR;
+                    break;
+                }
+            }
+        }
+        else if ((pos & 3) == 0 && loadWord(frame + pos - 4) == SML_ESCAPE_WORD)
+        {
+            _escape = true;
+        }
+    }
+    *consumed = i;
+    *position = pos;
+    return result;
+}
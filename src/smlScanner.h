@@ -0,0 +1,48 @@
+#ifndef SML_SCANNER_H
+#define SML_SCANNER_H
+
+#include "hal.h"
+
+// SML transport v1 escape sequences
+const byte START_SEQUENCE[] = {0x1B, 0x1B, 0x1B, 0x1B, 0x01, 0x01, 0x01, 0x01};
+const byte END_SEQUENCE[] = {0x1B, 0x1B, 0x1B, 0x1B, 0x1A};
+const uint32_t SML_ESCAPE_WORD = 0x1B1B1B1B;
+const size_t SML_START_LEN = 8;         // 1B 1B 1B 1B 01 01 01 01
+const size_t SML_TRAILER_LEN = 3;       // after the 1A of the end sequence: number of fill bytes, CRC16 (2 bytes)
+
+enum SmlScanResult
+{
+    SML_SCAN_MORE,          // all input consumed, more bytes needed
+    SML_SCAN_START,         // start sequence complete
+    SML_SCAN_END,           // end sequence found, the 1A is the last byte of the frame, the trailer follows
+    SML_SCAN_OVERFLOW,      // frame buffer full
+    SML_SCAN_ERROR          // invalid escape sequence
+};
+
+// Framing of the SML byte stream (see smlScanner.cpp):
+// findStart() searches the start sequence in the input, readMessage() copies the message word by word to the frame
+// buffer, removes escaped 1B1B1B1B and stops at the end sequence. The CRC of the frame is updated on the way.
+class SmlScanner
+{
+public:
+    void reset();
+    // search the start sequence; *consumed: number of input bytes used (up to and including the start sequence)
+    SmlScanResult findStart(const byte *data, size_t len, size_t *consumed);
+    // append message bytes to frame[*position], the frame starts with the start sequence (i.e. *position >= 8)
+    SmlScanResult readMessage(const byte *data, size_t len, size_t *consumed, byte *frame, size_t *position, size_t frameSize);
+    // CRC16 register of the frame received so far (raw bytes, i.e. including escape sequences), see smlCrc16.h
+    uint16_t crc() { return _crc; }
+    // bytes of frame[0..position) that are message data for sure: whole words, without a pending escape word
+    size_t settled(size_t position) const { return (position & ~(size_t)3) - (_escape ? 4 : 0); }
+    uint32_t restarts() { return _restarts; }       // start sequences within a message
+    uint32_t escapes() { return _escapes; }         // escaped 1B1B1B1B in messages
+
+private:
+    uint8_t _match = 0;             // matched bytes of the start sequence
+    bool _escape = false;           // last complete word of the message was an escape word
+    uint16_t _crc = 0;
+    uint32_t _restarts = 0;
+    uint32_t _escapes = 0;
+};
+
+#endif // SML_SCANNER_H
@@ -0,0 +1,92 @@
+#include "smlChannel.h"
+#include "smlScheduler.h"
+
+/* *** smlScheduler.cpp several reading heads on one ESP8266
+
+2026-10-17 mh
+- first version: round robin of the sensor state machines, the input of all sensors pumped after each step
+- receive() instead of pump(): input and framing of all sensors into their spare frame buffers
+
+(C) M. Herbert, 2026.
+Licensed under the GNU General Public License v3.0
+
+*** end change log *** */
+
+/* ***
+# Description SmlScheduler #
+Each reading head of SENSOR_CONFIGS is a Sensor with its own SoftwareSerial input, ring buffer and state machine.
+SoftwareSerial keeps SENSOR_SERIAL_BUFFER_SIZE bytes (halArduino.cpp), 128 bytes are 133 ms at 9600 Baud; input
+that is not moved to the ring buffer of the sensor within this time is lost, i.e. the telegram is dropped.
+
+A step of a state machine may take long: the processing of a telegram (parse, publish, dash board) and with the
+synchronous transport the http posts. With the former loop over the sensors (pump and step of one sensor, then the
+next) a sensor waits for the steps of all other sensors and its own, with three meters up to three telegram
+processings. loop() runs the reception of all sensors (Sensor::receive(): input and framing into a spare frame
+buffer) after each step instead, so a sensor waits for at most one step.
+The first sensor of the round changes with each loop(), none is always served after the others.
+SmlHttp runs the reception of all sensors between its posts (SmlHttp::setScheduler()).
+
+Sensor::meter is the index of the sensor, the channels of the meter have the word meter<index + 1> (smlChannel.cpp).
+SensorStats::ringPeak is the most input that waited for a sensor, i.e. the margin of the scheduling.
+
+## Usage ##
+```bash
+SmlScheduler scheduler;
+scheduler.add(new Sensor(&SENSOR_CONFIGS[i], process_message));    // meter i
+my_http.setScheduler(&scheduler);
+loop(): scheduler.loop();
+```
+
+*** end description *** */
+
+static_assert(SML_METERS_MAX <= (SML_CHANNEL_METER >> SML_CHANNEL_METER_SHIFT) + 1,
+              "SML_METERS_MAX: the channel flags hold the meter in 2 bits");
+static_assert(NUM_OF_SENSORS <= SML_METERS_MAX, "SENSOR_CONFIGS: at most SML_METERS_MAX reading heads");
+
+bool SmlScheduler::add(Sensor *sensor)
+{
+    if (_count == SML_METERS_MAX)
+    {
+        return false;
+    }
+    sensor->meter = _count;
+    _sensor[_count++] = sensor;
+    return true;
+}
+
+void SmlScheduler::loop()
+{
+    if (_count == 0)
+    {
+        return;
+    }
+    for (uint8_t i = 0; i < _count; i++)
+    {
+        _sensor[(_first + i) % _count]->loop();     // receives its own input first
+        if (_count > 1)
+        {
+            receive();                  // input of the other sensors received during the step
+        }
+    }
+    _first = (_first + 1) % _count;
+}
+
+void SmlScheduler::receive()
+{
+    for (uint8_t i = 0; i < _count; i++)
+    {
+        _sensor[i]->receive();
+    }
+}
+
+bool SmlScheduler::pending()
+{
+    for (uint8_t i = 0; i < _count; i++)
+    {
+        if (_sensor[i]->pending())
+        {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,24 @@
+#ifndef SML_SCHEDULER_H
+#define SML_SCHEDULER_H
+
+#include "config.h"
+#include "Sensor.h"
+
+// round robin of the state machines of several reading heads (see smlScheduler.cpp)
+class SmlScheduler
+{
+public:
+    bool add(Sensor *sensor);           // sets Sensor::meter; false if SML_METERS_MAX sensors are scheduled
+    void loop();                        // one step of each sensor, the reception of all sensors after each step
+    void receive();                     // input and framing of all sensors (Sensor::receive()), e.g. while http blocks
+    bool pending();                     // received input of a sensor is waiting for its state machine
+    uint8_t count() { return _count; }
+    Sensor *sensor(uint8_t meter) { return (meter < _count) ? _sensor[meter] : NULL; }
+
+private:
+    Sensor *_sensor[SML_METERS_MAX] = {};
+    uint8_t _count = 0;
+    uint8_t _first = 0;                 // sensor with the first step of the next loop()
+};
+
+#endif // SML_SCHEDULER_H
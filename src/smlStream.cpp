@@ -0,0 +1,126 @@
+#include <string.h>
+#include "smlStream.h"
+
+/* *** smlStream.cpp entries of a telegram decoded during its reception, committed by the CRC
+
+2026-10-17 mh
+- first version: SmlObisReader resumed on the settled bytes of the frame buffer, entries staged as offsets
+
+(C) M. Herbert, 2026.
+Licensed under the GNU General Public License v3.0
+
+*** end change log *** */
+
+/* ***
+# Description SmlObisStream #
+A telegram takes up to 400 ms at 9600 baud; the messages were evaluated only after the CRC at its end, i.e. the
+values were published after the transmission plus the parse. The Sensor feeds the bytes of the frame buffer to
+SmlObisStream as they arrive (Sensor::read_message()): each list entry is decoded as soon as its last byte is
+received, the parse is done when the end sequence arrives. The CRC check (Sensor::read_checksum()) then commits the
+entries, or discards them with the telegram; the processing publishes the committed entries without parsing the
+message again (SmlHttp::publishDecoded()).
+
+- Only the settled bytes are fed (SmlScanner::settled()): a pending escape word may still turn out to be the end
+  sequence or escaped data.
+- The walk is resumed at the last decoded entry or message (SmlObisWalk). An element cut by the end of the received
+  bytes is decoded again when the bytes up to its end have arrived (SmlObisReader::needed()), i.e. the bytes since
+  the last entry are walked again once per incomplete element, not per received block. A start sequence within the
+  message restarts the decoder (begin()).
+- The entries hold offsets, not pointers: the frame buffer may be moved when it grows (smlFramePool.cpp).
+- A message with a format error or more than SML_STREAM_ENTRIES entries with a value is not staged (failed()), the
+  processing walks it as before (layout cache, SmlObisReader or libsml).
+
+Each frame buffer of the Sensor has its decoder (SensorFrame::entries), i.e. the entries of a received telegram wait
+with it for the processing while the next one is decoded. SML_STREAM_DECODE=false (build flag) turns it off.
+
+## Usage ##
+```bash
+stream.begin();                                         // start sequence
+stream.feed(frame + 8, scanner.settled(pos) - 8);       // after each block of received bytes
+stream.finish(frame + 8, len - 16, crcOk);              // after the CRC
+if (stream.committed()) { for (i = 0; i < stream.count(); i++) { stream.entry(frame + 8, i, &entry); } }
+```
+
+*** end description *** */
+
+void SmlObisStream::begin()
+{
+    _walk = {};
+    _needed = 0;
+    _count = 0;
+    _failed = false;
+    _committed = false;
+}
+
+void SmlObisStream::feed(const byte *message, size_t len)
+{
+    decode(message, len, false);
+}
+
+bool SmlObisStream::finish(const byte *message, size_t len, bool crcOk)
+{
+    if (crcOk)
+    {
+        decode(message, len, true);
+    }
+    _committed = crcOk && !_failed;
+    return _committed;
+}
+
+void SmlObisStream::decode(const byte *message, size_t len, bool last)
+{
+    if (_failed || len < _walk.offset || (!last && len < _needed))
+    {
+        return;
+    }
+    if (len > 0xFFFF)
+    {
+        _failed = true;             // 16 bit offsets
+        return;
+    }
+    SmlObisReader reader(message, len, _walk);
+    SmlObisEntry entry;
+    while (reader.next(&entry))
+    {
+        if (_count == SML_STREAM_ENTRIES)
+        {
+            _failed = true;
+            return;
+        }
+        Slot &slot = _slot[_count++];
+        memcpy(slot.obis, entry.obis, sizeof(slot.obis));
+        slot.unit = entry.unit;
+        slot.scaler = entry.scaler;
+        slot.type = entry.type;
+        slot.strAt = entry.str ? entry.str - message : 0;
+        slot.strLen = entry.strLen;
+        slot.decodedAt = len;
+        slot.value = entry.value;
+        _walk = reader.walk(message);
+    }
+    if (!reader.error())
+    {
+        _walk = reader.walk(message);       // all received messages done
+    }
+    else if (last || !reader.incomplete())
+    {
+        _failed = true;
+    }
+    else
+    {
+        // the end of the received bytes within an element: decoded again when it is complete
+        _needed = reader.needed() - message;
+    }
+}
+
+void SmlObisStream::entry(const byte *message, uint8_t i, SmlObisEntry *entry) const
+{
+    const Slot &slot = _slot[i];
+    memcpy(entry->obis, slot.obis, sizeof(entry->obis));
+    entry->unit = slot.unit;
+    entry->scaler = slot.scaler;
+    entry->type = slot.type;
+    entry->value = slot.value;
+    entry->str = (slot.type == SML_TYPE_OCTET_STRING) ? message + slot.strAt : NULL;
+    entry->strLen = slot.strLen;
+}
@@ -0,0 +1,51 @@
+#ifndef SML_STREAM_H
+#define SML_STREAM_H
+
+#include "hal.h"
+#include "smlObis.h"
+
+#ifndef SML_STREAM_ENTRIES
+#define SML_STREAM_ENTRIES 12           // entries with a value per telegram, 24 bytes each per frame buffer
+#endif
+
+// push decoder: the entries of a telegram decoded while its bytes are received (see smlStream.cpp)
+class SmlObisStream
+{
+public:
+    void begin();                   // start of a telegram, the entries so far are void
+    // the message bytes received so far (without start sequence): decodes the entries completed since the last call
+    void feed(const byte *message, size_t len);
+    // the complete message (as sml_file_parse()) and the result of its CRC check; true: the entries are committed
+    bool finish(const byte *message, size_t len, bool crcOk);
+    bool committed() const { return _committed; }
+    // the entries are not usable: format error or more than SML_STREAM_ENTRIES entries, the message is walked again
+    bool failed() const { return _failed; }
+    // entries decoded so far, committed only after finish(); octet strings point into message
+    uint8_t count() const { return _count; }
+    void entry(const byte *message, uint8_t i, SmlObisEntry *entry) const;
+    // message bytes received when entry i was decoded
+    size_t decodedAt(uint8_t i) const { return _slot[i].decodedAt; }
+
+private:
+    void decode(const byte *message, size_t len, bool last);
+
+    struct Slot
+    {
+        byte obis[6];
+        uint8_t unit;
+        int8_t scaler;
+        uint8_t type;
+        uint16_t strAt;             // octet string: offset in the message
+        uint16_t strLen;
+        uint16_t decodedAt;
+        int64_t value;
+    };
+    Slot _slot[SML_STREAM_ENTRIES];
+    SmlObisWalk _walk = {};         // after the last decoded entry or message
+    size_t _needed = 0;             // message bytes that complete the element cut by the end of the received bytes
+    uint8_t _count = 0;
+    bool _failed = false;
+    bool _committed = false;
+};
+
+#endif // SML_STREAM_H
@@ -0,0 +1,72 @@
+#include "hal.h"
+#include "Sensor.h"
+#include "smlTime.h"
+
+/* *** smlTime.cpp time stamps of the telegrams: monotonic clock with an offset to the system (NTP) time
+
+2026-10-17 mh
+- first version: Sensor latches the time stamp when it finds the start sequence, SmlHttp posts it in ms
+
+(C) M. Herbert, 2026.
+Licensed under the GNU General Public License v3.0
+
+*** end change log *** */
+
+/* ***
+# Description SmlTimeBase #
+Before, SmlHttp took gettimeofday() when it evaluated the telegram and posted whole seconds, i.e. the time stamps
+lagged the reception by parse and http time and had 1 s resolution. Now Sensor latches millis64() when it finds the
+start sequence of a telegram and converts it by SmlTimeBase into epoch ms (Sensor::frameEpochMs()), which SmlHttp
+posts for all values of the telegram.
+
+The time stamp is the monotonic millis64() plus an offset to the system time, which is set by NTP on the ESP8266:
+- the first call and a difference of more than SML_TIME_STEP_MS (e.g. the first NTP sync) set the offset at once
+- a smaller difference (NTP adjusts the system time, drift of the crystal) is corrected by at most
+  SML_TIME_SLEW_MS per telegram, and the time stamps do not go backwards, so the time between two telegrams stays
+  exact to a few ms (derived power, smlDerive.cpp)
+
+One time base is shared by all meters (smlTimeBase()), so their telegrams are stamped by the same clock.
+
+## Usage ##
+```bash
+uint64_t ms = smlTimeBase()->epochMs(millis64());
+```
+
+*** end description *** */
+
+uint64_t SmlTimeBase::epochMs(uint64_t monotonicMs)
+{
+    // offset of the system time now
+    struct timeval tv;
+    halClock()->getTimeOfDay(&tv);
+    uint64_t now = millis64();
+    int64_t target = (int64_t)((uint64_t)tv.tv_sec * 1000 + tv.tv_usec / 1000) - (int64_t)now;
+    int64_t error = _valid ? target - _offset : 0;
+    _stats.error = (int32_t)((error > INT32_MAX) ? INT32_MAX : (error < INT32_MIN) ? INT32_MIN : error);
+
+    if (!_valid || error > SML_TIME_STEP_MS || error < -SML_TIME_STEP_MS)
+    {
+        _valid = true;
+        _offset = target;
+        _last = 0;
+        _stats.steps++;
+    }
+    else if (error != 0)
+    {
+        _offset += (error > SML_TIME_SLEW_MS) ? SML_TIME_SLEW_MS : (error < -SML_TIME_SLEW_MS) ? -SML_TIME_SLEW_MS : error;
+        _stats.slews++;
+    }
+    uint64_t ms = monotonicMs + _offset;
+    if (ms < _last)
+    {
+        ms = _last;                 // slewed back, but not before the last time stamp
+    }
+    _last = ms;
+    return ms;
+}
+
+SmlTimeBase *smlTimeBase()
+{
+    static SmlTimeBase timeBase;
+    return &timeBase;
+}
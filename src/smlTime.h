@@ -0,0 +1,32 @@
+#ifndef SML_TIME_H
+#define SML_TIME_H
+
+#include <stdint.h>
+#include "config.h"
+
+struct SmlTimeStats
+{
+    uint32_t steps;                 // offset set at once (first sync, NTP step)
+    uint32_t slews;                 // offset corrected by at most SML_TIME_SLEW_MS
+    int32_t error;                  // last difference system time - time base, ms
+};
+
+// epoch time stamps in ms of a monotonic clock, corrected to the system (NTP) time (see smlTime.cpp)
+class SmlTimeBase
+{
+public:
+    // epoch ms of monotonicMs (millis64()), e.g. latched at the start sequence of a telegram
+    uint64_t epochMs(uint64_t monotonicMs);
+    const SmlTimeStats &getStats() { return _stats; }
+
+private:
+    bool _valid = false;
+    int64_t _offset = 0;            // epoch ms - monotonic ms
+    uint64_t _last = 0;             // last time stamp returned
+    SmlTimeStats _stats = {};
+};
+
+// time base shared by all meters, so their time stamps can be correlated
+SmlTimeBase *smlTimeBase();
+
+#endif // SML_TIME_H